@@ -0,0 +1,72 @@
+// Concurrent Argon2 under a memory budget: eight jobs, each unlocking a file from a
+// different batch (so every one needs its own derivation), run on four workers with budgets
+// that admit one, two and four derivations at a time. Reports wall time, the budget's own
+// peak and the process peak RSS. Keys must match a serial derivation, and the reserved
+// peak must never exceed the budget.
+
+#include "memory_budget.h"
+#include "session.h"
+#include "thread_pool.h"
+#include <sodium.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/resource.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double peak_rss_mib() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    const size_t jobs = 8;
+    const uint64_t per_kdf = crypto_pwhash_MEMLIMIT_MODERATE;
+    std::vector<unsigned char> salts(jobs * crypto_pwhash_SALTBYTES);
+    randombytes_buf(salts.data(), salts.size());
+
+    std::vector<unsigned char> expected(jobs * KeySession::KEY_BYTES);
+    kdf_budget().configure(per_kdf, 1);
+    for (size_t i = 0; i < jobs; ++i) {
+        if (!derive_password_key("bench", &salts[i * crypto_pwhash_SALTBYTES], &expected[i * KeySession::KEY_BYTES]))
+            return 1;
+    }
+
+    std::atomic<int> bad(0);
+    std::printf("%zu derivations of %llu MiB on 4 workers\n", jobs, static_cast<unsigned long long>(per_kdf >> 20));
+    std::printf("budget              seconds  peak reserved MiB  peak RSS MiB  waited\n");
+    // Lowest budget first: peak RSS only grows.
+    for (unsigned admitted : {1u, 2u, 4u}) {
+        MemoryBudget& budget = kdf_budget();
+        budget.configure(per_kdf * admitted, admitted);
+        MemoryBudget::Usage before = budget.usage();
+
+        KeySession session("bench");
+        std::vector<unsigned char> got(expected.size());
+        ThreadPool pool(4);
+        auto start = Clock::now();
+        pool.parallel_for(jobs, [&](size_t i) {
+            if (!session.master_for_salt(&salts[i * crypto_pwhash_SALTBYTES], &got[i * KeySession::KEY_BYTES])) bad++;
+        });
+        double t = std::chrono::duration<double>(Clock::now() - start).count();
+        MemoryBudget::Usage after = budget.usage();
+
+        if (got != expected || after.peak_bytes > per_kdf * admitted) ++bad;
+        char label[32];
+        std::snprintf(label, sizeof(label), "%u x %llu MiB", admitted, static_cast<unsigned long long>(per_kdf >> 20));
+        std::printf("%-18s %8.2f %18llu %13.0f %7llu\n", label, t,
+                    static_cast<unsigned long long>(after.peak_bytes >> 20), peak_rss_mib(),
+                    static_cast<unsigned long long>(after.waited - before.waited));
+    }
+    if (bad) {
+        std::fprintf(stderr, "budget mismatch: %d\n", bad.load());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Binary point/scalar codec vs the previous hex/string round-trips. The old routines are
+// reproduced here verbatim as the reference; random keys and mutated encodings must give the
+// same bytes and the same accept/reject decisions before anything is timed.
+
+#include "eccfrog512ck2.h"
+#include "fp512.h"
+#include "point_codec.h"
+#include "utils.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using Point = ECCFrog512CK2::Point;
+
+namespace legacy {
+mpz_class p, a, b;
+
+std::vector<unsigned char> to_uncompressed_bytes(const Point& P) {
+    if (P.at_infinity) return {0x00};
+    std::vector<unsigned char> bytes(129);
+    bytes[0] = 0x04;
+    std::string x_hex = P.x.get_str(16);
+    x_hex.insert(0, 128 - x_hex.length(), '0');
+    for (int i = 0; i < 64; ++i) bytes[1 + i] = static_cast<unsigned char>(std::stoul(x_hex.substr(i * 2, 2), nullptr, 16));
+    std::string y_hex = P.y.get_str(16);
+    y_hex.insert(0, 128 - y_hex.length(), '0');
+    for (int i = 0; i < 64; ++i) bytes[65 + i] = static_cast<unsigned char>(std::stoul(y_hex.substr(i * 2, 2), nullptr, 16));
+    return bytes;
+}
+
+std::string to_compressed_hex(const Point& P) {
+    if (P.at_infinity) return "00";
+    std::ostringstream oss;
+    oss << (mpz_tstbit(P.y.get_mpz_t(), 0) ? "03" : "02");
+    std::string x_hex = P.x.get_str(16);
+    x_hex.insert(0, 128 - x_hex.length(), '0');
+    oss << x_hex;
+    return oss.str();
+}
+
+Point point_from_uncompressed(const std::vector<unsigned char>& bytes) {
+    if (bytes.size() != 129 || bytes[0] != 0x04) throw std::runtime_error("format");
+    mpz_class x, y;
+    std::string x_hex, y_hex;
+    for (int i = 1; i <= 64; ++i) {
+        char buf[3];
+        snprintf(buf, sizeof(buf), "%02x", bytes[i]);
+        x_hex += buf;
+    }
+    for (int i = 65; i <= 128; ++i) {
+        char buf[3];
+        snprintf(buf, sizeof(buf), "%02x", bytes[i]);
+        y_hex += buf;
+    }
+    x.set_str(x_hex, 16);
+    y.set_str(y_hex, 16);
+    mpz_class lhs = (y * y) % p;
+    mpz_class rhs = (x * x * x + a * x + b) % p;
+    if (lhs != rhs) throw std::runtime_error("not on curve");
+    return Point(x, y);
+}
+
+void random_key(mpz_class& key, const unsigned char* buffer, const mpz_class& n) {
+    std::stringstream ss;
+    for (size_t i = 0; i < 64; i++) ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(buffer[i]);
+    key.set_str(ss.str(), 16);
+    key = key % (n - 2) + 1;
+}
+}
+
+static bool decodes(const ECCFrog512CK2& curve, const std::vector<unsigned char>& bytes, Point& out) {
+    try {
+        out = curve.point_from_uncompressed(bytes);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static bool legacy_decodes(const std::vector<unsigned char>& bytes, Point& out) {
+    try {
+        out = legacy::point_from_uncompressed(bytes);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+template <typename F>
+static double per_second(size_t count, F&& f) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) f(i);
+    return count / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    ECCFrog512CK2 curve;
+    const mpz_class n = curve.get_n();
+    const Point G = curve.get_G();
+    mpz_import(legacy::p.get_mpz_t(), 8, -1, sizeof(uint64_t), 0, 0, fp512_const::P);
+    legacy::a = legacy::p - 7;
+    legacy::b = ((G.y * G.y - G.x * G.x * G.x + 7 * G.x) % legacy::p + legacy::p) % legacy::p;
+
+    const size_t count = 500;
+    std::vector<Point> keys(count);
+    for (auto& k : keys) {
+        mpz_class s;
+        generate_random_key(s, n);
+        k = curve.scalar_mul_base(s);
+    }
+
+    int bad = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Point& P = keys[i];
+        std::vector<unsigned char> enc = P.to_uncompressed_bytes();
+        if (enc != legacy::to_uncompressed_bytes(P)) ++bad;
+        if (P.to_compressed_hex() != legacy::to_compressed_hex(P)) ++bad;
+
+        Point back = curve.point_from_compressed_hex(P.to_compressed_hex());
+        if (back.x != P.x || back.y != P.y) ++bad;
+
+        // Mutated encodings: both decoders must agree on acceptance and on the result.
+        std::vector<unsigned char> mutated = enc;
+        mutated[1 + randombytes_uniform(128)] ^= static_cast<unsigned char>(1u << randombytes_uniform(8));
+        for (const auto* e : {&enc, &mutated}) {
+            Point a, b;
+            bool ok_new = decodes(curve, *e, a), ok_old = legacy_decodes(*e, b);
+            if (ok_new != ok_old || (ok_new && (a.x != b.x || a.y != b.y))) ++bad;
+        }
+
+        unsigned char buf[64];
+        randombytes_buf(buf, sizeof(buf));
+        mpz_class k_new, k_old;
+        mpz_from_be_bytes(k_new, buf, sizeof(buf));
+        k_new = k_new % (n - 2) + 1;
+        legacy::random_key(k_old, buf, n);
+        if (k_new != k_old) ++bad;
+    }
+    if (bad) {
+        std::fprintf(stderr, "codec mismatch against the legacy routines: %d\n", bad);
+        return 1;
+    }
+
+    std::vector<std::vector<unsigned char>> enc(count);
+    for (size_t i = 0; i < count; ++i) enc[i] = keys[i].to_uncompressed_bytes();
+    unsigned char out[UNCOMPRESSED_POINT_BYTES];
+
+    const size_t reps = count * 4;
+    double enc_old = per_second(reps, [&](size_t i) { legacy::to_uncompressed_bytes(keys[i % count]); });
+    double enc_new = per_second(reps, [&](size_t i) { keys[i % count].encode_uncompressed(out, sizeof(out)); });
+    double dec_old = per_second(reps, [&](size_t i) { legacy::point_from_uncompressed(enc[i % count]); });
+    double dec_new = per_second(reps, [&](size_t i) { curve.point_from_bytes(enc[i % count].data(), enc[i % count].size()); });
+    double hex_old = per_second(reps, [&](size_t i) { legacy::to_compressed_hex(keys[i % count]); });
+    double hex_new = per_second(reps, [&](size_t i) { keys[i % count].to_compressed_hex(); });
+
+    std::printf("%-28s %12s %12s %8s\n", "operation", "legacy/s", "codec/s", "speedup");
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "encode uncompressed", enc_old, enc_new, enc_new / enc_old);
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "decode + validate", dec_old, dec_new, dec_new / dec_old);
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "compressed hex", hex_old, hex_new, hex_new / hex_old);
+    return 0;
+}
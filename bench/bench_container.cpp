@@ -0,0 +1,119 @@
+// Many tiny files: one .ecc per file (sharing a KeySession, so one Argon2 for the batch)
+// vs a single container. The container is listed and every member extracted back and
+// compared; an appended file must replace its older copy, and a flipped bit must fail.
+
+#include "container.h"
+#include "encrypt.h"
+#include "session.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+static double seconds(F&& f) {
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static std::string extract_string(const Container& archive, const ContainerEntry& entry, bool& ok) {
+    std::ostringstream buf;
+    std::unique_ptr<OutputSink> out = wrap_output(buf);
+    ok = archive.extract(entry, *out);
+    return buf.str();
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "cryptofrog_bench_container";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "files");
+    fs::create_directories(dir / "sealed");
+
+    const size_t count = 5000;
+    std::vector<ContainerInput> inputs(count);
+    std::vector<std::string> contents(count);
+    for (size_t i = 0; i < count; ++i) {
+        contents[i].resize(64 + randombytes_uniform(2048));
+        randombytes_buf(&contents[i][0], contents[i].size());
+        inputs[i].name = "files/f" + std::to_string(i);
+        inputs[i].path = (dir / inputs[i].name).string();
+        std::ofstream(inputs[i].path, std::ios::binary) << contents[i];
+    }
+
+    KeySession session("bench");
+    CryptoOptions options;
+    options.session = &session;
+
+    double t_files = seconds([&] {
+        for (size_t i = 0; i < count; ++i)
+            encrypt_file(inputs[i].path, (dir / "sealed" / ("f" + std::to_string(i) + ".ecc")).string(), "bench",
+                         options);
+    });
+
+    const std::string archive_path = (dir / "files.ecp").string();
+    std::vector<size_t> failed;
+    bool stored = false;
+    double t_container = seconds([&] {
+        Container archive;
+        stored = archive.create(archive_path, "bench", options, true) && archive.add(inputs, failed);
+    });
+
+    int bad = stored && failed.empty() ? 0 : 1;
+    Container archive;
+    if (!archive.open(archive_path, "bench", options, true) || archive.entries().size() != count) ++bad;
+    for (size_t i = 0; i < count && !bad; ++i) {
+        const ContainerEntry* e = archive.find(inputs[i].name);
+        bool ok = false;
+        if (!e || extract_string(archive, *e, ok) != contents[i] || !ok) ++bad;
+    }
+
+    // Adding an existing name replaces that member; the others stay readable.
+    std::ofstream(inputs[0].path, std::ios::binary) << "replaced";
+    if (!archive.add({inputs[0]}, failed) || !failed.empty() || archive.entries().size() != count) ++bad;
+    Container reopened;
+    bool ok = false;
+    if (!reopened.open(archive_path, "bench", options) ||
+        extract_string(reopened, *reopened.find(inputs[0].name), ok) != "replaced" || !ok ||
+        extract_string(reopened, *reopened.find(inputs[count - 1].name), ok) != contents[count - 1] || !ok)
+        ++bad;
+
+    // A flipped bit in the last member's ciphertext fails only that member.
+    const ContainerEntry last = *reopened.find(inputs[count - 1].name);
+    {
+        std::fstream f(archive_path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(static_cast<std::streamoff>(last.offset + 3));
+        char c = static_cast<char>(f.get());
+        f.seekp(static_cast<std::streamoff>(last.offset + 3));
+        f.put(static_cast<char>(c ^ 1));
+    }
+    extract_string(reopened, last, ok);
+    if (ok) ++bad;
+    extract_string(reopened, *reopened.find(inputs[1].name), ok);
+    if (!ok) ++bad;
+    if (bad) {
+        std::fprintf(stderr, "container mismatch: %d\n", bad);
+        return 1;
+    }
+
+    uintmax_t sealed_bytes = 0;
+    for (const auto& entry : fs::directory_iterator(dir / "sealed")) sealed_bytes += entry.file_size();
+
+    std::printf("%zu files of 64 B - 2 KiB\n", count);
+    std::printf("%-28s %10.0f files/s %10.1f KiB on disk\n", "one .ecc per file", count / t_files,
+                sealed_bytes / 1024.0);
+    std::printf("%-28s %10.0f files/s %10.1f KiB on disk\n", "container", count / t_container,
+                fs::file_size(archive_path) / 1024.0);
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// ECCFrog512CK2 point multiplication: reference GMP path vs the fixed-width paths.
+// Every fast result is checked against the reference before timings are printed.
+
+#include "eccfrog512ck2.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static mpz_class random_scalar(const mpz_class& n) {
+    unsigned char buf[64];
+    mpz_class k;
+    do {
+        randombytes_buf(buf, sizeof(buf));
+        mpz_import(k.get_mpz_t(), sizeof(buf), 1, 1, 0, 0, buf);
+        k %= n;
+    } while (k == 0);
+    return k;
+}
+
+static bool same(const ECCFrog512CK2::Point& a, const ECCFrog512CK2::Point& b) {
+    if (a.at_infinity || b.at_infinity) return a.at_infinity == b.at_infinity;
+    return a.x == b.x && a.y == b.y;
+}
+
+template <typename F>
+static double per_second(size_t count, F&& f) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) f(i);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return count / secs;
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    ECCFrog512CK2 curve;
+    const mpz_class n = curve.get_n();
+    const ECCFrog512CK2::Point G = curve.get_G();
+    const ECCFrog512CK2::Point P = curve.scalar_mul_reference(G, random_scalar(n));
+
+    const size_t slow = 50, fast = 2000;
+    std::vector<mpz_class> k(fast);
+    for (auto& s : k) s = random_scalar(n);
+
+    int bad = 0;
+    for (size_t i = 0; i < slow; ++i) {
+        if (!same(curve.scalar_mul_base(k[i]), curve.scalar_mul_reference(G, k[i]))) ++bad;
+        ECCFrog512CK2::Point ref = curve.scalar_mul_reference(P, k[i]);
+        if (!same(curve.scalar_mul(P, k[i]), ref)) ++bad;
+        if (!same(curve.scalar_mul_ct(P, k[i]), ref)) ++bad;
+        if (curve.ecdh_x(P, k[i]) != ref.x) ++bad;
+    }
+    if (bad) {
+        std::fprintf(stderr, "mismatch against the reference path: %d\n", bad);
+        return 1;
+    }
+
+    curve.scalar_mul_base(k[0]);   // builds the table outside the timed loop
+
+    double ref_g = per_second(slow, [&](size_t i) { curve.scalar_mul_reference(G, k[i]); });
+    double base_g = per_second(fast, [&](size_t i) { curve.scalar_mul_base(k[i]); });
+    double ref_p = per_second(slow, [&](size_t i) { curve.scalar_mul_reference(P, k[i]); });
+    double wnaf_p = per_second(fast / 4, [&](size_t i) { curve.scalar_mul(P, k[i]); });
+    double ct_p = per_second(fast / 8, [&](size_t i) { curve.scalar_mul_ct(P, k[i]); });
+    double ecdh_p = per_second(fast / 8, [&](size_t i) { curve.ecdh_x(P, k[i]); });
+
+    std::printf("%-28s %12s %12s %8s\n", "operation", "reference/s", "current/s", "speedup");
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "keygen k*G (fixed base)", ref_g, base_g, base_g / ref_g);
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "k*P (variable base, wNAF)", ref_p, wnaf_p, wnaf_p / ref_p);
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "k*P (constant-time ladder)", ref_p, ct_p, ct_p / ref_p);
+    std::printf("%-28s %12.0f %12.0f %7.1fx\n", "ECDH x-only ladder", ref_p, ecdh_p, ecdh_p / ref_p);
+
+    // Latency by scalar weight: the ladders should not care, the reference does.
+    const mpz_class light = 1, heavy = (mpz_class(1) << 511) - 1;
+    auto usec = [](auto&& f) {
+        auto start = Clock::now();
+        for (int i = 0; i < 10; ++i) f();
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / 10;
+    };
+    std::printf("\n%-28s %12s %12s\n", "latency (us)", "k = 1", "k = 2^511-1");
+    std::printf("%-28s %12.0f %12.0f\n", "reference", usec([&] { curve.scalar_mul_reference(P, light); }),
+                usec([&] { curve.scalar_mul_reference(P, heavy); }));
+    std::printf("%-28s %12.0f %12.0f\n", "constant-time ladder", usec([&] { curve.scalar_mul_ct(P, light); }),
+                usec([&] { curve.scalar_mul_ct(P, heavy); }));
+    std::printf("%-28s %12.0f %12.0f\n", "ECDH x-only ladder", usec([&] { curve.ecdh_x(P, light); }),
+                usec([&] { curve.ecdh_x(P, heavy); }));
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Keyring import: one call per key through the hex/mpz entry points vs import_points.
+// A few entries are corrupted on purpose; the batch must report exactly those indices.
+
+#include "eccfrog512ck2.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static mpz_class random_scalar(const mpz_class& n) {
+    unsigned char buf[64];
+    mpz_class k;
+    do {
+        randombytes_buf(buf, sizeof(buf));
+        mpz_import(k.get_mpz_t(), sizeof(buf), 1, 1, 0, 0, buf);
+        k %= n;
+    } while (k == 0);
+    return k;
+}
+
+static std::vector<unsigned char> hex_bytes(const std::string& hex) {
+    std::vector<unsigned char> out(hex.size() / 2);
+    for (size_t i = 0; i < out.size(); ++i) out[i] = static_cast<unsigned char>(std::stoul(hex.substr(2 * i, 2), nullptr, 16));
+    return out;
+}
+
+template <typename F>
+static double seconds(F&& f) {
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    ECCFrog512CK2 curve;
+    const size_t count = 2000;
+    std::vector<ECCFrog512CK2::Point> keys(count);
+    std::vector<std::string> compressed_hex(count);
+    std::vector<std::vector<unsigned char>> compressed(count), uncompressed(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = curve.scalar_mul_base(random_scalar(curve.get_n()));
+        compressed_hex[i] = keys[i].to_compressed_hex();
+        compressed[i] = hex_bytes(compressed_hex[i]);
+        uncompressed[i] = keys[i].to_uncompressed_bytes();
+    }
+
+    // Broken entries: a flipped y bit (off the curve) and a truncated key.
+    const std::vector<size_t> broken = {7, 1500};
+    uncompressed[7][100] ^= 0x01;
+    compressed[7].pop_back();
+    uncompressed[1500].pop_back();
+    compressed[1500].pop_back();
+
+    int bad = 0;
+    for (size_t i = 0; i < 50; ++i) {
+        ECCFrog512CK2::Point p = curve.point_from_compressed_hex(compressed_hex[i]);
+        if (p.x != keys[i].x || p.y != keys[i].y) ++bad;
+    }
+
+    std::vector<size_t> failed_c, failed_u;
+    std::vector<ECCFrog512CK2::Point> got_c, got_u;
+    double t_batch_c1 = seconds([&] { got_c = curve.import_points(compressed, failed_c, 1); });
+    double t_batch_c = seconds([&] { got_c = curve.import_points(compressed, failed_c); });
+    double t_batch_u = seconds([&] { got_u = curve.import_points(uncompressed, failed_u); });
+    if (failed_c != broken || failed_u != broken) ++bad;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == broken[0] || i == broken[1]) continue;
+        if (got_c[i].x != keys[i].x || got_c[i].y != keys[i].y) ++bad;
+        if (got_u[i].x != keys[i].x || got_u[i].y != keys[i].y) ++bad;
+    }
+    if (bad) {
+        std::fprintf(stderr, "import mismatch: %d\n", bad);
+        return 1;
+    }
+
+    double t_one_c = seconds([&] {
+        for (size_t i = 0; i < count; ++i) curve.point_from_compressed_hex(compressed_hex[i]);
+    });
+    double t_one_u = seconds([&] {
+        for (size_t i = 0; i < count; ++i) {
+            if (i != broken[0] && i != broken[1]) curve.point_from_uncompressed(uncompressed[i]);
+        }
+    });
+
+    std::printf("%zu keys, keys/s\n", count);
+    std::printf("%-34s %12.0f\n", "compressed, one by one (hex)", count / t_one_c);
+    std::printf("%-34s %12.0f\n", "compressed, import_points 1 thread", count / t_batch_c1);
+    std::printf("%-34s %12.0f\n", "compressed, import_points", count / t_batch_c);
+    std::printf("%-34s %12.0f\n", "uncompressed, one by one", count / t_one_u);
+    std::printf("%-34s %12.0f\n", "uncompressed, import_points", count / t_batch_u);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// GUI job queue: four files encrypted and decrypted through the queue with byte progress,
+// then a 512 MiB encryption cancelled mid-stream and a batch cancelled before it starts.
+// Callbacks must arrive in order off the calling thread, progress must reach the file size,
+// and a cancelled job must leave no output behind. Prints the time from cancel() to the
+// finished callback, which is what the GUI waits for.
+
+#include "job_queue.h"
+#include <sodium.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// What the callbacks saw, per job id.
+struct Seen {
+    bool started = false, finished = false, bad_order = false, off_thread = true;
+    uint64_t progress = 0, total = 0, callbacks = 0;
+    JobResult result;
+    Clock::time_point finished_at;
+};
+
+class Recorder {
+public:
+    JobQueue::Callbacks callbacks() {
+        JobQueue::Callbacks cb;
+        cb.started = [this](uint64_t id, const Job&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Seen& s = seen[id];
+            s.started = true;
+            s.off_thread = s.off_thread && std::this_thread::get_id() != caller;
+        };
+        cb.progress = [this](uint64_t id, uint64_t done, uint64_t total) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Seen& s = seen[id];
+            if (!s.started || s.finished || done < s.progress) s.bad_order = true;
+            s.progress = done;
+            s.total = total;
+            ++s.callbacks;
+        };
+        cb.finished = [this](uint64_t id, const Job& job, const JobResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Seen& s = seen[id];
+            if (s.finished || !job.password.empty()) s.bad_order = true;
+            s.finished = true;
+            s.result = result;
+            s.finished_at = Clock::now();
+            changed.notify_all();
+        };
+        return cb;
+    }
+
+    Seen wait(uint64_t id) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return seen[id].finished; });
+        return seen[id];
+    }
+
+    uint64_t progress(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return seen[id].progress;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<uint64_t, Seen> seen;
+    std::thread::id caller = std::this_thread::get_id();
+};
+
+static bool write_random_file(const std::string& path, uint64_t size) {
+    std::vector<unsigned char> block(1u << 20);
+    std::ofstream out(path, std::ios::binary);
+    for (uint64_t left = size; left && out;) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(left, block.size()));
+        randombytes_buf(block.data(), n);
+        out.write(reinterpret_cast<const char*>(block.data()), n);
+        left -= n;
+    }
+    return static_cast<bool>(out);
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static Job make_job(JobKind kind, const std::string& input, const std::string& output) {
+    Job job;
+    job.kind = kind;
+    job.input = input;
+    job.output = output;
+    job.password = "bench";
+    return job;
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    const char* tmp = std::getenv("TMPDIR");
+    std::string dir = std::string(tmp && *tmp ? tmp : "/tmp") + "/cryptofrog-jobs-XXXXXX";
+    if (!mkdtemp(&dir[0])) return 1;
+
+    Recorder recorder;
+    JobQueue queue(recorder.callbacks());
+    int bad = 0;
+
+    // Four files through the queue, then back.
+    const uint64_t size = 8u << 20;
+    std::vector<std::string> plain;
+    std::vector<uint64_t> enc_ids, dec_ids;
+    for (int i = 0; i < 4; ++i) {
+        plain.push_back(dir + "/file" + std::to_string(i));
+        if (!write_random_file(plain.back(), size)) ++bad;
+    }
+    auto start = Clock::now();
+    for (const std::string& path : plain) enc_ids.push_back(queue.submit(make_job(JobKind::Encrypt, path, path + ".ecc")));
+    for (const std::string& path : plain)
+        dec_ids.push_back(queue.submit(make_job(JobKind::Decrypt, path + ".ecc", path + ".out")));
+    for (size_t i = 0; i < plain.size(); ++i) {
+        for (uint64_t id : {enc_ids[i], dec_ids[i]}) {
+            Seen s = recorder.wait(id);
+            if (!s.result.ok || s.bad_order || !s.off_thread || s.total == 0 || s.progress < s.total * 99 / 100 ||
+                s.progress > s.total)
+                ++bad;
+        }
+        if (read_file(plain[i]) != read_file(plain[i] + ".out")) ++bad;
+    }
+    double batch_s = std::chrono::duration<double>(Clock::now() - start).count();
+    if (queue.unfinished() != 0) ++bad;
+    std::printf("8 jobs of 8 MiB (4 enc + 4 dec): %.2f s\n", batch_s);
+
+    // Cancel in the middle of a large file.
+    const std::string big = dir + "/big";
+    if (!write_random_file(big, 512u << 20)) ++bad;
+    uint64_t id = queue.submit(make_job(JobKind::Encrypt, big, big + ".ecc"));
+    while (recorder.progress(id) < (64u << 20)) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto cancel_at = Clock::now();
+    queue.cancel(id);
+    Seen s = recorder.wait(id);
+    double cancel_ms = std::chrono::duration<double, std::milli>(s.finished_at - cancel_at).count();
+    if (s.result.ok || !s.result.cancelled || std::filesystem::exists(big + ".ecc") ||
+        std::filesystem::file_size(big) != (512u << 20))
+        ++bad;
+    std::printf("cancel at %llu MiB of 512: finished %.1f ms later\n",
+                static_cast<unsigned long long>(s.progress >> 20), cancel_ms);
+
+    // Cancelled before running: never started, no output.
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 3; ++i) ids.push_back(queue.submit(make_job(JobKind::Encrypt, plain[i], plain[i] + ".x")));
+    queue.cancel_all();
+    for (int i = 0; i < 3; ++i) {
+        Seen c = recorder.wait(ids[i]);
+        if (c.result.ok || !c.result.cancelled || std::filesystem::exists(plain[i] + ".x")) ++bad;
+        if (i > 0 && c.started) ++bad;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    if (bad) {
+        std::fprintf(stderr, "job queue mismatch: %d\n", bad);
+        return 1;
+    }
+    return 0;
+}
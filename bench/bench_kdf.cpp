@@ -0,0 +1,98 @@
+// Argon2 parameters: unlock time of one file for a few --kdf settings (the parameters travel
+// in the keyslot, so decryption needs no options), then calibrate_kdf for three targets with
+// the time it actually measured. Every file must open with default options, and one whose
+// keyslot asks for more passes than allowed must be refused without deriving.
+
+#include "encrypt.h"
+#include "decrypt.h"
+#include "format.h"
+#include "session.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static bool run(const std::string& input, std::string& output, bool seal, const CryptoOptions& options) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    std::unique_ptr<InputSource> src = wrap_input(in);
+    std::unique_ptr<OutputSink> dst = wrap_output(out);
+    bool ok = seal ? encrypt_stream(*src, *dst, "bench", options) : decrypt_stream(*src, *dst, "bench", options);
+    output = out.str();
+    return ok;
+}
+
+// Offset of the KDF parameters of the first keyslot, or 0 if the header has none.
+static size_t kdf_offset(const std::string& sealed) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(sealed.data());
+    FileHeader hdr;
+    if (!parse_header_core(data, sealed.size(), hdr)) return 0;
+    for (size_t pos = HEADER_CORE_BYTES; pos + 3 <= hdr.header_len && data[pos] != TAG_PADDING;) {
+        size_t len = data[pos + 1] | (data[pos + 2] << 8);
+        if (data[pos] == TAG_KEYSLOT && len == KEYSLOT_RECORD_BYTES - 3) return pos + KEYSLOT_BASE_RECORD_BYTES;
+        pos += 3 + len;
+    }
+    return 0;
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    std::string plain(1 << 20, '\0');
+    randombytes_buf(&plain[0], plain.size());
+    int bad = 0;
+
+    const KdfParams settings[] = {{KDF_ARGON2ID13, 2, 64u << 20},
+                                  {KDF_ARGON2ID13, 3, 256u << 20},
+                                  {KDF_ARGON2ID13, 1, 1u << 30},
+                                  {KDF_ARGON2ID13, 4, 1u << 30}};
+    std::printf("--kdf      unlock ms\n");
+    for (const KdfParams& kdf : settings) {
+        CryptoOptions options;
+        options.kdf = kdf;
+        std::string sealed, back;
+        if (!run(plain, sealed, true, options)) ++bad;
+        auto start = Clock::now();
+        if (!run(sealed, back, false, CryptoOptions()) || back != plain) ++bad;
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        char label[32];
+        std::snprintf(label, sizeof(label), "%u:%lluM", kdf.opslimit, static_cast<unsigned long long>(kdf.memlimit >> 20));
+        std::printf("%-9s %9.0f\n", label, ms);
+    }
+
+    // 200 passes is over KDF_MAX_OPSLIMIT: refused at once instead of running for minutes.
+    {
+        CryptoOptions options;
+        options.kdf.opslimit = 1;
+        options.kdf.memlimit = 8u << 20;
+        std::string sealed, back;
+        size_t at = run(plain, sealed, true, options) ? kdf_offset(sealed) : 0;
+        if (!at) ++bad;
+        else {
+            sealed[at + 1] = static_cast<char>(200);
+            auto start = Clock::now();
+            if (run(sealed, back, false, CryptoOptions())) ++bad;
+            if (std::chrono::duration<double>(Clock::now() - start).count() > 0.5) ++bad;
+        }
+    }
+
+    std::printf("target ms  chosen      measured ms\n");
+    for (unsigned target : {250u, 500u, 1000u}) {
+        unsigned ms = 0;
+        KdfParams kdf = calibrate_kdf(target, 1u << 30, &ms);
+        if (!kdf_params_valid(kdf)) ++bad;
+        char chosen[32];
+        std::snprintf(chosen, sizeof(chosen), "%u:%lluM", kdf.opslimit,
+                      static_cast<unsigned long long>(kdf.memlimit >> 20));
+        std::printf("%9u  %-11s %11u\n", target, chosen, ms);
+    }
+    if (bad) {
+        std::fprintf(stderr, "kdf mismatch: %d\n", bad);
+        return 1;
+    }
+    return 0;
+}
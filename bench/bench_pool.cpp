@@ -0,0 +1,102 @@
+// Memory pools: a batch of small files encrypted and decrypted back to back, once with the
+// I/O buffer pool kept warm between files and once trimmed before every file (a fresh set of
+// segment buffers per file, as before the pool). The warm batch must not allocate a single
+// buffer after the first file, the secure arena must get every key block back, reused
+// buffers must come back zeroed, and every file must round-trip.
+
+#include "encrypt.h"
+#include "decrypt.h"
+#include "memory_pool.h"
+#include <sodium.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static bool seal(const std::string& input, std::string& output, bool encrypt, const CryptoOptions& options) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    std::unique_ptr<InputSource> src = wrap_input(in);
+    std::unique_ptr<OutputSink> dst = wrap_output(out);
+    bool ok = encrypt ? encrypt_stream(*src, *dst, "bench", options) : decrypt_stream(*src, *dst, "bench", options);
+    output = out.str();
+    return ok;
+}
+
+// Encrypts and decrypts every file; returns seconds, or a negative value on a mismatch.
+static double run_batch(const std::vector<std::string>& files, const CryptoOptions& options, bool trim_each) {
+    auto start = Clock::now();
+    for (const std::string& plain : files) {
+        if (trim_each) io_buffer_pool().trim();
+        std::string sealed, opened;
+        if (!seal(plain, sealed, true, options) || !seal(sealed, opened, false, options) || opened != plain) return -1;
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    // Cheap Argon2: the point is the per-file allocations around it.
+    CryptoOptions options;
+    options.kdf.opslimit = 1;
+    options.kdf.memlimit = 8u << 20;
+
+    const size_t count = 64;
+    std::vector<std::string> files(count);
+    for (size_t i = 0; i < count; ++i) {
+        files[i].resize((1u << 20) + i * 4099);
+        randombytes_buf(&files[i][0], files[i].size());
+    }
+    int bad = 0;
+
+    run_batch({files[0]}, options, false);   // warm-up
+    BufferPool::Counters before = io_buffer_pool().counters();
+    SecureArena::Counters secrets_before = secure_arena().counters();
+    double warm_s = run_batch(files, options, false);
+    BufferPool::Counters warm = io_buffer_pool().counters();
+    SecureArena::Counters secrets = secure_arena().counters();
+    double cold_s = run_batch(files, options, true);
+    BufferPool::Counters cold = io_buffer_pool().counters();
+    if (warm_s < 0 || cold_s < 0) ++bad;
+
+    unsigned long long warm_alloc = warm.allocations - before.allocations, warm_reuse = warm.reuses - before.reuses;
+    unsigned long long cold_alloc = cold.allocations - warm.allocations;
+    std::printf("%zu files enc+dec, pool kept:    %6.1f ms/file, %llu allocations, %llu reuses\n", count,
+                warm_s * 1000 / count, warm_alloc, warm_reuse);
+    std::printf("%zu files enc+dec, pool trimmed: %6.1f ms/file, %llu allocations\n", count, cold_s * 1000 / count,
+                cold_alloc);
+    if (warm_alloc != 0 || warm_reuse == 0 || cold_alloc == 0) ++bad;
+
+    unsigned long long blocks = secrets.blocks - secrets_before.blocks;
+    std::printf("secret blocks: %llu for the batch, peak %llu in use, %llu bytes locked, %llu unlocked\n", blocks,
+                static_cast<unsigned long long>(secrets.peak_in_use),
+                static_cast<unsigned long long>(secrets.locked_bytes),
+                static_cast<unsigned long long>(secrets.unlocked_bytes));
+    if (blocks == 0 || secure_arena().counters().in_use != 0) ++bad;
+
+    // A returned buffer holds no trace of the previous lease.
+    {
+        BufferPool::Lease lease = io_buffer_pool().acquire(1u << 20);
+        std::fill(lease.data(), lease.data() + lease.size(), static_cast<unsigned char>(0xa5));
+    }
+    {
+        BufferPool::Lease lease = io_buffer_pool().acquire(1u << 20);
+        for (size_t i = 0; i < lease.size(); ++i)
+            if (lease.data()[i] != 0) {
+                ++bad;
+                break;
+            }
+    }
+
+    if (bad) {
+        std::fprintf(stderr, "memory pool mismatch: %d\n", bad);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Public-key mode: cost of encrypting one file to N recipients, split into the per-batch
+// key agreement and the per-file work, against a single-password file. Every recipient
+// must open the result and a stranger must not.
+
+#include "encrypt.h"
+#include "decrypt.h"
+#include "recipient.h"
+#include "session.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+static double seconds(F&& f) {
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool encrypt_buffer(const std::string& plain, std::string& sealed, const std::string& password,
+                           const CryptoOptions& options) {
+    std::istringstream in(plain);
+    std::ostringstream out;
+    std::unique_ptr<InputSource> src = wrap_input(in);
+    std::unique_ptr<OutputSink> dst = wrap_output(out);
+    bool ok = encrypt_stream(*src, *dst, password, options);
+    sealed = out.str();
+    return ok;
+}
+
+static bool decrypt_buffer(const std::string& sealed, std::string& plain, const CryptoOptions& options) {
+    std::istringstream in(sealed);
+    std::ostringstream out;
+    std::unique_ptr<InputSource> src = wrap_input(in);
+    std::unique_ptr<OutputSink> dst = wrap_output(out);
+    bool ok = decrypt_stream(*src, *dst, std::string(), options);
+    plain = out.str();
+    return ok;
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    const size_t count = 50;
+    const size_t files = 20;
+    std::vector<std::unique_ptr<Identity>> identities(count);
+    std::vector<Recipient> recipients(count);
+    for (size_t i = 0; i < count; ++i) {
+        identities[i].reset(new Identity());
+        if (!identities[i]->generate()) return 1;
+        recipients[i] = identities[i]->public_key();
+    }
+    Identity stranger;
+    if (!stranger.generate()) return 1;
+
+    std::string plain(1 << 20, '\0');
+    randombytes_buf(&plain[0], plain.size());
+
+    std::unique_ptr<RecipientSet> set;
+    double t_agree = seconds([&] { set.reset(new RecipientSet(recipients)); });
+    if (!set->valid()) return 1;
+
+    CryptoOptions options;
+    options.threads = 1;
+    options.recipients = set.get();
+    std::string sealed;
+    bool ok = true;
+    double t_files = seconds([&] {
+        for (size_t f = 0; f < files; ++f) ok = encrypt_buffer(plain, sealed, std::string(), options) && ok;
+    });
+
+    CryptoOptions password_options;
+    password_options.threads = 1;
+    KeySession session("correct horse");
+    password_options.session = &session;
+    std::string password_sealed;
+    ok = encrypt_buffer(plain, password_sealed, "correct horse", password_options) && ok;
+    double t_password = seconds([&] {
+        for (size_t f = 0; f < files; ++f)
+            ok = encrypt_buffer(plain, password_sealed, "correct horse", password_options) && ok;
+    });
+
+    int bad = ok ? 0 : 1;
+    for (size_t i = 0; i < count; ++i) {
+        CryptoOptions open;
+        open.threads = 1;
+        open.identity = identities[i].get();
+        std::string back;
+        if (!decrypt_buffer(sealed, back, open) || back != plain) ++bad;
+    }
+    CryptoOptions open;
+    open.identity = &stranger;
+    std::string back;
+    if (decrypt_buffer(sealed, back, open)) ++bad;
+    if (bad) {
+        std::fprintf(stderr, "recipient mismatch: %d\n", bad);
+        return 1;
+    }
+
+    std::printf("%zu recipients, %zu files of 1 MiB\n", count, files);
+    std::printf("%-34s %10.2f ms\n", "key agreement (once per batch)", t_agree * 1e3);
+    std::printf("%-34s %10.2f ms\n", "per file, recipients", t_files * 1e3 / files);
+    std::printf("%-34s %10.2f ms\n", "per file, one password (session)", t_password * 1e3 / files);
+    std::printf("%-34s %10zu bytes\n", "size over plaintext", sealed.size() - plain.size());
+    return 0;
+}
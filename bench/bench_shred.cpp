@@ -0,0 +1,109 @@
+// Shredding: the old whole-file approach (one zero vector the size of the file, a single
+// buffered write) vs Shredder with a reused chunk, and a directory of files with one worker
+// vs all cores. Peak RSS is read after each stage. Overwritten content is checked with
+// remove = false, and a directory tree must disappear entirely.
+
+#include "shred.h"
+#include <sodium.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+using Clock = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+static double peak_rss_mib() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+static void write_random(const fs::path& path, size_t size) {
+    std::vector<char> chunk(1 << 20);
+    std::ofstream out(path, std::ios::binary);
+    for (size_t done = 0; done < size; done += chunk.size()) {
+        randombytes_buf(chunk.data(), chunk.size());
+        out.write(chunk.data(), static_cast<std::streamsize>(std::min(chunk.size(), size - done)));
+    }
+}
+
+// What utils.h used to do.
+static bool whole_file_delete(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::streamsize size = file.tellg();
+    file.close();
+    std::ofstream wipe(path, std::ios::binary);
+    std::vector<unsigned char> zeros(size, 0x00);
+    wipe.write(reinterpret_cast<const char*>(zeros.data()), size);
+    wipe.close();
+    return fs::remove(path);
+}
+
+int main() {
+    if (sodium_init() < 0) return 1;
+
+    const fs::path dir = fs::temp_directory_path() / "cryptofrog_bench_shred";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "tree" / "sub");
+
+    int bad = 0;
+    const size_t big = 512u << 20;
+    const fs::path big_path = dir / "big.bin";
+
+    // remove = false leaves the file in place to check what was written.
+    write_random(big_path, big);
+    ShredOptions keep;
+    keep.remove = false;
+    keep.zero_pass = true;
+    ShredStats check;
+    if (!shred_file(big_path.string(), keep, &check) || fs::file_size(big_path) != big || check.written != 2 * big) ++bad;
+    {
+        std::ifstream in(big_path, std::ios::binary);
+        std::vector<char> chunk(1 << 20);
+        while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0) {
+            for (std::streamsize i = 0; i < in.gcount(); ++i) bad += chunk[i] != 0;
+            if (bad) break;
+        }
+    }
+
+    ShredStats one;
+    if (!shred_file(big_path.string(), ShredOptions(), &one) || fs::exists(big_path)) ++bad;
+    double rss_chunked = peak_rss_mib();
+
+    write_random(big_path, big);
+    auto start = Clock::now();
+    whole_file_delete(big_path.string());
+    double t_whole = std::chrono::duration<double>(Clock::now() - start).count();
+    double rss_whole = peak_rss_mib();
+
+    const size_t files = 256, file_size = 1 << 20;
+    ShredStats serial, parallel;
+    for (ShredStats* stats : {&serial, &parallel}) {
+        for (size_t i = 0; i < files; ++i)
+            write_random(dir / "tree" / (i % 2 ? "sub" : "") / ("f" + std::to_string(i)), file_size);
+        ShredOptions options;
+        options.jobs = stats == &serial ? 1 : 0;
+        std::vector<std::string> failed;
+        if (!shred_paths({(dir / "tree").string()}, options, *stats, failed) || !failed.empty() ||
+            stats->files != files || fs::exists(dir / "tree"))
+            ++bad;
+        fs::create_directories(dir / "tree" / "sub");
+    }
+    fs::remove_all(dir);
+    if (bad) {
+        std::fprintf(stderr, "shred mismatch: %d\n", bad);
+        return 1;
+    }
+
+    std::printf("512 MiB file                       MiB/s  peak RSS MiB\n");
+    std::printf("%-32s %8.0f %10.0f\n", "whole-file buffer, no sync", big / t_whole / (1 << 20), rss_whole);
+    std::printf("%-32s %8.0f %10.0f\n", "Shredder, 1 MiB chunk + sync", one.mib_per_s(), rss_chunked);
+    std::printf("%zu files of 1 MiB\n", files);
+    std::printf("%-32s %8.0f\n", "shred_paths, 1 job", serial.mib_per_s());
+    std::printf("%-32s %8.0f\n", "shred_paths, all cores", parallel.mib_per_s());
+    return 0;
+}
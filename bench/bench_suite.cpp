@@ -0,0 +1,305 @@
+// Benchmark suite: the hot paths behind every file, with output meant to be diffed between
+// commits (see harness.h for the statistics and the TSV/baseline options).
+//   ecc/*     ECCFrog512CK2 point addition, scalar multiplication and point codecs
+//   kdf/*     one Argon2id derivation at the default KdfParams
+//   aead/*    raw seal/open per available suite, 1 KiB to 64 MiB messages
+//   stream/*  encrypt_stream of 1 and 4 GiB from a generated source into a null sink
+//   file/*    encrypt_file/decrypt_file round trips on a temporary directory
+// --quick trims sizes and sample counts for a run of well under a minute. Each group checks
+// its results (fast paths against the reference, round trips) and a failed check exits 1.
+
+#include "harness.h"
+#include "aead.h"
+#include "decrypt.h"
+#include "eccfrog512ck2.h"
+#include "encrypt.h"
+#include "session.h"
+#include <sodium.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static mpz_class random_scalar(const mpz_class& n) {
+    unsigned char buf[64];
+    mpz_class k;
+    do {
+        randombytes_buf(buf, sizeof(buf));
+        mpz_import(k.get_mpz_t(), sizeof(buf), 1, 1, 0, 0, buf);
+        k %= n;
+    } while (k == 0);
+    return k;
+}
+
+static bool same(const ECCFrog512CK2::Point& a, const ECCFrog512CK2::Point& b) {
+    if (a.at_infinity || b.at_infinity) return a.at_infinity == b.at_infinity;
+    return a.x == b.x && a.y == b.y;
+}
+
+static std::string size_label(uint64_t bytes) {
+    static const char units[] = "KMG";
+    int u = -1;
+    while (u < 2 && bytes >= 1024 && bytes % 1024 == 0) {
+        bytes /= 1024;
+        ++u;
+    }
+    return std::to_string(bytes) + (u < 0 ? "" : std::string(1, units[u]));
+}
+
+// Serves `total` bytes by repeating one random block, so multi-GiB runs need no memory.
+class RepeatSource : public InputSource {
+public:
+    RepeatSource(const std::vector<unsigned char>& block, uint64_t total) : block(block), left(total) {}
+    size_t acquire(unsigned char* scratch, size_t len, const unsigned char** data) override {
+        *data = scratch;
+        size_t n = 0;
+        while (n < len && left) {
+            size_t chunk = std::min<uint64_t>({len - n, left, block.size() - offset});
+            std::memcpy(scratch + n, block.data() + offset, chunk);
+            offset = (offset + chunk) % block.size();
+            left -= chunk;
+            n += chunk;
+        }
+        return n;
+    }
+    bool at_end() override { return left == 0; }
+    bool failed() const override { return false; }
+
+private:
+    const std::vector<unsigned char>& block;
+    uint64_t left;
+    size_t offset = 0;
+};
+
+class NullSink : public OutputSink {
+public:
+    bool write(const unsigned char*, size_t len) override {
+        written += len;
+        return true;
+    }
+    bool finish() override { return true; }
+    uint64_t written = 0;
+};
+
+static void bench_ecc(Harness& h) {
+    ECCFrog512CK2 curve;
+    const mpz_class n = curve.get_n();
+    const ECCFrog512CK2::Point G = curve.get_G();
+    const size_t count = 64, samples = h.quick() ? 5 : 15;
+
+    std::vector<mpz_class> k(count);
+    std::vector<ECCFrog512CK2::Point> P(count);
+    for (size_t i = 0; i < count; ++i) {
+        k[i] = random_scalar(n);
+        P[i] = curve.scalar_mul_base(random_scalar(n));
+    }
+    std::vector<std::vector<unsigned char>> compressed(count, std::vector<unsigned char>(65)),
+        uncompressed(count, std::vector<unsigned char>(129));
+    for (size_t i = 0; i < count; ++i) {
+        if (!P[i].encode_compressed(compressed[i].data(), 65) || !P[i].encode_uncompressed(uncompressed[i].data(), 129))
+            h.fail("ecc/encode");
+        if (!same(curve.point_from_bytes(compressed[i].data(), 65), P[i]) ||
+            !same(curve.point_from_bytes(uncompressed[i].data(), 129), P[i]))
+            h.fail("ecc/decode");
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        const ECCFrog512CK2::Point& Q = P[(i + 1) % count];
+        if (!same(curve.add_points(P[i], Q), curve.add_points_reference(P[i], Q))) h.fail("ecc/add_points");
+        ECCFrog512CK2::Point ref = curve.scalar_mul_reference(P[i], k[i]);
+        if (!same(curve.scalar_mul(P[i], k[i]), ref) || !same(curve.scalar_mul_ct(P[i], k[i]), ref) ||
+            curve.ecdh_x(P[i], k[i]) != ref.x || !same(curve.scalar_mul_base(k[i]), curve.scalar_mul_reference(G, k[i])))
+            h.fail("ecc/scalar_mul");
+    }
+
+    // Every call crosses into the library, so the results need no sink.
+    ECCFrog512CK2::Point acc = P[0];
+    h.ops("ecc/add_points", 16 * count, samples, [&] {
+        for (int r = 0; r < 16; ++r)
+            for (size_t i = 0; i < count; ++i) acc = curve.add_points(acc, P[i]);
+    });
+    h.ops("ecc/scalar_mul", count, samples, [&] {
+        for (size_t i = 0; i < count; ++i) acc = curve.scalar_mul(P[i], k[i]);
+    });
+    h.ops("ecc/scalar_mul_base", count, samples, [&] {
+        for (size_t i = 0; i < count; ++i) acc = curve.scalar_mul_base(k[i]);
+    });
+    h.ops("ecc/scalar_mul_ct", count / 4, samples, [&] {
+        for (size_t i = 0; i < count / 4; ++i) acc = curve.scalar_mul_ct(P[i], k[i]);
+    });
+    h.ops("ecc/ecdh_x", count / 4, samples, [&] {
+        for (size_t i = 0; i < count / 4; ++i) acc.x = curve.ecdh_x(P[i], k[i]);
+    });
+    unsigned char out[129];
+    h.ops("ecc/encode_compressed", 16 * count, samples, [&] {
+        for (int r = 0; r < 16; ++r)
+            for (size_t i = 0; i < count; ++i) P[i].encode_compressed(out, sizeof(out));
+    });
+    h.ops("ecc/encode_uncompressed", 16 * count, samples, [&] {
+        for (int r = 0; r < 16; ++r)
+            for (size_t i = 0; i < count; ++i) P[i].encode_uncompressed(out, sizeof(out));
+    });
+    h.ops("ecc/decode_compressed", count, samples, [&] {
+        for (size_t i = 0; i < count; ++i) acc = curve.point_from_bytes(compressed[i].data(), 65);
+    });
+    h.ops("ecc/decode_uncompressed", count, samples, [&] {
+        for (size_t i = 0; i < count; ++i) acc = curve.point_from_bytes(uncompressed[i].data(), 129);
+    });
+}
+
+static void bench_kdf(Harness& h) {
+    const KdfParams params;
+    std::string name = "kdf/argon2id/" + std::to_string(params.opslimit) + ":" + size_label(params.memlimit);
+    unsigned char salt[crypto_pwhash_SALTBYTES] = {0};
+    unsigned char key[32];
+    bool ok = true;
+    h.latency(name, h.quick() ? 3 : 7, [&] { ok = derive_password_key("bench", salt, key, params) && ok; });
+    if (h.wanted(name) && !ok) h.fail(name);
+}
+
+static void bench_aead(Harness& h) {
+    std::vector<uint64_t> sizes = {1u << 10, 16u << 10, 1u << 20};
+    if (!h.quick()) sizes.push_back(64u << 20);
+    const uint64_t work = h.quick() ? 16u << 20 : 128u << 20;   // bytes per sample, small messages batched
+
+    unsigned char key[AEAD_KEY_BYTES], npub[AEAD_MAX_NPUBBYTES] = {0}, ad[20] = {0};
+    randombytes_buf(key, sizeof(key));
+    for (CipherSuite id : aead_available()) {
+        const AeadSuite* suite = aead_suite(static_cast<uint8_t>(id));
+        for (uint64_t size : sizes) {
+            std::string base = std::string("aead/") + cipher_suite_name(id) + "/";
+            std::vector<unsigned char> plain(size), sealed(size + suite->abytes), back(size);
+            randombytes_buf(plain.data(), plain.size());
+            const uint64_t reps = std::max<uint64_t>(1, work / size);
+            const size_t samples = size >= (64u << 20) ? 5 : h.quick() ? 5 : 11;
+            unsigned long long len = 0;
+            bool ok = true;
+
+            h.throughput(base + "seal/" + size_label(size), double(reps * size), samples, [&] {
+                for (uint64_t r = 0; r < reps; ++r)
+                    ok = suite->encrypt(sealed.data(), &len, plain.data(), size, ad, sizeof(ad), nullptr, npub, key) == 0 && ok;
+            });
+            h.throughput(base + "open/" + size_label(size), double(reps * size), samples, [&] {
+                for (uint64_t r = 0; r < reps; ++r)
+                    ok = suite->decrypt(back.data(), &len, nullptr, sealed.data(), sealed.size(), ad, sizeof(ad), npub,
+                                        key) == 0 && ok;
+            });
+            if (!ok || (h.wanted(base + "open/" + size_label(size)) && back != plain)) h.fail(base + size_label(size));
+        }
+    }
+}
+
+static void bench_stream(Harness& h) {
+    std::vector<uint64_t> sizes = {64u << 20};
+    if (!h.quick()) sizes = {1ull << 30, 4ull << 30};
+    std::vector<unsigned char> block(1u << 20);
+    randombytes_buf(block.data(), block.size());
+
+    KeySession session("bench");   // Argon2 once, outside the timed runs
+    CryptoOptions options;
+    options.session = &session;
+    for (uint64_t size : sizes) {
+        std::string name = "stream/encrypt/" + size_label(size);
+        bool ok = true;
+        uint64_t written = 0;
+        h.throughput(name, double(size), 3, [&] {
+            RepeatSource src(block, size);
+            NullSink dst;
+            ok = encrypt_stream(src, dst, "bench", options) && ok;
+            written = dst.written;
+        });
+        if (h.wanted(name) && (!ok || written <= size)) h.fail(name);
+    }
+}
+
+static bool write_random_file(const std::string& path, uint64_t size) {
+    std::vector<unsigned char> block(1u << 20);
+    std::ofstream out(path, std::ios::binary);
+    for (uint64_t left = size; left && out;) {
+        size_t n = std::min<uint64_t>(left, block.size());
+        randombytes_buf(block.data(), n);
+        out.write(reinterpret_cast<const char*>(block.data()), n);
+        left -= n;
+    }
+    return static_cast<bool>(out);
+}
+
+static bool same_file(const std::string& a, const std::string& b) {
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    std::vector<char> ba(1u << 20), bb(1u << 20);
+    while (fa && fb) {
+        fa.read(ba.data(), ba.size());
+        fb.read(bb.data(), bb.size());
+        if (fa.gcount() != fb.gcount() || !std::equal(ba.begin(), ba.begin() + fa.gcount(), bb.begin())) return false;
+    }
+    return fa.eof() && fb.eof();
+}
+
+static void bench_files(Harness& h) {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string dir = std::string(tmp && *tmp ? tmp : "/tmp") + "/cryptofrog-bench-XXXXXX";
+    if (!mkdtemp(&dir[0])) {
+        h.fail("file/tmpdir");
+        return;
+    }
+    const std::string plain = dir + "/plain", sealed = dir + "/plain.ecc", back = dir + "/back";
+
+    // 1 MiB with a fresh Argon2 per file: what one `enc` of a small file costs.
+    if (write_random_file(plain, 1u << 20)) {
+        bool ok = true;
+        h.latency("file/encrypt_file/1M+kdf", h.quick() ? 3 : 5,
+                  [&] { ok = encrypt_file(plain, sealed, "bench") && ok; });
+        h.latency("file/decrypt_file/1M+kdf", h.quick() ? 3 : 5,
+                  [&] { ok = decrypt_file(sealed, back, "bench") && ok; });
+        if (h.wanted("file/decrypt_file/1M+kdf") && (!ok || !same_file(plain, back))) h.fail("file/1M+kdf");
+    } else {
+        h.fail("file/write");
+    }
+
+    // Throughput with the KDF cached by a session: the I/O and cipher pipeline alone.
+    KeySession session("bench");
+    CryptoOptions options;
+    options.session = &session;
+    const uint64_t size = h.quick() ? 64u << 20 : 1ull << 30;
+    if (write_random_file(plain, size)) {
+        bool ok = true;
+        const std::string label = size_label(size);
+        h.throughput("file/encrypt_file/" + label, double(size), 3,
+                     [&] { ok = encrypt_file(plain, sealed, "bench", options) && ok; });
+        h.throughput("file/decrypt_file/" + label, double(size), 3,
+                     [&] { ok = decrypt_file(sealed, back, "bench", options) && ok; });
+        if (h.wanted("file/decrypt_file/" + label) && (!ok || !same_file(plain, back))) h.fail("file/" + label);
+    } else {
+        h.fail("file/write");
+    }
+    for (const std::string& path : {plain, sealed, back}) std::remove(path.c_str());
+    rmdir(dir.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    Harness h(argc, argv);
+    if (!h.ok()) {
+        std::fprintf(stderr,
+                     "usage: %s [--quick] [--filter SUBSTRING] [--samples N] [--out FILE.tsv] [--baseline FILE.tsv]\n",
+                     argv[0]);
+        return 2;
+    }
+    if (sodium_init() < 0) return 1;
+
+    std::string suites;
+    for (CipherSuite id : aead_available()) suites += std::string(suites.empty() ? "" : ",") + cipher_suite_name(id);
+    h.header(std::string("libsodium ") + sodium_version_string() + ", " +
+             std::to_string(std::thread::hardware_concurrency()) + " cores, suites " + suites + ", default " +
+             cipher_suite_name(aead_default()) + (h.quick() ? ", quick" : ""));
+
+    bench_ecc(h);
+    bench_kdf(h);
+    bench_aead(h);
+    bench_stream(h);
+    bench_files(h);
+    return h.finish();
+}
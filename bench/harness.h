@@ -0,0 +1,172 @@
+// Timing harness for bench_suite. Each case runs one warm-up sample and then a fixed
+// number of timed samples. It reports the median and the p10/p90/p99 of the per-sample
+// rate, so one slow sample (a page-cache flush, another process) moves the tails and not
+// the headline number. Results print as an aligned table. --out writes them as TSV, and
+// --baseline reads such a file back and adds the change of each median.
+
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class Harness {
+public:
+    // Units: "ops/s" and "MB/s" are higher-is-better, "ms" is lower-is-better.
+    struct Result {
+        std::string name, unit;
+        double median = 0, p10 = 0, p90 = 0, p99 = 0;
+        size_t samples = 0;
+    };
+
+    Harness(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+            if (arg == "--quick") quick_mode = true;
+            else if (arg == "--filter") filter = next();
+            else if (arg == "--out") out_path = next();
+            else if (arg == "--baseline") load_baseline(next());
+            else if (arg == "--samples") forced_samples = static_cast<size_t>(std::atoi(next()));
+            else usage_error = true;
+        }
+    }
+
+    bool ok() const { return !usage_error; }
+    bool quick() const { return quick_mode; }
+    bool wanted(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+
+    void header(const std::string& line) {
+        std::printf("# %s\n", line.c_str());
+        notes.push_back(line);
+    }
+
+    // fn() performs `count` operations; reported as ops/s.
+    template <typename F>
+    void ops(const std::string& name, double count, size_t samples, F&& fn) {
+        measure(name, "ops/s", samples, fn, [&](double secs) { return count / secs; });
+    }
+
+    // fn() processes `bytes` bytes; reported as MB/s (10^6 bytes).
+    template <typename F>
+    void throughput(const std::string& name, double bytes, size_t samples, F&& fn) {
+        measure(name, "MB/s", samples, fn, [&](double secs) { return bytes / secs / 1e6; });
+    }
+
+    // One call of fn() per sample; reported as milliseconds.
+    template <typename F>
+    void latency(const std::string& name, size_t samples, F&& fn) {
+        measure(name, "ms", samples, fn, [](double secs) { return secs * 1e3; });
+    }
+
+    // A case whose self-check failed: counted and reported, never timed.
+    void fail(const std::string& name) {
+        std::fprintf(stderr, "FAIL %s\n", name.c_str());
+        ++failures;
+    }
+
+    // Writes --out and returns the exit status (1 if any case failed its check).
+    int finish() {
+        if (!out_path.empty()) {
+            std::ofstream out(out_path);
+            for (const std::string& note : notes) out << "# " << note << "\n";
+            out << "case\tunit\tmedian\tp10\tp90\tp99\tsamples\n";
+            for (const Result& r : results) {
+                out << r.name << "\t" << r.unit << "\t" << r.median << "\t" << r.p10 << "\t" << r.p90 << "\t"
+                    << r.p99 << "\t" << r.samples << "\n";
+            }
+            if (!out) {
+                std::fprintf(stderr, "cannot write %s\n", out_path.c_str());
+                return 1;
+            }
+        }
+        return failures ? 1 : 0;
+    }
+
+private:
+    template <typename F, typename Rate>
+    void measure(const std::string& name, const char* unit, size_t samples, F& fn, Rate rate) {
+        if (!wanted(name)) return;
+        if (forced_samples) samples = forced_samples;
+        if (samples == 0) samples = 1;
+        if (!printed_columns) {
+            std::printf("%-36s %6s %12s %12s %12s %12s %4s%s\n", "case", "unit", "median", "p10", "p90", "p99", "n",
+                        baseline.empty() ? "" : "   vs base");
+            printed_columns = true;
+        }
+
+        fn();   // warm-up: tables, page cache, lazily created pools
+        std::vector<double> values;
+        for (size_t i = 0; i < samples; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            values.push_back(rate(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()));
+        }
+        std::sort(values.begin(), values.end());
+
+        Result r;
+        r.name = name;
+        r.unit = unit;
+        r.samples = values.size();
+        r.median = percentile(values, 50);
+        r.p10 = percentile(values, 10);
+        r.p90 = percentile(values, 90);
+        r.p99 = percentile(values, 99);
+        results.push_back(r);
+
+        std::printf("%-36s %6s %12.1f %12.1f %12.1f %12.1f %4zu", name.c_str(), unit, r.median, r.p10, r.p90, r.p99,
+                    r.samples);
+        auto base = baseline.find(name);
+        if (base != baseline.end() && base->second > 0) {
+            // Positive = better, whatever the unit.
+            double change = (r.median / base->second - 1) * 100;
+            if (r.unit == "ms") change = -change;
+            std::printf("  %+7.1f%%%s", change, change < -10 ? "  slower" : "");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    // Nearest-rank percentile of sorted values.
+    static double percentile(const std::vector<double>& sorted, double pct) {
+        size_t rank = static_cast<size_t>(std::ceil(pct / 100 * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    void load_baseline(const char* path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::fprintf(stderr, "cannot read baseline %s\n", path);
+            usage_error = true;
+            return;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#' || line.compare(0, 5, "case\t") == 0) continue;
+            std::istringstream fields(line);
+            std::string name, unit;
+            double median;
+            if (std::getline(fields, name, '\t') && std::getline(fields, unit, '\t') && fields >> median)
+                baseline[name] = median;
+        }
+    }
+
+    bool quick_mode = false, usage_error = false, printed_columns = false;
+    size_t forced_samples = 0;
+    int failures = 0;
+    std::string filter, out_path;
+    std::vector<std::string> notes;
+    std::vector<Result> results;
+    std::map<std::string, double> baseline;
+};
+
+#endif
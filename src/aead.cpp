@@ -0,0 +1,214 @@
+#include "aead.h"
+#include "format.h"
+#include <sodium.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <mutex>
+#include <openssl/evp.h>
+
+static_assert(DEK_BYTES == AEAD_KEY_BYTES, "a DEK serve a todas as suítes");
+static_assert(crypto_aead_xchacha20poly1305_ietf_KEYBYTES == AEAD_KEY_BYTES, "chave XChaCha20");
+static_assert(crypto_aead_xchacha20poly1305_ietf_NPUBBYTES <= AEAD_MAX_NPUBBYTES, "nonce XChaCha20");
+static_assert(SEGMENT_NONCE_BYTES <= crypto_aead_aes256gcm_NPUBBYTES, "nonce do segmento");
+
+// AES-256-GCM em software para hosts sem AES-NI, onde a libsodium não oferece a suíte.
+// Mesmo formato da libsodium: ciphertext || tag de 16 bytes, nonce de 12 bytes.
+static bool evp_update(EVP_CIPHER_CTX* ctx, bool enc, unsigned char* out, const unsigned char* in,
+                       unsigned long long len) {
+    while (len > 0) {
+        int chunk = len > INT_MAX / 2 ? INT_MAX / 2 : static_cast<int>(len);
+        int outl;
+        int ok = enc ? EVP_EncryptUpdate(ctx, out, &outl, in, chunk) : EVP_DecryptUpdate(ctx, out, &outl, in, chunk);
+        if (ok != 1) return false;
+        if (out) out += outl;
+        in += chunk;
+        len -= static_cast<unsigned long long>(chunk);
+    }
+    return true;
+}
+
+static int openssl_gcm_encrypt(unsigned char* c, unsigned long long* clen, const unsigned char* m,
+                               unsigned long long mlen, const unsigned char* ad, unsigned long long adlen,
+                               const unsigned char*, const unsigned char* npub, const unsigned char* k) {
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) return -1;
+    int outl;
+    bool ok = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, k, npub) == 1 &&
+              evp_update(ctx, true, NULL, ad, adlen) && evp_update(ctx, true, c, m, mlen) &&
+              EVP_EncryptFinal_ex(ctx, c + mlen, &outl) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, crypto_aead_aes256gcm_ABYTES, c + mlen) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    if (!ok) return -1;
+    if (clen) *clen = mlen + crypto_aead_aes256gcm_ABYTES;
+    return 0;
+}
+
+static int openssl_gcm_decrypt(unsigned char* m, unsigned long long* mlen, unsigned char*,
+                               const unsigned char* c, unsigned long long clen, const unsigned char* ad,
+                               unsigned long long adlen, const unsigned char* npub, const unsigned char* k) {
+    if (clen < crypto_aead_aes256gcm_ABYTES) return -1;
+    unsigned long long plen = clen - crypto_aead_aes256gcm_ABYTES;
+    unsigned char tag[crypto_aead_aes256gcm_ABYTES];
+    std::copy(c + plen, c + clen, tag);
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) return -1;
+    int outl;
+    bool ok = EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, k, npub) == 1 &&
+              evp_update(ctx, false, NULL, ad, adlen) && evp_update(ctx, false, m, c, plen) &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, sizeof(tag), tag) == 1 &&
+              EVP_DecryptFinal_ex(ctx, m + plen, &outl) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    if (!ok) {
+        // Como a libsodium: nada de texto claro não autenticado na saída.
+        sodium_memzero(m, plen);
+        return -1;
+    }
+    if (mlen) *mlen = plen;
+    return 0;
+}
+
+static const AeadSuite AES256GCM = {
+    CipherSuite::Aes256Gcm, crypto_aead_aes256gcm_NPUBBYTES, crypto_aead_aes256gcm_ABYTES,
+    crypto_aead_aes256gcm_encrypt, crypto_aead_aes256gcm_decrypt,
+};
+
+static const AeadSuite AES256GCM_SOFT = {
+    CipherSuite::Aes256Gcm, crypto_aead_aes256gcm_NPUBBYTES, crypto_aead_aes256gcm_ABYTES,
+    openssl_gcm_encrypt, openssl_gcm_decrypt,
+};
+
+static const AeadSuite XCHACHA20POLY1305 = {
+    CipherSuite::XChaCha20Poly1305, crypto_aead_xchacha20poly1305_ietf_NPUBBYTES,
+    crypto_aead_xchacha20poly1305_ietf_ABYTES,
+    crypto_aead_xchacha20poly1305_ietf_encrypt, crypto_aead_xchacha20poly1305_ietf_decrypt,
+};
+
+#ifdef crypto_aead_aegis256_KEYBYTES
+static_assert(crypto_aead_aegis256_KEYBYTES == AEAD_KEY_BYTES, "chave AEGIS-256");
+static_assert(crypto_aead_aegis256_NPUBBYTES <= AEAD_MAX_NPUBBYTES, "nonce AEGIS-256");
+static_assert(crypto_aead_aegis256_ABYTES <= AEAD_MAX_ABYTES, "tag AEGIS-256");
+
+static const AeadSuite AEGIS256 = {
+    CipherSuite::Aegis256, crypto_aead_aegis256_NPUBBYTES, crypto_aead_aegis256_ABYTES,
+    crypto_aead_aegis256_encrypt, crypto_aead_aegis256_decrypt,
+};
+#endif
+
+// Só o AES-GCM da libsodium depende do processador (AES-NI e PCLMUL, ou as extensões ARM).
+static bool has_aes_hardware() {
+    return crypto_aead_aes256gcm_is_available() != 0;
+}
+
+const AeadSuite* aead_suite(uint8_t id) {
+    switch (static_cast<CipherSuite>(id)) {
+    case CipherSuite::Aes256Gcm:
+        return has_aes_hardware() ? &AES256GCM : &AES256GCM_SOFT;
+    case CipherSuite::XChaCha20Poly1305:
+        return &XCHACHA20POLY1305;
+    case CipherSuite::Aegis256:
+#ifdef crypto_aead_aegis256_KEYBYTES
+        return &AEGIS256;
+#else
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+std::vector<CipherSuite> aead_available() {
+    std::vector<CipherSuite> suites;
+    for (CipherSuite id : {CipherSuite::Aes256Gcm, CipherSuite::XChaCha20Poly1305, CipherSuite::Aegis256}) {
+        if (aead_suite(static_cast<uint8_t>(id))) suites.push_back(id);
+    }
+    return suites;
+}
+
+bool aead_portable(CipherSuite suite) {
+    return suite != CipherSuite::Aegis256;
+}
+
+CipherSuite aead_default() {
+    // Não depende do host: a mesma escolha com ou sem AES-NI.
+    return CipherSuite::XChaCha20Poly1305;
+}
+
+std::vector<AeadSpeed> aead_benchmark(size_t message_bytes, double min_seconds) {
+    std::vector<unsigned char> m(message_bytes), c(message_bytes + AEAD_MAX_ABYTES);
+    unsigned char key[AEAD_KEY_BYTES], npub[AEAD_MAX_NPUBBYTES] = {0};
+    randombytes_buf(m.data(), m.size());
+    randombytes_buf(key, sizeof(key));
+
+    std::vector<AeadSpeed> speeds;
+    for (CipherSuite id : aead_available()) {
+        const AeadSuite* suite = aead_suite(static_cast<uint8_t>(id));
+        using Clock = std::chrono::steady_clock;
+
+        // Uma passada de aquecimento, depois repete até min_seconds.
+        unsigned long long clen;
+        suite->encrypt(c.data(), &clen, m.data(), m.size(), NULL, 0, NULL, npub, key);
+        size_t rounds = 0;
+        double elapsed = 0;
+        auto start = Clock::now();
+        do {
+            npub[0]++;
+            suite->encrypt(c.data(), &clen, m.data(), m.size(), NULL, 0, NULL, npub, key);
+            rounds++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < min_seconds);
+        speeds.push_back({id, rounds * message_bytes / elapsed});
+    }
+    sodium_memzero(key, sizeof(key));
+    return speeds;
+}
+
+CipherSuite aead_fastest(bool allow_unportable) {
+    static std::once_flag once;
+    static CipherSuite fastest = CipherSuite::XChaCha20Poly1305, fastest_portable = CipherSuite::XChaCha20Poly1305;
+    std::call_once(once, [] {
+        // Alguns milissegundos por suíte, com mensagens do tamanho de um segmento.
+        double best = 0, best_portable = 0;
+        for (const AeadSpeed& s : aead_benchmark(DEFAULT_SEGMENT_SIZE, 0.005)) {
+            if (s.bytes_per_second > best) {
+                best = s.bytes_per_second;
+                fastest = s.id;
+            }
+            if (aead_portable(s.id) && s.bytes_per_second > best_portable) {
+                best_portable = s.bytes_per_second;
+                fastest_portable = s.id;
+            }
+        }
+    });
+    return allow_unportable ? fastest : fastest_portable;
+}
+
+bool aead_resolve(CipherChoice choice, CipherSuite& suite, bool allow_unportable) {
+    switch (choice) {
+    case CipherChoice::Auto: suite = aead_default(); return true;
+    case CipherChoice::Fastest: suite = aead_fastest(allow_unportable); return true;
+    case CipherChoice::Aes256Gcm: suite = CipherSuite::Aes256Gcm; break;
+    case CipherChoice::XChaCha20Poly1305: suite = CipherSuite::XChaCha20Poly1305; break;
+    case CipherChoice::Aegis256: suite = CipherSuite::Aegis256; break;
+    }
+    return aead_suite(static_cast<uint8_t>(suite)) != nullptr && (allow_unportable || aead_portable(suite));
+}
+
+bool parse_cipher_choice(const std::string& name, CipherChoice& choice) {
+    if (name == "auto") choice = CipherChoice::Auto;
+    else if (name == "fastest") choice = CipherChoice::Fastest;
+    else if (name == "aes-gcm") choice = CipherChoice::Aes256Gcm;
+    else if (name == "xchacha20") choice = CipherChoice::XChaCha20Poly1305;
+    else if (name == "aegis256") choice = CipherChoice::Aegis256;
+    else return false;
+    return true;
+}
+
+const char* cipher_suite_name(CipherSuite suite) {
+    switch (suite) {
+    case CipherSuite::Aes256Gcm: return "aes-gcm";
+    case CipherSuite::XChaCha20Poly1305: return "xchacha20";
+    case CipherSuite::Aegis256: return "aegis256";
+    }
+    return "unknown";
+}
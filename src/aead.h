@@ -0,0 +1,87 @@
+#ifndef AEAD_H
+#define AEAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Suítes de cifra autenticada dos segmentos.
+//
+// O id da suíte fica no último byte do núcleo do header, que é dado associado de todos os
+// segmentos e dos keyslots. Arquivos anteriores têm 0 nesse byte e seguem como AES-256-GCM.
+// Todas as suítes usam chave de 32 bytes; o nonce do segmento (12 bytes) é completado com
+// zeros nas suítes de nonce maior, o que basta porque cada arquivo tem sua própria chave.
+enum class CipherSuite : uint8_t {
+    Aes256Gcm = 0,
+    XChaCha20Poly1305 = 1,
+    Aegis256 = 2,   // libsodium >= 1.0.19
+};
+
+// Escolha na cifragem. Auto é a suíte padrão (aead_default); Fastest mede as suítes
+// disponíveis uma vez por processo e fica com a mais rápida entre as portáveis.
+// AEGIS-256 não é portável: só abre em builds com libsodium >= 1.0.19, então gravá-la
+// (explicitamente ou via Fastest) exige allow_unportable.
+enum class CipherChoice {
+    Auto,
+    Fastest,
+    Aes256Gcm,
+    XChaCha20Poly1305,
+    Aegis256,
+};
+
+static const size_t AEAD_KEY_BYTES = 32;
+static const size_t AEAD_MAX_NPUBBYTES = 32;
+static const size_t AEAD_MAX_ABYTES = 32;
+
+// Assinaturas das funções crypto_aead_* da libsodium.
+typedef int (*AeadEncryptFn)(unsigned char* c, unsigned long long* clen, const unsigned char* m,
+                             unsigned long long mlen, const unsigned char* ad, unsigned long long adlen,
+                             const unsigned char* nsec, const unsigned char* npub, const unsigned char* k);
+typedef int (*AeadDecryptFn)(unsigned char* m, unsigned long long* mlen, unsigned char* nsec,
+                             const unsigned char* c, unsigned long long clen, const unsigned char* ad,
+                             unsigned long long adlen, const unsigned char* npub, const unsigned char* k);
+
+struct AeadSuite {
+    CipherSuite id;
+    size_t npub_bytes;
+    size_t abytes;
+    AeadEncryptFn encrypt;
+    AeadDecryptFn decrypt;
+};
+
+// Implementação utilizável neste host para a suíte `id`; nullptr se o id é desconhecido
+// ou a suíte não pode rodar aqui. AES-256-GCM sem AES-NI cai na OpenSSL (dependência
+// obrigatória), então AES-GCM e XChaCha20 abrem em qualquer build.
+const AeadSuite* aead_suite(uint8_t id);
+
+// Verdadeiro se todo build abre arquivos da suíte (falso só para AEGIS-256).
+bool aead_portable(CipherSuite suite);
+
+// Suítes utilizáveis neste host.
+std::vector<CipherSuite> aead_available();
+
+// XChaCha20-Poly1305: rápida em qualquer CPU, com ou sem instruções AES. AES-GCM e
+// AEGIS-256 só com escolha explícita (--cipher).
+CipherSuite aead_default();
+
+struct AeadSpeed {
+    CipherSuite id;
+    double bytes_per_second;
+};
+
+// Mede cada suíte disponível cifrando mensagens de message_bytes por ao menos min_seconds.
+std::vector<AeadSpeed> aead_benchmark(size_t message_bytes, double min_seconds);
+
+// Suíte mais rápida do aead_benchmark, só entre as portáveis sem allow_unportable;
+// medida uma vez e reaproveitada.
+CipherSuite aead_fastest(bool allow_unportable = false);
+
+// Resolve a escolha; falso se uma suíte pedida explicitamente não roda neste host, ou não
+// é portável e allow_unportable é falso.
+bool aead_resolve(CipherChoice choice, CipherSuite& suite, bool allow_unportable = false);
+
+bool parse_cipher_choice(const std::string& name, CipherChoice& choice);
+const char* cipher_suite_name(CipherSuite suite);
+
+#endif
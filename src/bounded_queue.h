@@ -0,0 +1,50 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Fila bloqueante entre estágios de um pipeline. close() acorda quem espera;
+// depois disso pop() esvazia o que restou e push() é ignorado.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : limit(capacity) {}
+
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < limit; });
+        if (closed) return false;
+        items.push_back(std::move(value));
+        not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        value = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    size_t limit;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable not_empty, not_full;
+    bool closed = false;
+};
+
+#endif
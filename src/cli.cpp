@@ -0,0 +1,990 @@
+#include "cli.h"
+#include "container.h"
+#include "encrypt.h"
+#include "decrypt.h"
+#include "header_journal.h"
+#include "keyslot.h"
+#include "memory_budget.h"
+#include "memory_pool.h"
+#include "recipient.h"
+#include "session.h"
+#include "shred.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+#include <sodium.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+struct CliConfig {
+    std::string command;
+    std::vector<std::string> inputs;
+    std::vector<std::string> lists;
+    std::string output;
+    std::string password_file;
+    std::string password_env = "CRYPTOFROG_PASSWORD";
+    std::string new_password_file;
+    std::string new_password_env = "CRYPTOFROG_NEW_PASSWORD";
+    std::vector<std::string> recipient_files;
+    std::string identity_file;
+    std::string stats_file;
+    RekeyMode rekey_mode = RekeyMode::Replace;
+    bool recursive = false;
+    bool force = false;
+    bool remove_input = false;
+    bool append = false;
+    bool quiet = false;
+    bool huge_pages = false;
+    bool range = false;
+    uint64_t range_offset = 0;
+    uint64_t range_length = UINT64_MAX;
+    unsigned jobs = 0;
+    uint64_t memory = 0;
+    bool kdf_set = false;
+    unsigned target_ms = 1000;
+    CryptoOptions crypto;
+    ShredOptions shred;
+};
+
+// Descarta a saída; usado por `verify`, que só precisa da autenticação.
+class NullSink : public OutputSink {
+public:
+    bool write(const unsigned char*, size_t) override { return true; }
+    bool finish() override { return true; }
+};
+
+static void print_usage(std::ostream& os) {
+    os << "Usage: cryptofrog <enc|dec|verify|rekey> [options] <file|dir|->...\n"
+          "       cryptofrog keygen -o BASE [-f]\n"
+          "       cryptofrog pack -o ARCHIVE [--append] [-r] <file|dir>...\n"
+          "       cryptofrog list ARCHIVE\n"
+          "       cryptofrog compact ARCHIVE\n"
+          "       cryptofrog extract ARCHIVE [-o DIR] [NAME...]\n"
+          "       cryptofrog shred [-r] [--passes N] [--zero] [--no-sync] <file|dir>...\n"
+          "       cryptofrog calibrate [--target MS] [-m SIZE]\n"
+          "\n"
+          "Commands:\n"
+          "  enc       encrypt each input to <input>.ecc\n"
+          "  dec       decrypt each .ecc input (output drops the .ecc suffix)\n"
+          "  verify    authenticate each .ecc input without writing plaintext\n"
+          "  rekey     change the password of each .ecc input (rewrites only the header)\n"
+          "  keygen    create a key pair: BASE.key (secret) and BASE.pub (share this one)\n"
+          "  pack      store many files in one encrypted archive (one key derivation for all)\n"
+          "  list      print the names, sizes and dates stored in an archive\n"
+          "  extract   restore all files of an archive, or only the NAMEs given, under DIR\n"
+          "  compact   rewrite an archive without the space left by replaced members\n"
+          "  shred     overwrite files in place, then delete them (directories with -r)\n"
+          "  calibrate time Argon2 on this host and print --kdf parameters for a target\n"
+          "            unlock time in ms, up to 600000 (-m caps the memory, default 1G;\n"
+          "            -q prints only OPS:MEM)\n"
+          "\n"
+          "Options:\n"
+          "  -r, --recursive          descend into directories\n"
+          "  -T, --files-from FILE    read input paths from FILE, one per line (- = stdin)\n"
+          "  -o, --output PATH        output path (single input only; - = stdout)\n"
+          "  -j, --jobs N             files processed in parallel (default: cores)\n"
+          "  -t, --threads N          segment threads per file (default: cores / jobs)\n"
+          "  -m, --memory SIZE        RAM for concurrent password derivations, e.g. 2G\n"
+          "                           (default: 3/4 of RAM or of the cgroup limit)\n"
+          "      --io BACKEND         stream, mmap or uring (default: stream)\n"
+          "      --huge-pages         back I/O buffers of 2 MiB or more with transparent huge pages\n"
+          "  -z, --compress           enc: compress segments with LZ4 before encrypting\n"
+          "                           (already-compressed data is detected and stored as is)\n"
+          "      --cipher SUITE       enc: aes-gcm, xchacha20, aegis256, fastest (measured\n"
+          "                           at startup) or auto (xchacha20; default)\n"
+          "      --allow-unportable-cipher\n"
+          "                           enc: allow aegis256, which only opens on builds with\n"
+          "                           libsodium 1.0.19 or later (also lets fastest pick it)\n"
+          "      --kdf OPS:MEM        enc/pack/rekey: Argon2 passes and memory of the new\n"
+          "                           password keyslot, e.g. 4:512M (default: 3:256M or\n"
+          "                           CRYPTOFROG_KDF; stored in the header)\n"
+          "      --stats FILE         write per-stage timings (KDF, read, encryption, write),\n"
+          "                           bytes and peak memory as JSON to FILE (- = stderr)\n"
+          "      --password-file FILE read the password from the first line of FILE\n"
+          "      --password-env VAR   read the password from VAR (default: CRYPTOFROG_PASSWORD)\n"
+          "  -f, --force              overwrite existing outputs\n"
+          "      --remove             delete the input after a successful operation (enc\n"
+          "                           shreds the plaintext first, see the shred options)\n"
+          "  -q, --quiet              only report failures\n"
+          "      --offset N           dec: start at plaintext byte N (reads only the segments needed)\n"
+          "      --length N           dec: stop after N bytes (default: to the end)\n"
+          "      --append             pack: add to an existing archive (same names are replaced)\n"
+          "\n"
+          "Public-key options:\n"
+          "  -R, --recipient FILE     enc/pack: encrypt to the public key in FILE (repeatable);\n"
+          "                           a password is added only from --password-file/-env\n"
+          "  -i, --identity FILE      dec/verify/list/extract/compact: open with the secret key in FILE\n"
+          "\n"
+          "Shred options:\n"
+          "      --passes N           random overwrite passes (default: 1)\n"
+          "      --zero               add a final pass of zeros\n"
+          "      --no-sync            skip the fdatasync barrier after each pass\n"
+          "\n"
+          "Rekey options:\n"
+          "      --new-password-file FILE  new password from the first line of FILE\n"
+          "      --new-password-env VAR    new password from VAR (default: CRYPTOFROG_NEW_PASSWORD)\n"
+          "      --add                     keep the current password and add the new one\n"
+          "      --drop                    remove the current password's keyslot\n"
+          "\n"
+          "An input of - reads from stdin and writes to stdout (or -o).\n"
+          "Without --password-file or the environment variable, the password is\n"
+          "prompted on the terminal.\n";
+}
+
+bool is_cli_command(int argc, char* argv[]) {
+    if (argc < 2) return false;
+    std::string cmd = argv[1];
+    return cmd == "enc" || cmd == "dec" || cmd == "verify" || cmd == "rekey" || cmd == "keygen" ||
+           cmd == "pack" || cmd == "list" || cmd == "extract" || cmd == "compact" || cmd == "shred" ||
+           cmd == "calibrate" || cmd == "help" || cmd == "--help";
+}
+
+// Contagens (-j, -t, --passes): limitadas a 4096.
+static bool parse_unsigned(const char* text, unsigned& value) {
+    char* end;
+    unsigned long v = std::strtoul(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || v > 4096) return false;
+    value = static_cast<unsigned>(v);
+    return true;
+}
+
+static bool parse_u64(const char* text, uint64_t& value) {
+    char* end;
+    errno = 0;
+    unsigned long long v = std::strtoull(text, &end, 10);
+    if (*text == '\0' || *text == '-' || *end != '\0' || errno == ERANGE) return false;
+    value = v;
+    return true;
+}
+
+// Tempo alvo de `calibrate`: a calibração roda derivações desse tamanho, então até 10 minutos.
+static const unsigned MAX_TARGET_MS = 10 * 60 * 1000;
+
+// Tamanho com sufixo opcional K, M ou G (potências de 1024).
+static bool parse_size(const char* text, uint64_t& value) {
+    std::string s = text;
+    uint64_t unit = 1;
+    if (!s.empty()) {
+        switch (s.back()) {
+        case 'K': case 'k': unit = 1ULL << 10; break;
+        case 'M': case 'm': unit = 1ULL << 20; break;
+        case 'G': case 'g': unit = 1ULL << 30; break;
+        default: break;
+        }
+        if (unit != 1) s.pop_back();
+    }
+    uint64_t n;
+    if (!parse_u64(s.c_str(), n) || n == 0 || n > UINT64_MAX / unit) return false;
+    value = n * unit;
+    return true;
+}
+
+// Parâmetros do Argon2 como OPS:MEM (p.ex. 3:256M), o formato impresso por `calibrate`.
+static bool parse_kdf(const char* text, KdfParams& params) {
+    std::string s = text;
+    size_t colon = s.find(':');
+    unsigned ops;
+    uint64_t mem;
+    if (colon == std::string::npos || !parse_unsigned(s.substr(0, colon).c_str(), ops) ||
+        !parse_size(s.c_str() + colon + 1, mem))
+        return false;
+    KdfParams parsed;
+    parsed.opslimit = ops;
+    parsed.memlimit = mem;
+    if (!kdf_params_valid(parsed)) return false;
+    params = parsed;
+    return true;
+}
+
+static std::string format_kdf(const KdfParams& params) {
+    std::string mem;
+    if (params.memlimit % (1ULL << 30) == 0) mem = std::to_string(params.memlimit >> 30) + "G";
+    else if (params.memlimit % (1ULL << 20) == 0) mem = std::to_string(params.memlimit >> 20) + "M";
+    else mem = std::to_string(params.memlimit >> 10) + "K";
+    return std::to_string(params.opslimit) + ":" + mem;
+}
+
+static bool parse_args(int argc, char* argv[], CliConfig& cfg) {
+    cfg.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char*& out) {
+            if (i + 1 >= argc) {
+                std::cerr << "cryptofrog: missing value for " << arg << "\n";
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        const char* v;
+
+        if (arg == "-r" || arg == "--recursive") cfg.recursive = true;
+        else if (arg == "-f" || arg == "--force") cfg.force = true;
+        else if (arg == "-q" || arg == "--quiet") cfg.quiet = true;
+        else if (arg == "--remove") cfg.remove_input = true;
+        else if (arg == "--append") cfg.append = true;
+        else if (arg == "--zero") cfg.shred.zero_pass = true;
+        else if (arg == "--no-sync") cfg.shred.sync = false;
+        else if (arg == "--huge-pages") cfg.huge_pages = true;
+        else if (arg == "-z" || arg == "--compress") cfg.crypto.compression = Compression::Lz4;
+        else if (arg == "--add") cfg.rekey_mode = RekeyMode::Add;
+        else if (arg == "--drop") cfg.rekey_mode = RekeyMode::Remove;
+        else if (arg == "-T" || arg == "--files-from") {
+            if (!value(v)) return false;
+            cfg.lists.push_back(v);
+        } else if (arg == "-o" || arg == "--output") {
+            if (!value(v)) return false;
+            cfg.output = v;
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (!value(v) || !parse_unsigned(v, cfg.jobs)) return false;
+        } else if (arg == "-m" || arg == "--memory") {
+            if (!value(v) || !parse_size(v, cfg.memory)) return false;
+        } else if (arg == "--kdf") {
+            if (!value(v)) return false;
+            if (!parse_kdf(v, cfg.crypto.kdf)) {
+                std::cerr << "cryptofrog: invalid --kdf '" << v << "' (OPS:MEM, 1-" << KDF_MAX_OPSLIMIT
+                          << " passes, 8K-4G in whole KiB)\n";
+                return false;
+            }
+            cfg.kdf_set = true;
+        } else if (arg == "--target") {
+            if (!value(v)) return false;
+            uint64_t ms;
+            if (!parse_u64(v, ms) || ms == 0 || ms > MAX_TARGET_MS) {
+                std::cerr << "cryptofrog: --target must be between 1 and " << MAX_TARGET_MS << " ms\n";
+                return false;
+            }
+            cfg.target_ms = static_cast<unsigned>(ms);
+        } else if (arg == "--passes") {
+            if (!value(v) || !parse_unsigned(v, cfg.shred.passes) || cfg.shred.passes == 0) return false;
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!value(v) || !parse_unsigned(v, cfg.crypto.threads)) return false;
+        } else if (arg == "--io") {
+            if (!value(v)) return false;
+            if (!parse_io_backend(v, cfg.crypto.io)) {
+                std::cerr << "cryptofrog: unknown I/O backend '" << v << "'\n";
+                return false;
+            }
+        } else if (arg == "-R" || arg == "--recipient") {
+            if (!value(v)) return false;
+            cfg.recipient_files.push_back(v);
+        } else if (arg == "-i" || arg == "--identity") {
+            if (!value(v)) return false;
+            cfg.identity_file = v;
+        } else if (arg == "--offset") {
+            if (!value(v) || !parse_u64(v, cfg.range_offset)) return false;
+            cfg.range = true;
+        } else if (arg == "--length") {
+            if (!value(v) || !parse_u64(v, cfg.range_length)) return false;
+            cfg.range = true;
+        } else if (arg == "--cipher") {
+            if (!value(v)) return false;
+            if (!parse_cipher_choice(v, cfg.crypto.cipher)) {
+                std::cerr << "cryptofrog: unknown cipher suite '" << v << "'\n";
+                return false;
+            }
+        } else if (arg == "--allow-unportable-cipher") {
+            cfg.crypto.allow_unportable_cipher = true;
+        } else if (arg == "--stats") {
+            if (!value(v)) return false;
+            cfg.stats_file = v;
+        } else if (arg == "--password-file") {
+            if (!value(v)) return false;
+            cfg.password_file = v;
+        } else if (arg == "--password-env") {
+            if (!value(v)) return false;
+            cfg.password_env = v;
+        } else if (arg == "--new-password-file") {
+            if (!value(v)) return false;
+            cfg.new_password_file = v;
+        } else if (arg == "--new-password-env") {
+            if (!value(v)) return false;
+            cfg.new_password_env = v;
+        } else if (arg == "--") {
+            for (++i; i < argc; ++i) cfg.inputs.push_back(argv[i]);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "cryptofrog: unknown option " << arg << "\n";
+            return false;
+        } else {
+            cfg.inputs.push_back(arg);
+        }
+    }
+    return true;
+}
+
+static bool prompt_password(const char* label, std::string& password) {
+    std::FILE* tty = std::fopen("/dev/tty", "r+");
+    if (!tty) return false;
+
+    std::fputs(label, tty);
+    std::fflush(tty);
+
+    struct termios old_attr;
+    bool restore = tcgetattr(fileno(tty), &old_attr) == 0;
+    if (restore) {
+        struct termios no_echo = old_attr;
+        no_echo.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+        tcsetattr(fileno(tty), TCSAFLUSH, &no_echo);
+    }
+
+    char buf[1024];
+    bool ok = std::fgets(buf, sizeof(buf), tty) != nullptr;
+    if (restore) tcsetattr(fileno(tty), TCSAFLUSH, &old_attr);
+    std::fputs("\n", tty);
+    std::fclose(tty);
+
+    if (ok) {
+        password = buf;
+        while (!password.empty() && (password.back() == '\n' || password.back() == '\r')) password.pop_back();
+    }
+    sodium_memzero(buf, sizeof(buf));
+    return ok && !password.empty();
+}
+
+// Sem label, não pergunta no terminal: a senha é opcional e fica vazia se não vier de
+// arquivo nem do ambiente.
+static bool read_password(const std::string& file, const std::string& env_name, const char* label,
+                          std::string& password) {
+    if (!file.empty()) {
+        std::ifstream in(file);
+        if (!in || !std::getline(in, password)) return false;
+        if (!password.empty() && password.back() == '\r') password.pop_back();
+        return !password.empty();
+    }
+    if (const char* env = std::getenv(env_name.c_str())) {
+        password = env;
+        return !password.empty();
+    }
+    return label ? prompt_password(label, password) : true;
+}
+
+static bool has_ecc_suffix(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".ecc") == 0;
+}
+
+// Diretórios: `enc` ignora arquivos .ecc, `pack` guarda tudo; os demais comandos só
+// consideram arquivos .ecc.
+static bool wanted_in_directory(const std::string& command, const std::string& path) {
+    if (command == "pack") return true;
+    return command == "enc" ? !has_ecc_suffix(path) : has_ecc_suffix(path);
+}
+
+static bool collect_inputs(const CliConfig& cfg, std::vector<std::string>& files) {
+    std::vector<std::string> roots = cfg.inputs;
+    for (const std::string& list : cfg.lists) {
+        std::ifstream file;
+        std::istream* in = &std::cin;
+        if (list != "-") {
+            file.open(list);
+            if (!file) {
+                std::cerr << "cryptofrog: cannot read list " << list << "\n";
+                return false;
+            }
+            in = &file;
+        }
+        std::string line;
+        while (std::getline(*in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) roots.push_back(line);
+        }
+    }
+
+    for (const std::string& root : roots) {
+        std::error_code ec;
+        if (root != "-" && fs::is_directory(root, ec)) {
+            if (!cfg.recursive) {
+                std::cerr << "cryptofrog: " << root << " is a directory (use -r)\n";
+                return false;
+            }
+            for (fs::recursive_directory_iterator it(root, ec), end; it != end; it.increment(ec)) {
+                if (ec) break;
+                if (it->is_regular_file(ec) && wanted_in_directory(cfg.command, it->path().string()))
+                    files.push_back(it->path().string());
+            }
+            if (ec) {
+                std::cerr << "cryptofrog: cannot walk " << root << ": " << ec.message() << "\n";
+                return false;
+            }
+        } else {
+            files.push_back(root);
+        }
+    }
+    return true;
+}
+
+static std::string output_path_for(const CliConfig& cfg, const std::string& input) {
+    if (!cfg.output.empty()) return cfg.output;
+    if (cfg.command == "enc") return input + ".ecc";
+    if (has_ecc_suffix(input)) return input.substr(0, input.size() - 4);
+    return input + ".dec";
+}
+
+static int run_keygen(const CliConfig& cfg) {
+    if (cfg.output.empty() || cfg.output == "-" || !cfg.inputs.empty()) {
+        std::cerr << "cryptofrog: keygen needs -o BASE and no inputs\n";
+        return 2;
+    }
+    Identity identity;
+    std::string error;
+    if (!identity.generate() || !identity.save(cfg.output, cfg.force, error)) {
+        std::cerr << "cryptofrog: " << (error.empty() ? "key generation failed" : error)
+                  << (cfg.force ? "" : " (use -f to overwrite)") << "\n";
+        return 1;
+    }
+    if (!cfg.quiet) std::cerr << "OK   " << cfg.output << ".key, " << cfg.output << ".pub\n";
+    return 0;
+}
+
+// Nome de um membro: caminho relativo normalizado, com '/'. Nomes absolutos ou com ".."
+// são recusados tanto ao guardar quanto ao extrair.
+static bool member_name(const std::string& path, std::string& name) {
+    fs::path p = fs::path(path).lexically_normal().relative_path();
+    for (const fs::path& part : p) {
+        if (part == "..") return false;
+    }
+    name = p.generic_string();
+    while (!name.empty() && name.back() == '/') name.pop_back();
+    return !name.empty() && name != ".";
+}
+
+// Membros substituídos e índices antigos deixam espaço morto no contêiner; só compact o
+// devolve. Um índice antigo ocupa algumas dezenas de bytes por inclusão, então a sugestão só
+// aparece a partir de COMPACT_HINT_BYTES.
+static const uint64_t COMPACT_HINT_BYTES = 64 << 10;
+
+static void report_reclaimable(const Container& archive, const std::string& path) {
+    uint64_t dead = archive.reclaimable_bytes();
+    if (dead >= COMPACT_HINT_BYTES) {
+        std::cerr << path << ": " << dead << " bytes of dead space from replaced members (run "
+                  << "'cryptofrog compact " << path << "' to reclaim)\n";
+    }
+}
+
+static int run_pack(const CliConfig& cfg, const std::string& password, const CryptoOptions& options) {
+    std::vector<std::string> files;
+    if (!collect_inputs(cfg, files)) return 2;
+
+    std::vector<ContainerInput> inputs;
+    for (const std::string& file : files) {
+        ContainerInput input;
+        if (file == "-" || !member_name(file, input.name)) {
+            std::cerr << "FAIL " << file << ": cannot be stored in an archive\n";
+            return 2;
+        }
+        input.path = file;
+        inputs.push_back(input);
+    }
+
+    Container archive;
+    bool opened = cfg.append && fs::exists(cfg.output) ? archive.open(cfg.output, password, options, true)
+                                                       : archive.create(cfg.output, password, options, cfg.force);
+    if (!opened) {
+        std::cerr << "cryptofrog: cannot " << (cfg.append ? "open " : "create ") << cfg.output
+                  << (cfg.append || cfg.force ? "" : " (exists? use -f or --append)") << "\n";
+        return 1;
+    }
+
+    std::vector<size_t> failed;
+    if (!archive.add(inputs, failed)) {
+        std::cerr << "cryptofrog: writing " << cfg.output << " failed; the archive is unchanged\n";
+        return 1;
+    }
+    for (size_t i : failed) std::cerr << "FAIL " << inputs[i].path << ": cannot read\n";
+    if (options.stats) {
+        options.stats->add_file(true, inputs.size() - failed.size());
+        options.stats->add_file(false, failed.size());
+    }
+    if (!cfg.quiet) {
+        std::cerr << inputs.size() - failed.size() << "/" << inputs.size() << " files stored in " << cfg.output
+                  << " (" << archive.entries().size() << " in the archive)\n";
+        report_reclaimable(archive, cfg.output);
+    }
+    return failed.empty() ? 0 : 1;
+}
+
+static int run_list(const CliConfig& cfg, const Container& archive) {
+    for (const ContainerEntry& e : archive.entries()) {
+        char when[32] = "-";
+        std::time_t t = static_cast<std::time_t>(e.mtime);
+        struct tm tm;
+        if (localtime_r(&t, &tm)) std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M", &tm);
+        char mode[8];
+        std::snprintf(mode, sizeof(mode), "%04o", e.mode & 07777);
+        std::cout << mode << " " << e.size << "\t" << when << "  " << e.name << "\n";
+    }
+    if (!cfg.quiet) report_reclaimable(archive, cfg.inputs[0]);
+    return std::cout.flush() ? 0 : 1;
+}
+
+static bool extract_one(const CliConfig& cfg, const Container& archive, const ContainerEntry& entry,
+                        const CryptoOptions& options, std::string& error) {
+    std::string name;
+    if (!member_name(entry.name, name) || name != entry.name) {
+        error = "unsafe name";
+        return false;
+    }
+    fs::path target = fs::path(cfg.output.empty() ? "." : cfg.output) / name;
+    std::error_code ec;
+    if (!cfg.force && fs::exists(target, ec)) {
+        error = "output exists (use -f to overwrite)";
+        return false;
+    }
+    fs::create_directories(target.parent_path(), ec);
+
+    // O membro vai para um arquivo temporário ao lado do destino e só substitui o destino
+    // depois de autenticado: com -f, uma falha não apaga nem trunca o arquivo que já existia.
+    unsigned char suffix[4];
+    char hex[2 * sizeof(suffix) + 1];
+    randombytes_buf(suffix, sizeof(suffix));
+    sodium_bin2hex(hex, sizeof(hex), suffix, sizeof(suffix));
+    fs::path partial = target.parent_path() / ("." + target.filename().string() + ".part-" + hex);
+
+    std::unique_ptr<OutputSink> out = open_output(partial.string(), options.io);
+    if (!out) {
+        error = "cannot create output";
+        return false;
+    }
+    bool ok = archive.extract(entry, *out);
+    out.reset();
+    if (!ok) {
+        fs::remove(partial, ec);
+        error = "authentication failed";
+        return false;
+    }
+
+    // Permissões e data de modificação como estavam ao guardar.
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(entry.mtime);
+    times[1].tv_nsec = 0;
+    ::chmod(partial.c_str(), static_cast<mode_t>(entry.mode & 07777));
+    ::utimensat(AT_FDCWD, partial.c_str(), times, 0);
+
+    fs::rename(partial, target, ec);
+    if (ec) {
+        fs::remove(partial, ec);
+        error = "cannot replace output";
+        return false;
+    }
+    return true;
+}
+
+static int run_extract(const CliConfig& cfg, const Container& archive, const CryptoOptions& options) {
+    std::vector<const ContainerEntry*> wanted;
+    if (cfg.inputs.size() == 1) {
+        for (const ContainerEntry& e : archive.entries()) wanted.push_back(&e);
+    }
+    for (size_t i = 1; i < cfg.inputs.size(); ++i) {
+        std::string name;
+        const ContainerEntry* e = member_name(cfg.inputs[i], name) ? archive.find(name) : nullptr;
+        if (!e) {
+            std::cerr << "cryptofrog: " << cfg.inputs[i] << " is not in " << cfg.inputs[0] << "\n";
+            return 1;
+        }
+        wanted.push_back(e);
+    }
+
+    size_t failures = 0;
+    for (const ContainerEntry* e : wanted) {
+        std::string error;
+        bool ok = extract_one(cfg, archive, *e, options, error);
+        if (options.stats) options.stats->add_file(ok);
+        if (!ok) {
+            failures++;
+            std::cerr << "FAIL " << e->name << ": " << error << "\n";
+        } else if (!cfg.quiet) {
+            std::cerr << "OK   " << e->name << "\n";
+        }
+    }
+    if (!cfg.quiet && wanted.size() > 1) {
+        std::cerr << wanted.size() - failures << "/" << wanted.size() << " files extracted\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+static int run_compact(const CliConfig& cfg, Container& archive) {
+    uint64_t dead = archive.reclaimable_bytes();
+    if (!archive.compact()) {
+        std::cerr << "FAIL " << cfg.inputs[0] << ": compaction failed; the archive is unchanged\n";
+        return 1;
+    }
+    if (!cfg.quiet) std::cerr << "OK   " << cfg.inputs[0] << ": " << dead << " bytes reclaimed\n";
+    return 0;
+}
+
+// pack/list/extract/compact: um contêiner, uma derivação de chave.
+static int run_container(const CliConfig& cfg, const std::string& password, const CryptoOptions& options) {
+    if (cfg.command == "pack") return run_pack(cfg, password, options);
+
+    Container archive;
+    if (!archive.open(cfg.inputs[0], password, options, cfg.command == "compact")) {
+        std::cerr << "FAIL " << cfg.inputs[0] << ": not an archive or authentication failed\n";
+        return 1;
+    }
+    if (cfg.command == "compact") return run_compact(cfg, archive);
+    return cfg.command == "list" ? run_list(cfg, archive) : run_extract(cfg, archive, options);
+}
+
+// dec --offset/--length: só os segmentos do intervalo são lidos e abertos, e vão direto
+// para a saída.
+static bool process_range(const CliConfig& cfg, const std::string& input, const std::string& password,
+                          const CryptoOptions& options, std::string& error) {
+    bool to_stdout = cfg.output.empty() || cfg.output == "-";
+    if (!to_stdout && !cfg.force && fs::exists(cfg.output)) {
+        error = "output exists (use -f)";
+        return false;
+    }
+
+    std::unique_ptr<OutputSink> out = to_stdout ? wrap_output(std::cout) : open_output(cfg.output, options.io);
+    if (!out) {
+        error = "cannot create output";
+        return false;
+    }
+    if (!decrypt_range(input, cfg.range_offset, cfg.range_length, *out, password, options)) {
+        // Não deixa texto claro parcial de um intervalo que não autenticou.
+        out.reset();
+        if (!to_stdout) {
+            std::error_code ec;
+            fs::remove(cfg.output, ec);
+        }
+        error = "range read failed (authentication, legacy file, not a regular file or write error)";
+        return false;
+    }
+    return true;
+}
+
+// Processa um arquivo; stdin/stdout quando o caminho é "-".
+static bool process_one(const CliConfig& cfg, const std::string& input, const std::string& password,
+                        const std::string& new_password, KeySession* new_session,
+                        const CryptoOptions& options, std::string& error) {
+    if (cfg.command == "rekey") {
+        if (rekey_file(input, cfg.rekey_mode, password, new_password, options.session, new_session, options.kdf))
+            return true;
+        error = "rekey failed (wrong password, legacy file, last keyslot or no header space)";
+        return false;
+    }
+
+    if (cfg.range) return process_range(cfg, input, password, options, error);
+
+    bool to_stdout = cfg.command != "verify" && (input == "-" ? cfg.output.empty() || cfg.output == "-"
+                                                              : cfg.output == "-");
+    std::string output = cfg.command == "verify" || to_stdout ? std::string() : output_path_for(cfg, input);
+
+    if (!output.empty() && !cfg.force && fs::exists(output)) {
+        error = "output exists (use -f)";
+        return false;
+    }
+
+    if (input != "-" && cfg.command != "enc") recover_header_journal(input);   // rekey interrompido
+    std::unique_ptr<InputSource> in = input == "-" ? wrap_input(std::cin) : open_input(input, options.io);
+    if (!in) {
+        error = "cannot open input";
+        return false;
+    }
+
+    NullSink null_sink;
+    std::unique_ptr<OutputSink> owned_out;
+    OutputSink* out = &null_sink;
+    if (to_stdout) {
+        owned_out = wrap_output(std::cout);
+        out = owned_out.get();
+    } else if (!output.empty()) {
+        owned_out = open_output(output, options.io);
+        if (!owned_out) {
+            error = "cannot create output";
+            return false;
+        }
+        out = owned_out.get();
+    }
+
+    bool ok = cfg.command == "enc" ? encrypt_stream(*in, *out, password, options)
+                                   : decrypt_stream(*in, *out, password, options);
+    if (!ok) {
+        owned_out.reset();
+        if (!output.empty()) {
+            std::error_code ec;
+            fs::remove(output, ec);
+        }
+        error = cfg.command == "enc" ? "encryption failed" : "authentication failed";
+        return false;
+    }
+
+    if (cfg.remove_input && input != "-" && cfg.command != "verify") {
+        // O texto claro é sobrescrito antes de sair; o .ecc decifrado só é removido.
+        if (cfg.command == "enc") {
+            if (!shred_file(input, cfg.shred)) {
+                error = "encrypted, but the input could not be shredded";
+                return false;
+            }
+        } else {
+            std::error_code ec;
+            fs::remove(input, ec);
+        }
+    }
+    return true;
+}
+
+static int run_shred(const CliConfig& cfg) {
+    std::vector<std::string> paths = cfg.inputs;
+    if (paths.empty() || !cfg.lists.empty()) {
+        print_usage(std::cerr);
+        return 2;
+    }
+    for (const std::string& path : paths) {
+        std::error_code ec;
+        if (path == "-" || (!cfg.recursive && fs::is_directory(fs::symlink_status(path, ec)))) {
+            std::cerr << "cryptofrog: " << path << (path == "-" ? " cannot be shredded\n" : " is a directory (use -r)\n");
+            return 2;
+        }
+    }
+
+    ShredOptions options = cfg.shred;
+    options.jobs = cfg.jobs;
+    ShredStats stats;
+    std::vector<std::string> failed;
+    bool ok = shred_paths(paths, options, stats, failed);
+    for (const std::string& path : failed) std::cerr << "FAIL " << path << "\n";
+    if (!cfg.quiet) {
+        std::fprintf(stderr, "%llu files, %.1f MiB overwritten in %.2f s (%.0f MiB/s)\n",
+                     static_cast<unsigned long long>(stats.files), stats.written / 1048576.0, stats.seconds,
+                     stats.mib_per_s());
+    }
+    return ok ? 0 : 1;
+}
+
+// Mede o Argon2 com no máximo -m de memória (padrão 1 GiB: o arquivo precisa abrir também
+// em máquinas menores) e imprime os parâmetros para --kdf ou CRYPTOFROG_KDF.
+static int run_calibrate(const CliConfig& cfg) {
+    if (!cfg.inputs.empty() || !cfg.lists.empty()) {
+        print_usage(std::cerr);
+        return 2;
+    }
+    uint64_t max_memory = cfg.memory ? cfg.memory : std::min<uint64_t>(1ULL << 30, kdf_budget().usage().limit_bytes);
+    unsigned ms = 0;
+    KdfParams params = calibrate_kdf(cfg.target_ms, max_memory, &ms);
+    if (cfg.quiet) {
+        std::cout << format_kdf(params) << "\n";
+    } else {
+        std::cout << "Argon2id: " << params.opslimit << (params.opslimit == 1 ? " pass" : " passes") << " over "
+                  << (params.memlimit >> 20) << " MiB took " << ms << " ms (target " << cfg.target_ms
+                  << " ms)\n"
+                  << "  --kdf " << format_kdf(params) << "\n"
+                  << "  export CRYPTOFROG_KDF=" << format_kdf(params) << "\n";
+    }
+    return std::cout.flush() ? 0 : 1;
+}
+
+// --stats: uma linha JSON com o comando e as medidas da invocação inteira.
+static bool write_stats(const CliConfig& cfg, const OperationStats& stats) {
+    if (cfg.stats_file.empty()) return true;
+    std::string json = "{\"command\":\"" + cfg.command + "\"," + stats.to_json().substr(1) + "\n";
+    if (cfg.stats_file == "-") {
+        std::cerr << json;
+        return static_cast<bool>(std::cerr.flush());
+    }
+    std::ofstream out(cfg.stats_file, std::ios::trunc);
+    out << json;
+    out.close();
+    if (!out) std::cerr << "cryptofrog: cannot write " << cfg.stats_file << "\n";
+    return static_cast<bool>(out);
+}
+
+int run_cli(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    std::string cmd = argv[1];
+    if (cmd == "help" || cmd == "--help") {
+        print_usage(std::cout);
+        return 0;
+    }
+
+    CliConfig cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        print_usage(std::cerr);
+        return 2;
+    }
+    if (cfg.memory) kdf_budget().configure(cfg.memory, ThreadPool::resolve_threads(0));
+    if (cfg.huge_pages) io_buffer_pool().set_huge_pages(true);
+    if (cfg.command == "keygen") return run_keygen(cfg);
+    if (cfg.command == "shred") return run_shred(cfg);
+    if (cfg.command == "calibrate") return run_calibrate(cfg);
+
+    // Parâmetros do Argon2 de novos slots de senha: --kdf, senão CRYPTOFROG_KDF.
+    const char* kdf_env = std::getenv("CRYPTOFROG_KDF");
+    if (!cfg.kdf_set && kdf_env && *kdf_env && !parse_kdf(kdf_env, cfg.crypto.kdf)) {
+        std::cerr << "cryptofrog: invalid CRYPTOFROG_KDF '" << kdf_env << "'\n";
+        return 2;
+    }
+    if (cfg.kdf_set && cfg.command != "enc" && cfg.command != "pack" && cfg.command != "rekey") {
+        std::cerr << "cryptofrog: --kdf only applies to enc, pack and rekey\n";
+        return 2;
+    }
+
+    CipherSuite suite;
+    if ((cfg.command == "enc" || cfg.command == "pack") &&
+        !aead_resolve(cfg.crypto.cipher, suite, cfg.crypto.allow_unportable_cipher)) {
+        if (aead_resolve(cfg.crypto.cipher, suite, true))
+            std::cerr << "cryptofrog: " << cipher_suite_name(suite)
+                      << " files only open on builds with libsodium 1.0.19 or later;"
+                         " add --allow-unportable-cipher to write them anyway\n";
+        else
+            std::cerr << "cryptofrog: cipher suite not available on this host\n";
+        return 2;
+    }
+    if (cfg.crypto.compression != Compression::None &&
+        (cfg.command != "enc" || !compression_available(cfg.crypto.compression))) {
+        std::cerr << "cryptofrog: " << (cfg.command != "enc" ? "--compress only applies to enc"
+                                                             : "built without LZ4 support") << "\n";
+        return 2;
+    }
+
+    OperationStats stats;
+    if (!cfg.stats_file.empty()) cfg.crypto.stats = &stats;
+
+    bool public_key = !cfg.recipient_files.empty() || !cfg.identity_file.empty();
+    bool container = cfg.command == "pack" || cfg.command == "list" || cfg.command == "extract" ||
+                     cfg.command == "compact";
+    if (!cfg.recipient_files.empty() && cfg.command != "enc" && cfg.command != "pack") {
+        std::cerr << "cryptofrog: --recipient only applies to enc and pack\n";
+        return 2;
+    }
+    if (!cfg.identity_file.empty() && (cfg.command == "enc" || cfg.command == "rekey" || cfg.command == "pack")) {
+        std::cerr << "cryptofrog: --identity only applies to dec, verify, list, extract and compact\n";
+        return 2;
+    }
+    if (cfg.command == "pack" && (cfg.output.empty() || cfg.output == "-")) {
+        std::cerr << "cryptofrog: pack needs -o ARCHIVE\n";
+        return 2;
+    }
+    bool single_archive = cfg.command == "list" || cfg.command == "compact";
+    if ((single_archive || cfg.command == "extract") &&
+        (cfg.inputs.empty() || (single_archive && (cfg.inputs.size() != 1 || !cfg.output.empty())))) {
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    // Chaves públicas: o acordo com o efêmero do lote é feito uma vez por destinatário.
+    std::vector<Recipient> recipients(cfg.recipient_files.size());
+    for (size_t i = 0; i < recipients.size(); ++i) {
+        std::string error;
+        if (!load_recipient(cfg.recipient_files[i], recipients[i], error)) {
+            std::cerr << "cryptofrog: " << error << "\n";
+            return 2;
+        }
+    }
+    std::unique_ptr<RecipientSet> recipient_set;
+    if (!recipients.empty()) {
+        recipient_set.reset(new RecipientSet(recipients));
+        if (!recipient_set->valid()) {
+            std::cerr << "cryptofrog: key agreement with a recipient failed\n";
+            return 2;
+        }
+        cfg.crypto.recipients = recipient_set.get();
+    }
+    Identity identity;
+    if (!cfg.identity_file.empty()) {
+        std::string error;
+        if (!identity.load(cfg.identity_file, error)) {
+            std::cerr << "cryptofrog: " << error << "\n";
+            return 2;
+        }
+        cfg.crypto.identity = &identity;
+    }
+
+    if (container) {
+        std::string password;
+        if (!read_password(cfg.password_file, cfg.password_env, public_key ? nullptr : "Password: ", password)) {
+            std::cerr << "cryptofrog: no password provided\n";
+            return 2;
+        }
+        stats.restart();
+        int status = run_container(cfg, password, cfg.crypto);
+        sodium_memzero(&password[0], password.size());
+        if (!write_stats(cfg, stats)) status = status ? status : 1;
+        return status;
+    }
+
+    std::vector<std::string> files;
+    if (!collect_inputs(cfg, files)) return 2;
+    if (files.empty()) {
+        print_usage(std::cerr);
+        return 2;
+    }
+    if (cfg.range && (cfg.command != "dec" || files.size() != 1 || files[0] == "-" || cfg.remove_input)) {
+        std::cerr << "cryptofrog: --offset/--length need dec with a single .ecc file\n";
+        return 2;
+    }
+    if (!cfg.output.empty() && files.size() > 1) {
+        std::cerr << "cryptofrog: -o requires a single input\n";
+        return 2;
+    }
+
+    std::string password, new_password;
+    if (!read_password(cfg.password_file, cfg.password_env, public_key ? nullptr : "Password: ", password)) {
+        std::cerr << "cryptofrog: no password provided\n";
+        return 2;
+    }
+    if (cfg.command == "rekey" && cfg.rekey_mode != RekeyMode::Remove &&
+        !read_password(cfg.new_password_file, cfg.new_password_env, "New password: ", new_password)) {
+        std::cerr << "cryptofrog: no new password provided\n";
+        return 2;
+    }
+
+    // O tempo total não inclui a digitação da senha.
+    stats.restart();
+
+    // Muitos arquivos: paraleliza entre arquivos e divide os núcleos entre eles.
+    unsigned cores = ThreadPool::resolve_threads(0);
+    unsigned jobs = cfg.jobs ? cfg.jobs : cores;
+    if (jobs > files.size()) jobs = static_cast<unsigned>(files.size());
+    CryptoOptions options = cfg.crypto;
+    if (options.threads == 0) options.threads = std::max(1u, cores / jobs);
+
+    // Um Argon2 por invocação: os arquivos do lote compartilham o salt e usam subchaves.
+    KeySession session(password);
+    KeySession new_session(new_password);
+    options.session = &session;
+
+    std::mutex report_mutex;
+    std::atomic<size_t> failures(0);
+    ThreadPool pool(jobs);
+    pool.parallel_for(files.size(), [&](size_t i) {
+        std::string error;
+        bool ok = process_one(cfg, files[i], password, new_password, &new_session, options, error);
+        if (!ok) failures++;
+        if (options.stats) options.stats->add_file(ok);
+
+        std::lock_guard<std::mutex> lock(report_mutex);
+        if (!ok) std::cerr << "FAIL " << files[i] << ": " << error << "\n";
+        else if (!cfg.quiet) std::cerr << "OK   " << files[i] << "\n";
+    });
+
+    sodium_memzero(&password[0], password.size());
+    if (!new_password.empty()) sodium_memzero(&new_password[0], new_password.size());
+    if (!cfg.quiet && files.size() > 1) {
+        std::cerr << files.size() - failures << "/" << files.size() << " files processed\n";
+    }
+    if (!write_stats(cfg, stats)) return 1;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#ifndef CLI_H
+#define CLI_H
+
+// Interface de linha de comando (sem GTK), para uso em servidores e cron:
+//   cryptofrog enc|dec|verify [opções] <arquivos|diretórios|->
+// Retorna true se argv[1] é um subcomando conhecido.
+bool is_cli_command(int argc, char* argv[]);
+
+// Executa o subcomando; o valor de retorno é o exit status do processo.
+int run_cli(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,105 @@
+#include "compress.h"
+#include <cmath>
+#include <cstring>
+#ifdef CRYPTOFROG_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+// Amostra: até SAMPLE_SLICES fatias de SAMPLE_SLICE bytes, espalhadas pelo segmento.
+static const size_t SAMPLE_SLICE = 1024;
+static const size_t SAMPLE_SLICES = 4;
+
+// Acima disso (bits por byte), a amostra é tratada como incompressível. Dados comprimidos
+// ou cifrados ficam perto de 8; texto e dumps ficam bem abaixo.
+static const double ENTROPY_LIMIT = 7.5;
+
+// Segmentos menores não compensam a tentativa.
+static const size_t MIN_COMPRESS_BYTES = 128;
+
+bool compression_available(Compression compression) {
+    switch (compression) {
+    case Compression::None:
+        return true;
+    case Compression::Lz4:
+#ifdef CRYPTOFROG_HAVE_LZ4
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool parse_compression(const std::string& name, Compression& compression) {
+    if (name == "none") compression = Compression::None;
+    else if (name == "lz4") compression = Compression::Lz4;
+    else return false;
+    return true;
+}
+
+bool looks_incompressible(const unsigned char* data, size_t len) {
+    if (len == 0) return false;
+    size_t counts[256] = {0};
+    size_t sampled = 0;
+    if (len <= SAMPLE_SLICE * SAMPLE_SLICES) {
+        for (size_t i = 0; i < len; ++i) counts[data[i]]++;
+        sampled = len;
+    } else {
+        size_t stride = (len - SAMPLE_SLICE) / (SAMPLE_SLICES - 1);
+        for (size_t s = 0; s < SAMPLE_SLICES; ++s) {
+            const unsigned char* p = data + s * stride;
+            for (size_t i = 0; i < SAMPLE_SLICE; ++i) counts[p[i]]++;
+        }
+        sampled = SAMPLE_SLICE * SAMPLE_SLICES;
+    }
+
+    double entropy = 0;
+    for (size_t c : counts) {
+        if (c == 0) continue;
+        double p = static_cast<double>(c) / sampled;
+        entropy -= p * std::log2(p);
+    }
+    return entropy > ENTROPY_LIMIT;
+}
+
+size_t pack_segment(Compression compression, const unsigned char* in, size_t len, unsigned char* out) {
+#ifdef CRYPTOFROG_HAVE_LZ4
+    if (compression == Compression::Lz4 && len >= MIN_COMPRESS_BYTES && !looks_incompressible(in, len)) {
+        // Exige ao menos 1/16 de ganho: abaixo disso, descomprimir não se paga.
+        int capacity = static_cast<int>(len - len / 16);
+        int n = LZ4_compress_default(reinterpret_cast<const char*>(in), reinterpret_cast<char*>(out + 1),
+                                     static_cast<int>(len), capacity);
+        if (n > 0) {
+            out[0] = SEGMENT_LZ4;
+            return 1 + static_cast<size_t>(n);
+        }
+    }
+#else
+    (void)compression;
+#endif
+    out[0] = SEGMENT_RAW;
+    std::memcpy(out + 1, in, len);
+    return 1 + len;
+}
+
+bool unpack_segment(const unsigned char* in, size_t len, unsigned char* out, size_t capacity, size_t* out_len) {
+    if (len < 1) return false;
+    switch (in[0]) {
+    case SEGMENT_RAW:
+        if (len - 1 > capacity) return false;
+        std::memcpy(out, in + 1, len - 1);
+        *out_len = len - 1;
+        return true;
+#ifdef CRYPTOFROG_HAVE_LZ4
+    case SEGMENT_LZ4: {
+        int n = LZ4_decompress_safe(reinterpret_cast<const char*>(in + 1), reinterpret_cast<char*>(out),
+                                    static_cast<int>(len - 1), static_cast<int>(capacity));
+        if (n < 0) return false;
+        *out_len = static_cast<size_t>(n);
+        return true;
+    }
+#endif
+    default:
+        return false;
+    }
+}
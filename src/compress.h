@@ -0,0 +1,43 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compressão por segmento, antes da AEAD (LZ4, disponível quando compilado com liblz4).
+//
+// Arquivos com FLAG_COMPRESSED gravam cada segmento como u32 LE (tamanho do texto cifrado)
+// seguido do texto cifrado. O texto claro selado começa com um byte de modo (cru ou LZ4),
+// então o modo é autenticado; o tamanho só delimita o segmento, e alterá-lo faz a tag
+// falhar. Cada segmento continua cobrindo segment_size bytes do original (o último, menos),
+// de modo que a posição no texto claro ainda sai da aritmética; só a posição no arquivo
+// passa a depender dos prefixos.
+enum class Compression {
+    None,
+    Lz4,
+};
+
+static const size_t SEGMENT_FRAME_BYTES = 4;   // prefixo de tamanho de cada segmento
+static const uint8_t SEGMENT_RAW = 0;
+static const uint8_t SEGMENT_LZ4 = 1;
+
+bool compression_available(Compression compression);
+bool parse_compression(const std::string& name, Compression& compression);
+
+// Maior texto claro selado de um segmento com len bytes do original (byte de modo incluído).
+// LZ4 só é gravado quando fica menor que os bytes crus, então o limite não depende do algoritmo.
+inline size_t packed_segment_bound(size_t len) { return len + 1; }
+
+// Amostra de entropia (até 4 KiB espalhados pelo segmento): verdadeiro quando os bytes já
+// parecem comprimidos ou cifrados (JPEG, zip, .ecc), e tentar comprimir seria só custo.
+bool looks_incompressible(const unsigned char* data, size_t len);
+
+// Escreve modo | dados em out (packed_segment_bound(len) bytes) e retorna o tamanho. Cai
+// para o modo cru quando a amostra desaconselha ou a compressão não economiza o suficiente.
+size_t pack_segment(Compression compression, const unsigned char* in, size_t len, unsigned char* out);
+
+// Inverso de pack_segment; falha com modo desconhecido, dados corrompidos ou mais de capacity bytes.
+bool unpack_segment(const unsigned char* in, size_t len, unsigned char* out, size_t capacity, size_t* out_len);
+
+#endif
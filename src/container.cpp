@@ -0,0 +1,513 @@
+#include "container.h"
+#include "aead.h"
+#include "keyslot.h"
+#include "header_journal.h"
+#include "stats.h"
+#include "stream.h"
+#include "thread_pool.h"
+#include <sodium.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Contextos de domínio das chaves derivadas da DEK.
+static const char MEMBER_KEY_CONTEXT[] = "cryptofrog.member-key.v1";
+static const char INDEX_KEY_CONTEXT[] = "cryptofrog.container-index.v1";
+
+// Arquivos até este tamanho são lidos inteiros e selados em paralelo, vários por lote
+// (no pior caso 64 MiB em memória); maiores passam por seal_stream, um de cada vez.
+static const uint64_t SMALL_MEMBER_BYTES = 256 << 10;
+static const size_t BATCH_FILES = 256;
+
+static void put_u64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+static uint64_t get_u64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+static void derive_key(const unsigned char dek[DEK_BYTES], const char* context, size_t context_len,
+                       const unsigned char id[FILE_ID_BYTES], unsigned char out[DEK_BYTES]) {
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, dek, DEK_BYTES, DEK_BYTES);
+    crypto_generichash_update(&state, reinterpret_cast<const unsigned char*>(context), context_len);
+    crypto_generichash_update(&state, id, FILE_ID_BYTES);
+    crypto_generichash_final(&state, out, DEK_BYTES);
+    sodium_memzero(&state, sizeof(state));
+}
+
+static void member_key(const unsigned char dek[DEK_BYTES], const unsigned char id[FILE_ID_BYTES],
+                       unsigned char out[DEK_BYTES]) {
+    derive_key(dek, MEMBER_KEY_CONTEXT, sizeof(MEMBER_KEY_CONTEXT) - 1, id, out);
+}
+
+// Segmentos e bytes gravados de um membro: todo membro tem ao menos um segmento (vazio
+// para arquivos vazios), e só o último pode ser menor que segment_size.
+static uint64_t member_segments(const FileHeader& hdr, uint64_t size) {
+    return size == 0 ? 1 : (size + hdr.segment_size - 1) / hdr.segment_size;
+}
+
+static uint64_t member_stored_bytes(const FileHeader& hdr, size_t abytes, uint64_t size) {
+    return size + member_segments(hdr, size) * abytes;
+}
+
+// Saída posicional dentro do contêiner, para membros grandes selados por seal_stream.
+class PositionedOutput : public OutputSink {
+public:
+    PositionedOutput(int descriptor, uint64_t start) : fd(descriptor), offset(start) {}
+
+    bool write(const unsigned char* data, size_t len) override {
+        ok = ok && pwrite_exact(fd, data, len, offset);
+        offset += len;
+        return ok;
+    }
+
+    bool finish() override { return ok; }
+
+private:
+    int fd;
+    uint64_t offset;
+    bool ok = true;
+};
+
+Container::~Container() {
+    close();
+}
+
+void Container::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    file_path.clear();
+    sodium_memzero(key.data(), DEK_BYTES);
+    list.clear();
+    by_name.clear();
+}
+
+const ContainerEntry* Container::find(const std::string& name) const {
+    auto it = by_name.find(name);
+    return it == by_name.end() ? nullptr : &list[it->second];
+}
+
+bool Container::create(const std::string& path, const std::string& password, const CryptoOptions& options,
+                       bool overwrite) {
+    close();
+    opts = options;
+    opts.compression = Compression::None;   // membros têm tamanho fixo por segmento (índice)
+    hdr = FileHeader();
+    if (!init_file_header(hdr, password, opts)) return false;
+    hdr.flags |= FLAG_CONTAINER;
+    hdr.has_container_index = true;   // espaço do ponteiro; preenchido por commit_index
+    if (!seal_file_header(hdr, password, opts, key.data())) return false;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL), 0666);
+    if (fd < 0) return false;
+    file_path = path;
+
+    std::vector<unsigned char> header = serialize_header(hdr);
+    data_end = hdr.header_len;
+    if (header.empty() || !pwrite_exact(fd, header.data(), header.size(), 0) || !commit_index()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool Container::open(const std::string& path, const std::string& password, const CryptoOptions& options,
+                     bool writable) {
+    close();
+    opts = options;
+    hdr = FileHeader();
+    recover_header_journal(path);
+    fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) return false;
+    file_path = path;
+
+    unsigned char core[HEADER_CORE_BYTES];
+    bool ok = pread_exact(fd, core, sizeof(core), 0) && parse_header_core(core, sizeof(core), hdr) &&
+              (hdr.flags & FLAG_CONTAINER) && !(hdr.flags & FLAG_COMPRESSED);
+    if (ok) {
+        std::vector<unsigned char> records(hdr.header_len - HEADER_CORE_BYTES);
+        ok = pread_exact(fd, records.data(), records.size(), HEADER_CORE_BYTES) &&
+             parse_header_records(records.data(), records.size(), hdr) && hdr.has_container_index &&
+             aead_suite(hdr.cipher) && unlock_file_header(hdr, password, options, key.data()) && load_index();
+    }
+    if (!ok) close();
+    return ok;
+}
+
+bool Container::load_index() {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    const unsigned char* ptr = hdr.container_index;
+    uint64_t offset = get_u64(ptr + FILE_ID_BYTES);
+    uint64_t length = get_u64(ptr + FILE_ID_BYTES + 8);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || length < suite->abytes || offset < hdr.header_len ||
+        offset > static_cast<uint64_t>(st.st_size) || length > static_cast<uint64_t>(st.st_size) - offset)
+        return false;
+
+    std::vector<unsigned char> sealed(length), blob(length - suite->abytes);
+    if (!pread_exact(fd, sealed.data(), sealed.size(), offset)) return false;
+
+    // Dado associado: núcleo e ponteiro, então trocar o ponteiro invalida o índice.
+    unsigned char ad[HEADER_CORE_BYTES + CONTAINER_POINTER_BYTES];
+    SecretBlock index_key;
+    unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+    std::memcpy(ad, hdr.core, HEADER_CORE_BYTES);
+    std::memcpy(ad + HEADER_CORE_BYTES, ptr, CONTAINER_POINTER_BYTES);
+    derive_key(key.data(), INDEX_KEY_CONTEXT, sizeof(INDEX_KEY_CONTEXT) - 1, ptr, index_key.data());
+    unsigned long long blen;
+    bool ok = suite->decrypt(blob.data(), &blen, NULL, sealed.data(), sealed.size(), ad, sizeof(ad),
+                             nonce, index_key.data()) == 0;
+    if (!ok || blob.size() < 8) return false;
+
+    const unsigned char* p = blob.data();
+    const unsigned char* end = p + blob.size();
+    uint64_t count = get_u64(p);
+    p += 8;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (end - p < 2) return false;
+        size_t name_len = static_cast<size_t>(p[0] | (p[1] << 8));
+        p += 2;
+        if (static_cast<size_t>(end - p) < name_len + 4 + 8 + 8 + 8 + FILE_ID_BYTES) return false;
+        ContainerEntry e;
+        e.name.assign(reinterpret_cast<const char*>(p), name_len);
+        p += name_len;
+        e.mode = static_cast<uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+        p += 4;
+        e.mtime = static_cast<int64_t>(get_u64(p));
+        e.size = get_u64(p + 8);
+        e.offset = get_u64(p + 16);
+        p += 24;
+        std::memcpy(e.member_id, p, FILE_ID_BYTES);
+        p += FILE_ID_BYTES;
+        by_name[e.name] = list.size();
+        list.push_back(e);
+    }
+    data_end = offset + length;
+    return p == end;
+}
+
+// Serializa e sela o índice de entries, a ser gravado em offset; preenche o ponteiro do header.
+bool Container::seal_index(const std::vector<ContainerEntry>& entries, uint64_t offset,
+                           unsigned char ptr[CONTAINER_POINTER_BYTES], std::vector<unsigned char>& sealed) const {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return false;
+
+    std::vector<unsigned char> blob(8);
+    put_u64(blob.data(), entries.size());
+    for (const ContainerEntry& e : entries) {
+        size_t name_len = std::min<size_t>(e.name.size(), 0xFFFF);
+        unsigned char fixed[4 + 8 + 8 + 8];
+        fixed[0] = static_cast<unsigned char>(e.mode);
+        fixed[1] = static_cast<unsigned char>(e.mode >> 8);
+        fixed[2] = static_cast<unsigned char>(e.mode >> 16);
+        fixed[3] = static_cast<unsigned char>(e.mode >> 24);
+        put_u64(fixed + 4, static_cast<uint64_t>(e.mtime));
+        put_u64(fixed + 12, e.size);
+        put_u64(fixed + 20, e.offset);
+        blob.push_back(static_cast<unsigned char>(name_len));
+        blob.push_back(static_cast<unsigned char>(name_len >> 8));
+        blob.insert(blob.end(), e.name.begin(), e.name.begin() + name_len);
+        blob.insert(blob.end(), fixed, fixed + sizeof(fixed));
+        blob.insert(blob.end(), e.member_id, e.member_id + FILE_ID_BYTES);
+    }
+
+    // Cada índice tem id próprio e, portanto, chave própria: o nonce fixo nunca se repete,
+    // mesmo que um header antigo seja restaurado e o contêiner volte a crescer a partir dele.
+    SecretBlock index_key;
+    randombytes_buf(ptr, FILE_ID_BYTES);
+    put_u64(ptr + FILE_ID_BYTES, offset);
+    put_u64(ptr + FILE_ID_BYTES + 8, blob.size() + suite->abytes);
+
+    unsigned char ad[HEADER_CORE_BYTES + CONTAINER_POINTER_BYTES];
+    unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+    std::memcpy(ad, hdr.core, HEADER_CORE_BYTES);
+    std::memcpy(ad + HEADER_CORE_BYTES, ptr, CONTAINER_POINTER_BYTES);
+    derive_key(key.data(), INDEX_KEY_CONTEXT, sizeof(INDEX_KEY_CONTEXT) - 1, ptr, index_key.data());
+    sealed.resize(blob.size() + suite->abytes);
+    unsigned long long slen;
+    bool ok = suite->encrypt(sealed.data(), &slen, blob.data(), blob.size(), ad, sizeof(ad), NULL, nonce,
+                             index_key.data()) == 0;
+    sodium_memzero(blob.data(), blob.size());
+    return ok;
+}
+
+bool Container::commit_index() {
+    unsigned char ptr[CONTAINER_POINTER_BYTES];
+    std::vector<unsigned char> sealed;
+
+    // Índice e membros no disco antes de o header apontar para eles.
+    bool ok = seal_index(list, data_end, ptr, sealed) && pwrite_exact(fd, sealed.data(), sealed.size(), data_end) &&
+              ::fdatasync(fd) == 0;
+    if (!ok) return false;
+
+    std::memcpy(hdr.container_index, ptr, sizeof(ptr));
+    std::vector<unsigned char> header = serialize_header(hdr);
+    if (header.empty() || !pwrite_exact(fd, header.data(), header.size(), 0) || ::fdatasync(fd) != 0)
+        return false;
+    data_end += sealed.size();
+    return ::ftruncate(fd, static_cast<off_t>(data_end)) == 0;
+}
+
+// Membro pequeno lido e selado em memória por um worker.
+struct SealedMember {
+    bool ok = false;
+    bool large = false;
+    ContainerEntry entry;
+    std::vector<unsigned char> data;
+};
+
+static void seal_small(const FileHeader& hdr, const unsigned char dek[DEK_BYTES], size_t abytes,
+                       const ContainerInput& input, SealedMember& m, OperationStats* stats) {
+    StageTimer read_timer(stats, Stage::Read);
+    int in = ::open(input.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return;
+    struct stat st;
+    if (fstat(in, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(in);
+        return;
+    }
+    m.entry.name = input.name;
+    m.entry.mode = static_cast<uint32_t>(st.st_mode & 07777);
+    m.entry.mtime = static_cast<int64_t>(st.st_mtime);
+    if (static_cast<uint64_t>(st.st_size) > SMALL_MEMBER_BYTES) {
+        ::close(in);
+        m.large = true;
+        return;
+    }
+
+    // Lê um byte além do tamanho do stat para perceber arquivos que cresceram no meio.
+    std::vector<unsigned char> plain(static_cast<size_t>(st.st_size) + 1);
+    size_t got = 0;
+    for (;;) {
+        ssize_t n = ::read(in, plain.data() + got, plain.size() - got);
+        if (n < 0) {
+            ::close(in);
+            return;
+        }
+        if (n == 0) break;
+        got += static_cast<size_t>(n);
+        if (got == plain.size()) {
+            ::close(in);
+            m.large = true;
+            return;
+        }
+    }
+    ::close(in);
+    read_timer.record(got);
+
+    StageTimer crypt_timer(stats, Stage::Crypt);
+    m.entry.size = got;
+    randombytes_buf(m.entry.member_id, sizeof(m.entry.member_id));
+    SecretBlock mkey;
+    member_key(dek, m.entry.member_id, mkey.data());
+
+    uint64_t segments = member_segments(hdr, got);
+    m.data.resize(member_stored_bytes(hdr, abytes, got));
+    size_t in_pos = 0, out_pos = 0;
+    bool ok = true;
+    for (uint64_t j = 0; j < segments && ok; ++j) {
+        size_t len = std::min<size_t>(hdr.segment_size, got - in_pos);
+        size_t clen;
+        ok = seal_segment(hdr, mkey.data(), static_cast<uint32_t>(j), j + 1 == segments, plain.data() + in_pos,
+                          len, m.data.data() + out_pos, &clen);
+        in_pos += len;
+        out_pos += clen;
+    }
+    sodium_memzero(plain.data(), plain.size());
+    m.ok = ok && out_pos == m.data.size();
+    crypt_timer.record(got, segments);
+}
+
+bool Container::add(const std::vector<ContainerInput>& files, std::vector<size_t>& failed) {
+    failed.clear();
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (fd < 0 || !suite) return false;
+
+    // Restos de uma inclusão interrompida (depois do índice atual) são descartados.
+    if (::ftruncate(fd, static_cast<off_t>(data_end)) != 0) return false;
+
+    auto record = [&](ContainerEntry& e) {
+        e.offset = data_end;
+        data_end += member_stored_bytes(hdr, suite->abytes, e.size);
+        auto it = by_name.find(e.name);
+        if (it != by_name.end()) {
+            list[it->second] = e;
+        } else {
+            by_name[e.name] = list.size();
+            list.push_back(e);
+        }
+    };
+
+    ThreadPool pool(ThreadPool::resolve_threads(opts.threads));
+    std::vector<SealedMember> batch;
+    std::vector<size_t> large;
+    for (size_t first = 0; first < files.size();) {
+        size_t count = std::min(BATCH_FILES, files.size() - first);
+        batch.assign(count, SealedMember());
+        pool.parallel_for(count, [&](size_t i) {
+            seal_small(hdr, key.data(), suite->abytes, files[first + i], batch[i], opts.stats);
+        });
+
+        for (size_t i = 0; i < count; ++i) {
+            SealedMember& m = batch[i];
+            if (m.large) {
+                large.push_back(first + i);
+            } else if (!m.ok) {
+                failed.push_back(first + i);
+            } else {
+                StageTimer timer(opts.stats, Stage::Write);
+                timer.record(m.data.size());
+                if (!pwrite_exact(fd, m.data.data(), m.data.size(), data_end)) return false;
+                record(m.entry);
+            }
+        }
+        first += count;
+    }
+
+    for (size_t index : large) {
+        const ContainerInput& input = files[index];
+        struct stat st;
+        std::unique_ptr<InputSource> in;
+        if (::stat(input.path.c_str(), &st) == 0) in = open_input(input.path, opts.io);
+        if (!in) {
+            failed.push_back(index);
+            continue;
+        }
+        ContainerEntry e;
+        e.name = input.name;
+        e.mode = static_cast<uint32_t>(st.st_mode & 07777);
+        e.mtime = static_cast<int64_t>(st.st_mtime);
+        randombytes_buf(e.member_id, sizeof(e.member_id));
+        SecretBlock mkey;
+        member_key(key.data(), e.member_id, mkey.data());
+        PositionedOutput out(fd, data_end);
+        StreamTotals totals;
+        bool ok = seal_stream(*in, out, hdr, mkey.data(), opts, &totals);
+        if (!ok || in->failed()) {
+            failed.push_back(index);
+            continue;
+        }
+        e.size = totals.plaintext_bytes;
+        record(e);
+    }
+    std::sort(failed.begin(), failed.end());
+
+    // Sem o novo índice, data_end volta ao fim do índice atual.
+    uint64_t members_end = data_end;
+    if (commit_index()) return true;
+    data_end = members_end;
+    return false;
+}
+
+bool Container::extract(const ContainerEntry& entry, OutputSink& out) const {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (fd < 0 || !suite) return false;
+
+    SecretBlock mkey;
+    member_key(key.data(), entry.member_id, mkey.data());
+    const uint64_t segments = member_segments(hdr, entry.size);
+    std::vector<unsigned char> in(hdr.segment_size + suite->abytes), plain(hdr.segment_size);
+    uint64_t pos = entry.offset, remaining = entry.size;
+    bool ok = segments <= MAX_SEGMENTS;
+    for (uint64_t j = 0; j < segments && ok; ++j) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(hdr.segment_size, remaining));
+        size_t plen = 0;
+        {
+            StageTimer timer(opts.stats, Stage::Read);
+            timer.record(len + suite->abytes);
+            ok = pread_exact(fd, in.data(), len + suite->abytes, pos);
+        }
+        if (ok) {
+            StageTimer timer(opts.stats, Stage::Crypt);
+            timer.record(len);
+            ok = open_segment(hdr, mkey.data(), static_cast<uint32_t>(j), j + 1 == segments, in.data(),
+                              len + suite->abytes, plain.data(), &plen) &&
+                 plen == len;
+        }
+        if (ok) {
+            StageTimer timer(opts.stats, Stage::Write);
+            timer.record(plen);
+            ok = out.write(plain.data(), plen);
+        }
+        pos += len + suite->abytes;
+        remaining -= len;
+    }
+    sodium_memzero(plain.data(), plain.size());
+    return ok && out.finish();
+}
+
+uint64_t Container::reclaimable_bytes() const {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (fd < 0 || !suite) return 0;
+    uint64_t live = hdr.header_len + get_u64(hdr.container_index + FILE_ID_BYTES + 8);
+    for (const ContainerEntry& e : list) live += member_stored_bytes(hdr, suite->abytes, e.size);
+    return data_end > live ? data_end - live : 0;
+}
+
+bool Container::compact() {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    struct stat st;
+    if (fd < 0 || !suite || fstat(fd, &st) != 0) return false;
+    if (reclaimable_bytes() == 0) return true;
+
+    // O rename substitui o arquivo de destino; um link simbólico continua apontando para ele.
+    std::error_code ec;
+    std::string target = std::filesystem::canonical(file_path, ec).string();
+    if (ec) return false;
+    unsigned char suffix[4];
+    char hex[2 * sizeof(suffix) + 1];
+    randombytes_buf(suffix, sizeof(suffix));
+    sodium_bin2hex(hex, sizeof(hex), suffix, sizeof(suffix));
+    std::filesystem::path tp(target);
+    std::string temp = (tp.parent_path() / ("." + tp.filename().string() + ".compact-" + hex)).string();
+    int out = ::open(temp.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777);
+    if (out < 0) return false;
+
+    // Membros na ordem do índice, colados logo depois do header; os bytes selados não mudam.
+    std::vector<ContainerEntry> moved = list;
+    std::vector<unsigned char> buf(std::max<size_t>(hdr.segment_size + suite->abytes, 1 << 20));
+    uint64_t pos = hdr.header_len;
+    bool ok = true;
+    for (size_t i = 0; i < moved.size() && ok; ++i) {
+        uint64_t remaining = member_stored_bytes(hdr, suite->abytes, moved[i].size);
+        uint64_t from = moved[i].offset;
+        moved[i].offset = pos;
+        while (remaining > 0 && ok) {
+            size_t len = static_cast<size_t>(std::min<uint64_t>(buf.size(), remaining));
+            ok = pread_exact(fd, buf.data(), len, from) && pwrite_exact(out, buf.data(), len, pos);
+            from += len;
+            pos += len;
+            remaining -= len;
+        }
+    }
+
+    FileHeader next = hdr;
+    std::vector<unsigned char> sealed, header;
+    ok = ok && seal_index(moved, pos, next.container_index, sealed) &&
+         pwrite_exact(out, sealed.data(), sealed.size(), pos);
+    if (ok) header = serialize_header(next);
+    ok = ok && !header.empty() && pwrite_exact(out, header.data(), header.size(), 0) && ::fdatasync(out) == 0 &&
+         ::rename(temp.c_str(), target.c_str()) == 0;
+    if (!ok) {
+        ::close(out);
+        ::unlink(temp.c_str());
+        return false;
+    }
+    sync_parent_dir(target);
+
+    ::close(fd);
+    fd = out;
+    hdr = next;
+    list.swap(moved);
+    data_end = pos + sealed.size();
+    return true;
+}
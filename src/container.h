@@ -0,0 +1,93 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include "format.h"
+#include "io_backend.h"
+#include "memory_pool.h"
+#include "options.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Contêiner de vários arquivos (.ecp).
+//
+// Um único header v2 (FLAG_CONTAINER) com os keyslots de sempre: uma derivação de chave
+// para o contêiner inteiro, e rekey funciona como em qualquer .ecc. Depois do header vêm os
+// membros, cada um selado em segmentos com a chave BLAKE2b(DEK, member_id) e o mesmo esquema
+// de nonces dos arquivos avulsos, e por fim o índice cifrado (nomes, tamanhos, posições).
+// O registro TAG_CONTAINER_INDEX do header aponta para o índice atual.
+//
+// Incluir arquivos grava os novos membros e um novo índice depois do fim atual e só então
+// reescreve o header; uma inclusão interrompida deixa o contêiner como estava.
+//
+// Substituir um membro (mesmo nome) só troca a entrada do índice: os segmentos antigos, e
+// os índices anteriores, continuam no arquivo como espaço morto até um compact(), que copia
+// os membros vivos, sem decifrá-los, para um arquivo novo e o renomeia sobre o contêiner.
+struct ContainerEntry {
+    std::string name;     // caminho relativo, com '/'
+    uint64_t size = 0;
+    int64_t mtime = 0;    // segundos desde a época
+    uint32_t mode = 0644;
+    uint64_t offset = 0;  // primeiro segmento do membro no contêiner
+    unsigned char member_id[FILE_ID_BYTES] = {0};
+};
+
+struct ContainerInput {
+    std::string path;   // arquivo a ler
+    std::string name;   // nome gravado no índice; um nome repetido substitui o anterior
+};
+
+class Container {
+public:
+    Container() = default;
+    ~Container();
+
+    Container(const Container&) = delete;
+    Container& operator=(const Container&) = delete;
+
+    // Cria um contêiner vazio (header e índice vazio).
+    bool create(const std::string& path, const std::string& password, const CryptoOptions& options,
+                bool overwrite = false);
+
+    // Abre um contêiner existente; writable permite add().
+    bool open(const std::string& path, const std::string& password, const CryptoOptions& options,
+              bool writable = false);
+
+    const std::vector<ContainerEntry>& entries() const { return list; }
+    const ContainerEntry* find(const std::string& name) const;
+
+    // Sela os arquivos e grava o novo índice. Arquivos que não puderam ser lidos ficam de
+    // fora e são listados em failed (índices de files); falso só se o contêiner falhou.
+    bool add(const std::vector<ContainerInput>& files, std::vector<size_t>& failed);
+
+    // Decifra um membro para out (lendo só os segmentos dele) e chama out.finish().
+    bool extract(const ContainerEntry& entry, OutputSink& out) const;
+
+    // Bytes que não pertencem a nenhum membro nem ao índice atual (membros substituídos e
+    // índices antigos); compact() os devolve.
+    uint64_t reclaimable_bytes() const;
+
+    // Regrava o contêiner só com os membros vivos (aberto com writable). Os segmentos são
+    // copiados como estão: as chaves e os nonces não dependem da posição. Uma falha ou uma
+    // queda antes do rename deixam o contêiner original intacto.
+    bool compact();
+
+private:
+    bool load_index();
+    bool seal_index(const std::vector<ContainerEntry>& entries, uint64_t offset,
+                    unsigned char ptr[CONTAINER_POINTER_BYTES], std::vector<unsigned char>& sealed) const;
+    bool commit_index();
+    void close();
+
+    int fd = -1;
+    std::string file_path;
+    FileHeader hdr;
+    SecretBlock key;   // DEK do contêiner (memory_pool.h)
+    CryptoOptions opts;
+    std::vector<ContainerEntry> list;
+    std::map<std::string, size_t> by_name;
+    uint64_t data_end = 0;   // fim do índice atual; novos membros entram a partir daqui
+};
+
+#endif
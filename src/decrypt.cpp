@@ -1,38 +1,338 @@
 // decrypt.cpp (corrigido - leitura binária e validação AES-GCM)
 #include "decrypt.h"
 #include "eccfrog512ck2.h"
+#include "aead.h"
+#include "compress.h"
+#include "format.h"
+#include "stream.h"
+#include "keyslot.h"
+#include "header_journal.h"
+#include "memory_pool.h"
+#include "progress.h"
+#include "session.h"
+#include "stats.h"
 #include <sodium.h>
-#include <fstream>
+#include <algorithm>
 #include <vector>
 #include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-bool decrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password) {
-    std::ifstream in(input_file, std::ios::binary);
-    if (!in) return false;
-
-    unsigned char salt[crypto_pwhash_SALTBYTES];
-    unsigned char nonce[crypto_aead_aes256gcm_NPUBBYTES];
+// Lê o restante da fonte para o fim de buf.
+static bool read_rest(InputSource& in, std::vector<unsigned char>& buf) {
+    std::vector<unsigned char> chunk(DEFAULT_SEGMENT_SIZE);
+    for (;;) {
+        const unsigned char* data;
+        size_t got = in.acquire(chunk.data(), chunk.size(), &data);
+        if (in.failed()) return false;
+        if (got == 0) return true;
+        buf.insert(buf.end(), data, data + got);
+    }
+}
 
-    in.read(reinterpret_cast<char*>(salt), sizeof(salt));
-    in.read(reinterpret_cast<char*>(nonce), sizeof(nonce));
+// Formato original: salt | nonce | ciphertext, selado como uma única mensagem AES-GCM.
+// Uma única tag cobre o arquivo inteiro, então este caminho precisa manter tudo em memória.
+// `data` já contém os bytes lidos para detectar o formato.
+static bool decrypt_legacy(InputSource& in, OutputSink& out, std::vector<unsigned char>& data,
+                           const std::string& password, const CryptoOptions& options) {
+    {
+        StageTimer timer(options.stats, Stage::Read);
+        if (!read_rest(in, data)) return false;
+        timer.record(data.size());
+    }
+    if (data.size() < crypto_pwhash_SALTBYTES + crypto_aead_aes256gcm_NPUBBYTES) return false;
 
-    std::vector<unsigned char> ciphertext((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const unsigned char* salt = data.data();
+    const unsigned char* nonce = salt + crypto_pwhash_SALTBYTES;
+    const unsigned char* ciphertext = nonce + crypto_aead_aes256gcm_NPUBBYTES;
+    size_t ciphertext_len = data.size() - crypto_pwhash_SALTBYTES - crypto_aead_aes256gcm_NPUBBYTES;
 
-    unsigned char key[crypto_aead_aes256gcm_KEYBYTES];
-    if (crypto_pwhash(key, sizeof(key), password.c_str(), password.size(), salt,
-                      crypto_pwhash_OPSLIMIT_MODERATE, crypto_pwhash_MEMLIMIT_MODERATE, crypto_pwhash_ALG_DEFAULT) != 0)
+    SecretBlock key;
+    bool derived;
+    {
+        StageTimer timer(options.stats, Stage::Kdf);
+        derived = options.session ? options.session->master_for_salt(salt, key.data())
+                                  : derive_password_key(password, salt, key.data());
+    }
+    if (!derived)
         return false;
+    if (options.progress && options.progress->cancelled()) return false;   // cifra de uma vez só
 
-    std::vector<unsigned char> decrypted(ciphertext.size());
+    // Sempre AES-256-GCM; em hosts sem AES-NI, pela implementação em software (aead.h).
+    const AeadSuite* suite = aead_suite(static_cast<uint8_t>(CipherSuite::Aes256Gcm));
+    if (!suite) return false;
+
+    std::vector<unsigned char> decrypted(ciphertext_len);
     unsigned long long decrypted_len;
 
-    if (crypto_aead_aes256gcm_decrypt(decrypted.data(), &decrypted_len, NULL,
-                                      ciphertext.data(), ciphertext.size(), NULL, 0, nonce, key) != 0)
+    {
+        StageTimer timer(options.stats, Stage::Crypt);
+        if (suite->decrypt(decrypted.data(), &decrypted_len, NULL,
+                           ciphertext, ciphertext_len, NULL, 0, nonce, key.data()) != 0)
+            return false;
+        timer.record(decrypted_len);
+    }
+
+    StageTimer timer(options.stats, Stage::Write);
+    timer.record(decrypted_len);
+    return out.write(decrypted.data(), decrypted_len) && out.finish();
+}
+
+static bool decrypt_segmented(InputSource& in, OutputSink& out, const unsigned char* core,
+                              const std::string& password, const CryptoOptions& options) {
+    FileHeader hdr;
+    if (!parse_header_core(core, HEADER_CORE_BYTES, hdr)) return false;
+    if (hdr.flags & FLAG_CONTAINER) return false;   // contêineres são lidos por container.h
+
+    std::vector<unsigned char> records(hdr.header_len - HEADER_CORE_BYTES);
+    if (!read_exact(in, records.data(), records.size()) ||
+        !parse_header_records(records.data(), records.size(), hdr))
+        return false;
+
+    SecretBlock key;
+    if (!unlock_file_header(hdr, password, options, key.data()))
         return false;
 
-    std::ofstream out(output_file, std::ios::binary);
+    return open_stream(in, out, hdr, key.data(), options) && out.finish();
+}
+
+bool decrypt_stream(InputSource& in, OutputSink& out, const std::string& password,
+                    const CryptoOptions& options) {
+    std::vector<unsigned char> probe(HEADER_CORE_BYTES);
+    size_t got = 0;
+    while (got < probe.size()) {
+        const unsigned char* data;
+        size_t n = in.acquire(probe.data() + got, probe.size() - got, &data);
+        if (n == 0) break;
+        if (data != probe.data() + got) std::memcpy(probe.data() + got, data, n);
+        got += n;
+    }
+    probe.resize(got);
+
+    if (is_stream_format(probe.data(), probe.size()))
+        return decrypt_segmented(in, out, probe.data(), password, options);
+    // O formato legado só conhece senha.
+    if (options.identity) return false;
+    return decrypt_legacy(in, out, probe, password, options);
+}
+
+bool decrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password,
+                  const CryptoOptions& options) {
+    // Um rekey interrompido é concluído antes; sem permissão de escrita, segue com o header atual.
+    recover_header_journal(input_file);
+    std::unique_ptr<InputSource> in = open_input(input_file, options.io);
+    if (!in) return false;
+
+    std::unique_ptr<OutputSink> out = open_output(output_file, options.io);
     if (!out) return false;
 
-    out.write(reinterpret_cast<const char*>(decrypted.data()), decrypted_len);
+    if (!decrypt_stream(*in, *out, password, options)) {
+        // Não deixa texto claro parcial de um arquivo que não autenticou.
+        out.reset();
+        std::error_code ec;
+        std::filesystem::remove(output_file, ec);
+        return false;
+    }
     return true;
-}
\ No newline at end of file
+}
+
+// Percorre os prefixos de tamanho dos segmentos de um arquivo comprimido, de pos até o fim.
+// Guarda onde começa o texto cifrado de cada segmento e quantos bytes ele tem.
+static bool locate_framed_segments(int fd, uint64_t pos, uint64_t file_size, uint64_t max_len,
+                                   std::vector<uint64_t>& starts, std::vector<size_t>& lens) {
+    while (pos < file_size) {
+        unsigned char prefix[SEGMENT_FRAME_BYTES];
+        if (file_size - pos < sizeof(prefix) || !pread_exact(fd, prefix, sizeof(prefix), pos)) return false;
+        uint64_t len = static_cast<uint64_t>(prefix[0]) | (static_cast<uint64_t>(prefix[1]) << 8) |
+                       (static_cast<uint64_t>(prefix[2]) << 16) | (static_cast<uint64_t>(prefix[3]) << 24);
+        pos += sizeof(prefix);
+        if (len > max_len || len > file_size - pos || starts.size() >= MAX_SEGMENTS) return false;
+        starts.push_back(pos);
+        lens.push_back(static_cast<size_t>(len));
+        pos += len;
+    }
+    return !starts.empty();
+}
+
+static bool read_range(int fd, uint64_t file_size, uint64_t offset, uint64_t length, OutputSink& sink,
+                       const std::string& password, const CryptoOptions& options) {
+    unsigned char core[HEADER_CORE_BYTES];
+    FileHeader hdr;
+    if (file_size < HEADER_CORE_BYTES || !pread_exact(fd, core, sizeof(core), 0) ||
+        !parse_header_core(core, sizeof(core), hdr) || hdr.header_len > file_size ||
+        (hdr.flags & FLAG_CONTAINER))
+        return false;
+
+    std::vector<unsigned char> records(hdr.header_len - HEADER_CORE_BYTES);
+    if (!pread_exact(fd, records.data(), records.size(), HEADER_CORE_BYTES) ||
+        !parse_header_records(records.data(), records.size(), hdr))
+        return false;
+
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return false;
+
+    SecretBlock key;
+    if (!unlock_file_header(hdr, password, options, key.data())) return false;
+
+    // Posições dos segmentos: todos ocupam slot bytes, exceto o último. Nos comprimidos, o
+    // tamanho gravado varia: com FLAG_SEGMENT_TABLE, as posições saem do bloco da tabela que
+    // cobre o segmento; nos anteriores, dos prefixos (um pread de 4 bytes por segmento).
+    const bool compressed = hdr.flags & FLAG_COMPRESSED;
+    const bool table = compressed && (hdr.flags & FLAG_SEGMENT_TABLE);
+    const uint64_t seg = hdr.segment_size;
+    const uint64_t slot = (compressed ? packed_segment_bound(hdr.segment_size) : seg) + suite->abytes;
+    const uint64_t data_bytes = file_size - hdr.header_len;
+    std::vector<uint64_t> starts;
+    std::vector<size_t> lens;
+    StreamTotals totals;
+    bool check_last = hdr.index.empty();
+    bool ok = true;
+    if (table) {
+        ok = !check_last;   // a tabela só existe com o índice
+    } else if (compressed) {
+        ok = locate_framed_segments(fd, hdr.header_len, file_size, slot, starts, lens);
+        totals.segments = starts.size();
+    } else if (check_last) {
+        totals.segments = (data_bytes + slot - 1) / slot;
+        ok = totals.segments > 0 && data_bytes - (totals.segments - 1) * slot >= suite->abytes;
+        if (ok) totals.plaintext_bytes = data_bytes - totals.segments * suite->abytes;
+    }
+    if (ok && !check_last) {
+        // O índice autentica os totais; o tamanho do arquivo tem de bater com eles.
+        uint64_t segments = totals.segments;
+        ok = open_segment_index(hdr, key.data(), totals) && totals.segments > 0 &&
+             totals.plaintext_bytes >= (totals.segments - 1) * seg &&
+             totals.plaintext_bytes - (totals.segments - 1) * seg <= seg &&
+             (table        ? totals.stored_bytes <= data_bytes &&
+                                data_bytes - totals.stored_bytes == segment_table_bytes(hdr, totals.segments)
+              : compressed ? totals.segments == segments
+                           : totals.plaintext_bytes + totals.segments * suite->abytes == data_bytes);
+    }
+    ok = ok && totals.segments <= MAX_SEGMENTS;
+
+    // Bloco da tabela aberto por último: segmentos vizinhos caem quase sempre no mesmo.
+    SegmentTableBlock block;
+    uint64_t block_index = UINT64_MAX;
+    std::vector<unsigned char> sealed_block;
+    auto locate = [&](uint64_t index, uint64_t& pos, size_t& len) {
+        if (!compressed) {
+            pos = hdr.header_len + index * slot;
+            len = static_cast<size_t>(std::min(slot, file_size - pos));
+            return true;
+        }
+        if (!table) {
+            pos = starts[index];
+            len = lens[index];
+            return true;
+        }
+        if (index / SEGMENT_TABLE_BLOCK != block_index) {
+            uint64_t at;
+            size_t block_len;
+            block_index = UINT64_MAX;
+            if (!segment_table_block_span(hdr, totals.segments, index / SEGMENT_TABLE_BLOCK, at, block_len))
+                return false;
+            sealed_block.resize(block_len);
+            {
+                StageTimer timer(options.stats, Stage::Read);
+                timer.record(block_len);
+                if (!pread_exact(fd, sealed_block.data(), block_len, hdr.header_len + totals.stored_bytes + at))
+                    return false;
+            }
+            if (!open_segment_table_block(hdr, key.data(), totals.segments, index / SEGMENT_TABLE_BLOCK,
+                                          sealed_block.data(), block_len, block))
+                return false;
+            block_index = index / SEGMENT_TABLE_BLOCK;
+        }
+        uint64_t offset = block.first_offset;
+        size_t k = static_cast<size_t>(index % SEGMENT_TABLE_BLOCK);
+        for (size_t i = 0; i < k; ++i) offset += SEGMENT_FRAME_BYTES + block.lens[i];
+        offset += SEGMENT_FRAME_BYTES;
+        len = block.lens[k];
+        pos = hdr.header_len + offset;
+        return len <= slot && offset <= totals.stored_bytes && len <= totals.stored_bytes - offset;
+    };
+
+    std::vector<unsigned char> in(slot), out(seg);
+    auto open_at = [&](uint64_t index, size_t& plen) {
+        uint64_t pos;
+        size_t len;
+        if (!locate(index, pos, len)) return false;
+        {
+            StageTimer timer(options.stats, Stage::Read);
+            timer.record(len);
+            if (!pread_exact(fd, in.data(), len, pos)) return false;
+        }
+        StageTimer timer(options.stats, Stage::Crypt);
+        bool opened = open_segment(hdr, key.data(), static_cast<uint32_t>(index), index + 1 == totals.segments,
+                                   in.data(), len, out.data(), &plen);
+        timer.record(opened ? plen : 0);
+        return opened;
+    };
+
+    // Sem índice, só o segmento final (flag de último) prova que o arquivo não foi truncado;
+    // ele é aberto antes de emitir qualquer byte. Nos comprimidos, dá também o tamanho do
+    // texto claro.
+    if (ok && check_last) {
+        size_t plen;
+        ok = open_at(totals.segments - 1, plen);
+        if (ok && compressed) totals.plaintext_bytes = (totals.segments - 1) * seg + plen;
+    }
+
+    // Cada fatia vai direto para a saída: a memória fica em um segmento, qualquer que seja length.
+    uint64_t begin = std::min(offset, totals.plaintext_bytes);
+    uint64_t end = begin + std::min(length, totals.plaintext_bytes - begin);
+    for (uint64_t index = begin / seg; ok && begin < end && index <= (end - 1) / seg; ++index) {
+        size_t plen;
+        ok = open_at(index, plen);
+        if (!ok) break;
+        uint64_t seg_start = index * seg;
+        uint64_t from = std::max(begin, seg_start), to = std::min(end, seg_start + plen);
+        if (to > from) {
+            StageTimer timer(options.stats, Stage::Write);
+            timer.record(to - from);
+            ok = sink.write(out.data() + (from - seg_start), static_cast<size_t>(to - from));
+        }
+    }
+
+    sodium_memzero(out.data(), out.size());
+    return ok && sink.finish();
+}
+
+// Saída em memória da variante de decrypt_range com vetor.
+class VectorSink : public OutputSink {
+public:
+    explicit VectorSink(std::vector<unsigned char>& buffer) : buf(buffer) {}
+    bool write(const unsigned char* data, size_t len) override {
+        buf.insert(buf.end(), data, data + len);
+        return true;
+    }
+    bool finish() override { return true; }
+
+private:
+    std::vector<unsigned char>& buf;
+};
+
+bool decrypt_range(const std::string& input_file, uint64_t offset, uint64_t length, OutputSink& out,
+                   const std::string& password, const CryptoOptions& options) {
+    recover_header_journal(input_file);
+    int fd = ::open(input_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+              read_range(fd, static_cast<uint64_t>(st.st_size), offset, length, out, password, options);
+    ::close(fd);
+    return ok;
+}
+
+bool decrypt_range(const std::string& input_file, uint64_t offset, uint64_t length,
+                   std::vector<unsigned char>& plaintext, const std::string& password,
+                   const CryptoOptions& options) {
+    plaintext.clear();
+    VectorSink sink(plaintext);
+    if (decrypt_range(input_file, offset, length, sink, password, options)) return true;
+    sodium_memzero(plaintext.data(), plaintext.size());
+    plaintext.clear();
+    return false;
+}
@@ -1,9 +1,35 @@
 #ifndef DECRYPT_H
 #define DECRYPT_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "io_backend.h"
+#include "options.h"
 
 // Descriptografa o arquivo de entrada para o arquivo de saída utilizando a senha.
-bool decrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password);
+bool decrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password,
+                  const CryptoOptions& options = CryptoOptions());
+
+// Mesma operação sobre fontes/destinos já abertos (stdin/stdout, por exemplo).
+bool decrypt_stream(InputSource& in, OutputSink& out, const std::string& password,
+                    const CryptoOptions& options = CryptoOptions());
+
+// Decifra só os bytes [offset, offset + length) do texto claro, lendo e abrindo apenas os
+// segmentos que os contêm; o custo acompanha o tamanho pedido, não o do arquivo. O total
+// vem do índice autenticado do header; arquivos sem índice usam o tamanho do arquivo e
+// abrem também o segmento final, o que autentica o fim. Nos comprimidos, as posições vêm
+// da tabela de segmentos (um bloco por 1024 segmentos); comprimidos gravados antes dela,
+// ou sem índice, leem o prefixo de cada segmento, com custo proporcional ao arquivo.
+// Pedidos além do fim são cortados. Cada segmento aberto vai direto para out, então a
+// memória não depende de length; em caso de falha, out pode ter recebido parte do intervalo.
+// Com options.session, chamadas repetidas sobre o mesmo lote não repetem o Argon2.
+bool decrypt_range(const std::string& input_file, uint64_t offset, uint64_t length, OutputSink& out,
+                   const std::string& password, const CryptoOptions& options = CryptoOptions());
+
+// O mesmo intervalo em memória (vazio em caso de falha).
+bool decrypt_range(const std::string& input_file, uint64_t offset, uint64_t length,
+                   std::vector<unsigned char>& plaintext, const std::string& password,
+                   const CryptoOptions& options = CryptoOptions());
 
 #endif
@@ -1,4 +1,7 @@
 #include "eccfrog512ck2.h"
+#include "ecmul.h"
+#include "point_codec.h"
+#include "thread_pool.h"
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
@@ -6,6 +9,65 @@
 #include <iostream>
 #include <algorithm>
 
+namespace {
+// Curve parameters as little-endian 64-bit limbs (p and n live in fp512_const / ecc_const).
+constexpr uint64_t CURVE_B[8] = {0xbdc598557e0d96c5ULL, 0x4f44e747fe73d907ULL, 0xaec98a80b713fb72ULL, 0xd3f1356a42265cb4ULL,
+                                 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL};
+constexpr uint64_t CURVE_GX[8] = {0xabbc2645fe5465b0ULL, 0x3f7e613447f01e17ULL, 0xd533c17c8a8227dfULL, 0x4d0dda5ad341baa9ULL,
+                                  0x131701b3b61c5c37ULL, 0x70b27e06568cb309ULL, 0xd98219ce07dd0432ULL, 0xa0e29c8968e02582ULL};
+constexpr uint64_t CURVE_GY[8] = {0xfee3c5cef31c45e1ULL, 0x8bf7156595f5b39bULL, 0x760ca74390bb4408ULL, 0x973edda16c6a3b64ULL,
+                                  0xed9ad96aa6ed364eULL, 0x6a9687222c392801ULL, 0x18f22f9a81b61597ULL, 0x5ee57d33874773ddULL};
+
+mpz_class mpz_from_limbs(const uint64_t limbs[8]) {
+    mpz_class z;
+    mpz_import(z.get_mpz_t(), 8, -1, sizeof(uint64_t), 0, 0, limbs);
+    return z;
+}
+
+AffinePoint to_affine_point(const ECCFrog512CK2::Point& P) {
+    AffinePoint r = affine_infinity();
+    if (P.at_infinity) return r;
+    if (!fp_from_mpz(r.x, P.x) || !fp_from_mpz(r.y, P.y)) {
+        throw std::runtime_error("Point coordinate outside the field");
+    }
+    r.infinity = false;
+    return r;
+}
+
+// Batch import: keys are decoded in chunks, chunks are spread over a pool once the
+// batch is large enough to pay for the threads.
+const size_t IMPORT_CHUNK = 64;
+const size_t IMPORT_PARALLEL_MIN = 256;
+
+void import_chunk(const std::vector<std::vector<unsigned char>>& encodings, size_t begin, size_t end,
+                  std::vector<AffinePoint>& out, std::vector<unsigned char>& ok) {
+    for (size_t i = begin; i < end; ++i) {
+        ok[i] = decode_point(out[i], encodings[i].data(), encodings[i].size());
+    }
+}
+
+// Nonnegative scalar reduced mod n (every point on the curve has order dividing n) as limbs.
+void scalar_to_limbs(const mpz_class& k, const mpz_class& n, uint64_t out[8]) {
+    if (k < 0) {
+        throw std::runtime_error("Invalid scalar: negative value");
+    }
+    mpz_class e = k;
+    if (e >= n) e %= n;
+
+    for (int i = 0; i < 8; ++i) out[i] = 0;
+    size_t count = 0;
+    mpz_export(out, &count, -1, sizeof(uint64_t), 0, 0, e.get_mpz_t());
+}
+
+ECCFrog512CK2::Point from_affine_point(const AffinePoint& P) {
+    if (P.infinity) return ECCFrog512CK2::Point();
+    mpz_class x, y;
+    fp_to_mpz(x, P.x);
+    fp_to_mpz(y, P.y);
+    return ECCFrog512CK2::Point(x, y);
+}
+}
+
 // Helper function to clean PGP armored data
 static std::string clean_pgp_data(const std::string& pgp_data) {
     std::string cleaned;
@@ -17,6 +79,24 @@ static std::string clean_pgp_data(const std::string& pgp_data) {
     return cleaned;
 }
 
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Decodes lowercase hex (as left by clean_pgp_data) into out; false on a bad digit.
+static bool hex_to_bytes(const char* hex, size_t hex_len, unsigned char* out) {
+    for (size_t i = 0; i < hex_len / 2; ++i) {
+        int hi = hex_value(hex[2 * i]), lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = static_cast<unsigned char>((hi << 4) | lo);
+    }
+    return true;
+}
+
 ECCFrog512CK2::Point::Point() : x(0), y(0), at_infinity(true) {}
 
 ECCFrog512CK2::Point::Point(const mpz_class& x_val, const mpz_class& y_val)
@@ -31,18 +111,16 @@ std::string ECCFrog512CK2::Point::to_string() const {
 
 std::string ECCFrog512CK2::Point::to_compressed_hex() const {
     if (at_infinity) return "00";
-    std::ostringstream oss;
-    int parity = mpz_tstbit(y.get_mpz_t(), 0);
-    oss << (parity ? "03" : "02");
 
-    std::string x_hex = x.get_str(16);
-    if (x_hex.length() > 128) {
-        throw std::runtime_error("x coordinate too large");
-    }
-    x_hex.insert(0, 128 - x_hex.length(), '0');
-    oss << x_hex;
+    unsigned char bytes[COMPRESSED_POINT_BYTES];
+    encode_compressed(bytes, sizeof(bytes));
 
-    return oss.str();
+    std::string hex(2 * sizeof(bytes), '0');
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        hex[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+        hex[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0F];
+    }
+    return hex;
 }
 
 std::vector<unsigned char> ECCFrog512CK2::Point::to_uncompressed_bytes() const {
@@ -50,37 +128,37 @@ std::vector<unsigned char> ECCFrog512CK2::Point::to_uncompressed_bytes() const {
         return {0x00};
     }
 
-    std::vector<unsigned char> bytes(129);
-    bytes[0] = 0x04; // Uncompressed prefix
+    std::vector<unsigned char> bytes(UNCOMPRESSED_POINT_BYTES);
+    encode_uncompressed(bytes.data(), bytes.size());
+    return bytes;
+}
 
-    std::string x_hex = x.get_str(16);
-    x_hex.insert(0, 128 - x_hex.length(), '0');
-    for (int i = 0; i < 64; ++i) {
-        unsigned long xbyte = std::stoul(x_hex.substr(i * 2, 2), nullptr, 16);
-        bytes[1 + i] = static_cast<unsigned char>(xbyte);
+size_t ECCFrog512CK2::Point::encode_compressed(unsigned char* out, size_t out_len) const {
+    if (at_infinity || out_len < COMPRESSED_POINT_BYTES) return 0;
+    out[0] = mpz_tstbit(y.get_mpz_t(), 0) ? 0x03 : 0x02;
+    if (!mpz_to_be_bytes(out + 1, COORD_BYTES, x)) {
+        throw std::runtime_error("x coordinate too large");
     }
+    return COMPRESSED_POINT_BYTES;
+}
 
-    std::string y_hex = y.get_str(16);
-    y_hex.insert(0, 128 - y_hex.length(), '0');
-    for (int i = 0; i < 64; ++i) {
-        unsigned long ybyte = std::stoul(y_hex.substr(i * 2, 2), nullptr, 16);
-        bytes[65 + i] = static_cast<unsigned char>(ybyte);
+size_t ECCFrog512CK2::Point::encode_uncompressed(unsigned char* out, size_t out_len) const {
+    if (at_infinity || out_len < UNCOMPRESSED_POINT_BYTES) return 0;
+    out[0] = 0x04; // Uncompressed prefix
+    if (!mpz_to_be_bytes(out + 1, COORD_BYTES, x) || !mpz_to_be_bytes(out + 1 + COORD_BYTES, COORD_BYTES, y)) {
+        throw std::runtime_error("Coordinate too large");
     }
-
-    return bytes;
+    return UNCOMPRESSED_POINT_BYTES;
 }
 
 ECCFrog512CK2::ECCFrog512CK2() {
-    p = mpz_class("9149012705592502490164965176888130701548053918699793689672344807772801105830681498780746622530729418858477103073591918058480028776841126664954537807339721");
+    p = mpz_from_limbs(fp512_const::P);
     a = p - 7;
-    b = mpz_class("95864189850957917703933006131793785649240252916618759767550461391845895018181");
-    n = mpz_class("9149012705592502490164965176888130701548053918699793689672344807772801105830557269123255850915745063541133157503707284048429261692283957712127567713136519");
+    b = mpz_from_limbs(CURVE_B);
+    n = mpz_from_limbs(ecc_const::N);
     h = 1;
 
-    G = Point(
-        mpz_class("8426241697659200371183582771153260966569955699615044232640972423431947060129573736112298744977332416175021337082775856058058394786264506901662703740544432"),
-        mpz_class("4970129934163735248083452609809843496231929620419038489506391366136186485994288320758668172790060801809810688192082146431970683113557239433570011112556001")
-    );
+    G = Point(mpz_from_limbs(CURVE_GX), mpz_from_limbs(CURVE_GY));
 }
 
 ECCFrog512CK2::Point ECCFrog512CK2::infinity() const {
@@ -88,6 +166,61 @@ ECCFrog512CK2::Point ECCFrog512CK2::infinity() const {
 }
 
 ECCFrog512CK2::Point ECCFrog512CK2::add_points(const Point& P, const Point& Q) const {
+    return from_affine_point(affine_add(to_affine_point(P), to_affine_point(Q)));
+}
+
+ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul(const Point& P, const mpz_class& k) const {
+    uint64_t e[8];
+    scalar_to_limbs(k, n, e);
+
+    if (!P.at_infinity && P.x == G.x && P.y == G.y) {
+        JacobianPoint R;
+        ec_mul_base(R, e);
+        return from_affine_point(jac_to_affine(R));
+    }
+
+    JacobianPoint R;
+    ec_mul_wnaf(R, to_affine_point(P), e);
+    return from_affine_point(jac_to_affine(R));
+}
+
+ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul_base(const mpz_class& k) const {
+    uint64_t e[8];
+    scalar_to_limbs(k, n, e);
+
+    JacobianPoint R;
+    ec_mul_base(R, e);
+    return from_affine_point(jac_to_affine(R));
+}
+
+ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul_ct(const Point& P, const mpz_class& k) const {
+    AffinePoint base = to_affine_point(P);
+    if (!affine_on_curve(base)) {
+        throw std::runtime_error("Point not on curve");
+    }
+    uint64_t e[8];
+    scalar_to_limbs(k, n, e);
+    return from_affine_point(ec_mul_ct(base, e));
+}
+
+mpz_class ECCFrog512CK2::ecdh_x(const Point& peer, const mpz_class& k) const {
+    AffinePoint base = to_affine_point(peer);
+    if (base.infinity || !affine_on_curve(base)) {
+        throw std::runtime_error("Invalid peer point");
+    }
+    uint64_t e[8];
+    scalar_to_limbs(k, n, e);
+
+    Fp512 x;
+    if (!ec_ladder_x(x, base.x, e)) {
+        throw std::runtime_error("ECDH result is the point at infinity");
+    }
+    mpz_class result;
+    fp_to_mpz(result, x);
+    return result;
+}
+
+ECCFrog512CK2::Point ECCFrog512CK2::add_points_reference(const Point& P, const Point& Q) const {
     if (P.at_infinity) return Q;
     if (Q.at_infinity) return P;
     if (P.x == Q.x && (P.y != Q.y || P.y == 0)) return infinity();
@@ -117,7 +250,7 @@ ECCFrog512CK2::Point ECCFrog512CK2::add_points(const Point& P, const Point& Q) c
     return Point(xr, yr);
 }
 
-ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul(const Point& P, const mpz_class& k) const {
+ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul_reference(const Point& P, const mpz_class& k) const {
     Point R = infinity();
     Point Q = P;
     mpz_class scalar = k;
@@ -128,9 +261,9 @@ ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul(const Point& P, const mpz_class&
 
     while (scalar > 0) {
         if (mpz_tstbit(scalar.get_mpz_t(), 0)) {
-            R = add_points(R, Q);
+            R = add_points_reference(R, Q);
         }
-        Q = add_points(Q, Q);
+        Q = add_points_reference(Q, Q);
         scalar >>= 1;
     }
     return R;
@@ -139,69 +272,69 @@ ECCFrog512CK2::Point ECCFrog512CK2::scalar_mul(const Point& P, const mpz_class&
 ECCFrog512CK2::Point ECCFrog512CK2::point_from_compressed_hex(const std::string& hex) const {
     std::string clean_hex = clean_pgp_data(hex);
 
-    if (clean_hex.size() != 66 ||
+    // 130 chars is what to_compressed_hex produces; 66 is the older short form.
+    if ((clean_hex.size() != 130 && clean_hex.size() != 66) ||
        (clean_hex.substr(0, 2) != "02" &&
         clean_hex.substr(0, 2) != "03")) {
-        throw std::runtime_error("Invalid compressed point format: must be 66 hex chars starting with 02/03");
+        throw std::runtime_error("Invalid compressed point format: must be 130 hex chars starting with 02/03");
     }
 
-    mpz_class x(clean_hex.substr(2), 16);
-    if (x >= p) {
-        throw std::runtime_error("x coordinate exceeds field size");
-    }
-
-    mpz_class y_sq = (x*x*x + a*x + b) % p;
-
-    mpz_class y;
-    mpz_class exponent = (p + 1) / 4;
-    mpz_powm(y.get_mpz_t(), y_sq.get_mpz_t(), exponent.get_mpz_t(), p.get_mpz_t());
+    // x is right-aligned in 64 bytes so the short form decodes the same way.
+    unsigned char x_bytes[COORD_BYTES] = {0};
+    size_t x_len = (clean_hex.size() - 2) / 2;
+    hex_to_bytes(clean_hex.data() + 2, clean_hex.size() - 2, x_bytes + COORD_BYTES - x_len);
 
-    bool y_parity = mpz_tstbit(y.get_mpz_t(), 0);
-    bool desired_parity = (clean_hex.substr(0, 2) == "03");
-
-    if (y_parity != desired_parity) {
-        y = p - y;
+    Fp512 fx;
+    if (!decode_fp(fx, x_bytes)) {
+        throw std::runtime_error("x coordinate exceeds field size");
     }
 
-    mpz_class check = (y*y) % p;
-    mpz_class expected = (x*x*x + a*x + b) % p;
-    if (check != expected) {
+    // p = 1 mod 8, so the square root needs Tonelli-Shanks rather than a single (p+1)/4 power.
+    AffinePoint P;
+    if (!affine_decompress(P, fx, clean_hex.substr(0, 2) == "03")) {
         throw std::runtime_error("Derived point not on curve");
     }
-
-    return Point(x, y);
+    return from_affine_point(P);
 }
 
 ECCFrog512CK2::Point ECCFrog512CK2::point_from_uncompressed(const std::vector<unsigned char>& bytes) const {
-    if (bytes.size() != 129 || bytes[0] != 0x04) {
+    if (bytes.size() != UNCOMPRESSED_POINT_BYTES || bytes[0] != 0x04) {
         throw std::runtime_error("Invalid uncompressed format: must be 129 bytes starting with 0x04");
     }
+    return point_from_bytes(bytes.data(), bytes.size());
+}
 
-    mpz_class x;
-    std::string x_hex;
-    for (int i = 1; i <= 64; ++i) {
-        char buf[3];
-        snprintf(buf, sizeof(buf), "%02x", bytes[i]);
-        x_hex += buf;
-    }
-    x.set_str(x_hex, 16);
-
-    mpz_class y;
-    std::string y_hex;
-    for (int i = 65; i <= 128; ++i) {
-        char buf[3];
-        snprintf(buf, sizeof(buf), "%02x", bytes[i]);
-        y_hex += buf;
-    }
-    y.set_str(y_hex, 16);
-
-    mpz_class lhs = (y * y) % p;
-    mpz_class rhs = (x*x*x + a*x + b) % p;
-    if (lhs != rhs) {
+ECCFrog512CK2::Point ECCFrog512CK2::point_from_bytes(const unsigned char* in, size_t len) const {
+    AffinePoint P;
+    if (!decode_point(P, in, len)) {
         throw std::runtime_error("Point not on curve");
     }
+    return from_affine_point(P);
+}
 
-    return Point(x, y);
+std::vector<ECCFrog512CK2::Point> ECCFrog512CK2::import_points(const std::vector<std::vector<unsigned char>>& encodings,
+                                                              std::vector<size_t>& failed, unsigned threads) const {
+    const size_t count = encodings.size();
+    std::vector<AffinePoint> decoded(count);
+    std::vector<unsigned char> ok(count, 0);
+
+    const size_t chunks = (count + IMPORT_CHUNK - 1) / IMPORT_CHUNK;
+    ThreadPool pool(count >= IMPORT_PARALLEL_MIN ? ThreadPool::resolve_threads(threads) : 1);
+    pool.parallel_for(chunks, [&](size_t c) {
+        size_t begin = c * IMPORT_CHUNK;
+        import_chunk(encodings, begin, std::min(count, begin + IMPORT_CHUNK), decoded, ok);
+    });
+
+    std::vector<Point> points(count);
+    failed.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (ok[i]) {
+            points[i] = from_affine_point(decoded[i]);
+        } else {
+            failed.push_back(i);
+        }
+    }
+    return points;
 }
 
 ECCFrog512CK2::Point ECCFrog512CK2::point_from_pgp(const std::string& pgp_data) const {
@@ -211,18 +344,15 @@ ECCFrog512CK2::Point ECCFrog512CK2::point_from_pgp(const std::string& pgp_data)
         throw std::runtime_error("Empty PGP data");
     }
 
-    if (clean_hex.size() == 66 &&
+    if ((clean_hex.size() == 130 || clean_hex.size() == 66) &&
        (clean_hex.substr(0, 2) == "02" ||
         clean_hex.substr(0, 2) == "03")) {
         return point_from_compressed_hex(clean_hex);
     }
     else if (clean_hex.size() == 258 && clean_hex.substr(0, 2) == "04") {
-        std::vector<unsigned char> bytes;
-        for (size_t i = 0; i < clean_hex.length(); i += 2) {
-            bytes.push_back(static_cast<unsigned char>(
-                std::stoul(clean_hex.substr(i, 2), nullptr, 16)));
-        }
-        return point_from_uncompressed(bytes);
+        unsigned char bytes[UNCOMPRESSED_POINT_BYTES];
+        hex_to_bytes(clean_hex.data(), clean_hex.size(), bytes);
+        return point_from_bytes(bytes, sizeof(bytes));
     }
     else {
         throw std::runtime_error("Unrecognized PGP key format");
@@ -16,6 +16,11 @@ public:
         std::string to_string() const;
         std::string to_compressed_hex() const;
         std::vector<unsigned char> to_uncompressed_bytes() const;
+
+        // Binary encodings (see point_codec.h) into caller buffers; return the bytes written,
+        // 0 for the point at infinity or a buffer that is too small.
+        size_t encode_compressed(unsigned char* out, size_t out_len) const;
+        size_t encode_uncompressed(unsigned char* out, size_t out_len) const;
     };
 
     ECCFrog512CK2();
@@ -26,9 +31,27 @@ public:
     Point infinity() const;
     Point add_points(const Point& P, const Point& Q) const;
     Point scalar_mul(const Point& P, const mpz_class& k) const;
+    Point scalar_mul_base(const mpz_class& k) const;   // k * G from a precomputed table
+
+    // Fixed-length, branch-free ladders for secret scalars. Both reject points off the curve.
+    Point scalar_mul_ct(const Point& P, const mpz_class& k) const;
+    mpz_class ecdh_x(const Point& peer, const mpz_class& k) const;   // x(k * peer), x-only ladder
+
+    // Original mpz_class implementations, kept to cross-check the fixed-width path.
+    Point add_points_reference(const Point& P, const Point& Q) const;
+    Point scalar_mul_reference(const Point& P, const mpz_class& k) const;
+
     Point point_from_compressed_hex(const std::string& hex) const;
     Point point_from_uncompressed(const std::vector<unsigned char>& bytes) const;
     Point point_from_pgp(const std::string& pgp_data) const;
+    Point point_from_bytes(const unsigned char* in, size_t len) const;   // compressed or uncompressed
+
+    // Batch import of binary keys: 0x02/0x03 || x (65 bytes) or 0x04 || x || y (129 bytes),
+    // coordinates big-endian. Entries that do not decode or are off the curve are listed in
+    // failed and come back as the point at infinity; the rest of the batch is unaffected.
+    // Large batches are split across threads (0 = all cores).
+    std::vector<Point> import_points(const std::vector<std::vector<unsigned char>>& encodings,
+                                     std::vector<size_t>& failed, unsigned threads = 0) const;
 
 private:
     mpz_class p, a, b, n, h;
@@ -0,0 +1,230 @@
+#include "ecmul.h"
+#include <mutex>
+#include <vector>
+
+namespace {
+const int BASE_TABLE_ROW = (1 << BASE_WINDOW_BITS) - 1;
+const int WNAF_TABLE_SIZE = 1 << (WNAF_WIDTH - 2);
+const int WNAF_MAX_DIGITS = 512 + 2;
+
+std::once_flag base_table_once;
+std::vector<AffinePoint> base_table;
+
+void build_base_table() {
+    // Window bases 16^i * G, normalised together.
+    std::vector<JacobianPoint> jac(BASE_WINDOWS);
+    JacobianPoint acc;
+    jac_from_affine(acc, curve_generator());
+    for (int i = 0; i < BASE_WINDOWS; ++i) {
+        jac[i] = acc;
+        for (int d = 0; d < BASE_WINDOW_BITS; ++d) jac_double(acc, acc);
+    }
+    std::vector<AffinePoint> bases(BASE_WINDOWS);
+    jac_batch_to_affine(jac.data(), bases.data(), BASE_WINDOWS);
+
+    // Row i holds 1..15 times its base.
+    jac.resize(static_cast<size_t>(BASE_WINDOWS) * BASE_TABLE_ROW);
+    for (int i = 0; i < BASE_WINDOWS; ++i) {
+        JacobianPoint* row = &jac[static_cast<size_t>(i) * BASE_TABLE_ROW];
+        jac_from_affine(row[0], bases[i]);
+        for (int j = 1; j < BASE_TABLE_ROW; ++j) jac_add_mixed(row[j], row[j - 1], bases[i]);
+    }
+    base_table.resize(jac.size());
+    jac_batch_to_affine(jac.data(), base_table.data(), jac.size());
+}
+
+bool limbs_zero(const uint64_t t[9]) {
+    uint64_t acc = 0;
+    for (int i = 0; i < 9; ++i) acc |= t[i];
+    return acc == 0;
+}
+
+// Width-w NAF digits of k, least significant first; returns the digit count.
+int wnaf_recode(int8_t naf[WNAF_MAX_DIGITS], const uint64_t k[8]) {
+    uint64_t t[9];
+    for (int i = 0; i < 8; ++i) t[i] = k[i];
+    t[8] = 0;
+
+    const int64_t window = 1 << WNAF_WIDTH;
+    int len = 0;
+    while (!limbs_zero(t)) {
+        int64_t d = 0;
+        if (t[0] & 1) {
+            d = static_cast<int64_t>(t[0] & (window - 1));
+            if (d >= window / 2) d -= window;
+
+            // t -= d; t stays nonnegative and the low w bits become zero.
+            if (d > 0) {
+                uint64_t borrow = static_cast<uint64_t>(d);
+                for (int i = 0; i < 9 && borrow; ++i) {
+                    uint64_t prev = t[i];
+                    t[i] -= borrow;
+                    borrow = prev < borrow;
+                }
+            } else {
+                uint64_t carry = static_cast<uint64_t>(-d);
+                for (int i = 0; i < 9 && carry; ++i) {
+                    t[i] += carry;
+                    carry = t[i] < carry;
+                }
+            }
+        }
+        naf[len++] = static_cast<int8_t>(d);
+
+        for (int i = 0; i < 8; ++i) t[i] = (t[i] >> 1) | (t[i + 1] << 63);
+        t[8] >>= 1;
+    }
+    return len;
+}
+
+inline uint64_t scalar_bit(const uint64_t k[8], int i) {
+    return (k[i / 64] >> (i % 64)) & 1;
+}
+
+// x-only doubling: X' = (X^2 + 7Z^2)^2 - 8b X Z^3, Z' = 4Z (X (X^2 - 7Z^2) + b Z^3).
+void x_double(Fp512& X, Fp512& Z, const Fp512& b, const Fp512& b8) {
+    Fp512 XX, ZZ, ZZZ, s, t, u;
+    fp_sqr(XX, X);
+    fp_sqr(ZZ, Z);
+    fp_mul(ZZZ, ZZ, Z);
+    fp_mul7(s, ZZ);
+
+    fp_add(t, XX, s);
+    fp_sqr(t, t);
+    fp_mul(u, X, ZZZ);
+    fp_mul(u, u, b8);
+
+    fp_sub(s, XX, s);
+    fp_mul(s, s, X);
+    fp_mul(ZZZ, ZZZ, b);
+    fp_add(s, s, ZZZ);
+    fp_mul(s, s, Z);
+    fp_add(s, s, s);
+    fp_add(Z, s, s);
+    fp_sub(X, t, u);
+}
+
+// x-only differential addition, (X2 : Z2) += (X1 : Z1) where their difference has x = xD:
+// X' = (X1X2 + 7Z1Z2)^2 - 4b Z1Z2 (X1Z2 + X2Z1), Z' = xD (X1Z2 - X2Z1)^2.
+void x_diff_add(Fp512& X2, Fp512& Z2, const Fp512& X1, const Fp512& Z1, const Fp512& xD, const Fp512& b4) {
+    Fp512 xx, zz, xz, zx, s, t;
+    fp_mul(xx, X1, X2);
+    fp_mul(zz, Z1, Z2);
+    fp_mul(xz, X1, Z2);
+    fp_mul(zx, X2, Z1);
+
+    fp_mul7(s, zz);
+    fp_add(s, xx, s);
+    fp_sqr(s, s);
+    fp_add(t, xz, zx);
+    fp_mul(t, t, zz);
+    fp_mul(t, t, b4);
+    fp_sub(X2, s, t);
+
+    fp_sub(t, xz, zx);
+    fp_sqr(t, t);
+    fp_mul(Z2, t, xD);
+}
+}
+
+void ec_mul_base(JacobianPoint& r, const uint64_t k[8]) {
+    std::call_once(base_table_once, build_base_table);
+
+    jac_set_infinity(r);
+    for (int i = 0; i < BASE_WINDOWS; ++i) {
+        unsigned w = static_cast<unsigned>(k[i / 16] >> (BASE_WINDOW_BITS * (i % 16))) & BASE_TABLE_ROW;
+        if (w) jac_add_mixed(r, r, base_table[static_cast<size_t>(i) * BASE_TABLE_ROW + w - 1]);
+    }
+}
+
+void ec_mul_wnaf(JacobianPoint& r, const AffinePoint& P, const uint64_t k[8]) {
+    jac_set_infinity(r);
+    if (P.infinity) return;
+
+    // Odd multiples P, 3P, ..., 15P: a chain of mixed additions of 2P, then one shared inversion.
+    AffinePoint twice = affine_add(P, P);
+    JacobianPoint jac[WNAF_TABLE_SIZE];
+    jac_from_affine(jac[0], P);
+    for (int i = 1; i < WNAF_TABLE_SIZE; ++i) jac_add_mixed(jac[i], jac[i - 1], twice);
+    AffinePoint odd[WNAF_TABLE_SIZE];
+    jac_batch_to_affine(jac, odd, WNAF_TABLE_SIZE);
+
+    int8_t naf[WNAF_MAX_DIGITS];
+    int len = wnaf_recode(naf, k);
+    for (int i = len - 1; i >= 0; --i) {
+        jac_double(r, r);
+        int d = naf[i];
+        if (d > 0) {
+            jac_add_mixed(r, r, odd[(d - 1) / 2]);
+        } else if (d < 0) {
+            AffinePoint neg;
+            affine_neg(neg, odd[(-d - 1) / 2]);
+            jac_add_mixed(r, r, neg);
+        }
+    }
+}
+
+AffinePoint ec_mul_ct(const AffinePoint& P, const uint64_t k[8]) {
+    ProjectivePoint R0, R1;
+    R0.X = fp_zero();
+    R0.Y = fp_one();
+    R0.Z = fp_zero();
+    if (P.infinity) {
+        R1 = R0;
+    } else {
+        R1.X = P.x;
+        R1.Y = P.y;
+        R1.Z = fp_one();
+    }
+
+    // Invariant R1 = R0 + P; swapping on the bit picks which register gets doubled.
+    uint64_t swap = 0;
+    for (int i = 511; i >= 0; --i) {
+        uint64_t bit = scalar_bit(k, i);
+        proj_cswap(R0, R1, swap ^ bit);
+        swap = bit;
+        proj_add_complete(R1, R0, R1);
+        proj_add_complete(R0, R0, R0);
+    }
+    proj_cswap(R0, R1, swap);
+
+    if (fp_is_zero(R0.Z)) return affine_infinity();
+    Fp512 zi;
+    fp_inv(zi, R0.Z);
+    AffinePoint r;
+    fp_mul(r.x, R0.X, zi);
+    fp_mul(r.y, R0.Y, zi);
+    r.infinity = false;
+    return r;
+}
+
+bool ec_ladder_x(Fp512& x, const Fp512& xP, const uint64_t k[8]) {
+    if (fp_is_zero(xP)) return false;
+
+    const Fp512 b = curve_b();
+    Fp512 b4, b8;
+    fp_add(b4, b, b);
+    fp_add(b4, b4, b4);
+    fp_add(b8, b4, b4);
+
+    Fp512 X0 = fp_one(), Z0 = fp_zero();
+    Fp512 X1 = xP, Z1 = fp_one();
+
+    uint64_t swap = 0;
+    for (int i = 511; i >= 0; --i) {
+        uint64_t bit = scalar_bit(k, i);
+        fp_cswap(X0, X1, swap ^ bit);
+        fp_cswap(Z0, Z1, swap ^ bit);
+        swap = bit;
+        x_diff_add(X1, Z1, X0, Z0, xP, b4);
+        x_double(X0, Z0, b, b8);
+    }
+    fp_cswap(X0, X1, swap);
+    fp_cswap(Z0, Z1, swap);
+
+    if (fp_is_zero(Z0)) return false;
+    Fp512 zi;
+    fp_inv(zi, Z0);
+    fp_mul(x, X0, zi);
+    return true;
+}
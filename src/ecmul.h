@@ -0,0 +1,31 @@
+#ifndef ECMUL_H
+#define ECMUL_H
+
+#include "ecpoint.h"
+
+// Scalar multiplication on the internal point types. Scalars are 8 little-endian 64-bit
+// limbs, already reduced mod n by the caller. Both routines branch on the scalar digits
+// and are meant for speed, not for side-channel resistance.
+
+static const int BASE_WINDOW_BITS = 4;
+static const int BASE_WINDOWS = 512 / BASE_WINDOW_BITS;
+static const int WNAF_WIDTH = 5;
+
+// r = k * G from a table of j * 16^i * G (0 <= i < 128, 1 <= j < 16), built on first use:
+// one mixed addition per nonzero nibble and no doublings.
+void ec_mul_base(JacobianPoint& r, const uint64_t k[8]);
+
+// r = k * P in width-5 NAF with the odd multiples P, 3P, ..., 15P precomputed.
+void ec_mul_wnaf(JacobianPoint& r, const AffinePoint& P, const uint64_t k[8]);
+
+// Constant-time paths for secret scalars: always 512 ladder steps, conditional swaps instead
+// of branches on scalar bits, and a Fermat inversion at the end.
+
+// r = k * P with a Montgomery ladder over the complete projective formulas.
+AffinePoint ec_mul_ct(const AffinePoint& P, const uint64_t k[8]);
+
+// x(k * P) from x(P) alone (Brier-Joye x-only ladder with a = -7). Returns false when the
+// result is the point at infinity or x(P) == 0, where the differential addition degenerates.
+bool ec_ladder_x(Fp512& x, const Fp512& xP, const uint64_t k[8]);
+
+#endif
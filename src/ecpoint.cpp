@@ -0,0 +1,314 @@
+#include "ecpoint.h"
+#include <vector>
+
+namespace {
+// a = p - 7 in Montgomery form
+constexpr uint64_t CURVE_A_M[8] = {0x7902819b16fa28a3ULL, 0xc6d5a12ab7c2f343ULL, 0xe65a020bb1d4068fULL, 0x2312c9bf49a06dc0ULL,
+                                   0x9bcb55989e6d0da0ULL, 0x62305b9c28c11826ULL, 0xa83a765568156670ULL, 0x8189de44d93d3f94ULL};
+// b and 3b in Montgomery form
+constexpr uint64_t CURVE_B_M[8] = {0xd3f26f70a23c3473ULL, 0x06ea943ca304a4bdULL, 0x4f3c9c890e4b5f69ULL, 0x18f534dea46953c3ULL,
+                                   0x9abd280fe6c2b4bdULL, 0xc7112e53c4dd9084ULL, 0x207310aa650fbfd0ULL, 0x0fa09cf8f7796808ULL};
+constexpr uint64_t CURVE_B3_M[8] = {0x7bd74e51e6b49d59ULL, 0x14bfbcb5e90dee39ULL, 0xedb5d59b2ae21e3bULL, 0x4adf9e9bed3bfb49ULL,
+                                    0xd037782fb4481e37ULL, 0x55338afb4e98b18dULL, 0x615931ff2f2f3f72ULL, 0x2ee1d6eae66c3818ULL};
+// Generator coordinates in Montgomery form
+constexpr uint64_t CURVE_GX_M[8] = {0x05cd169bbe785470ULL, 0xcf7ad3c8a863b56eULL, 0x436b0bea6b4fa384ULL, 0x6adf72a89d79260eULL,
+                                    0x4b1577910e5c47feULL, 0xbd9a439ceff71760ULL, 0x654d916e0f5494cfULL, 0x0eb46daeacda5b5fULL};
+constexpr uint64_t CURVE_GY_M[8] = {0x593cd8bc053835f0ULL, 0x0e876c63d0e5f850ULL, 0x7b4edf0d46663facULL, 0x3607682a7ee4ba54ULL,
+                                    0xb0bb6c55a2faecb4ULL, 0xef7c13f83d0494b1ULL, 0xd028c247594cd939ULL, 0x66c1d35c57a6d03cULL};
+
+// r = a * t = -7t
+inline void fp_mul_a(Fp512& r, const Fp512& t) {
+    fp_mul7(r, t);
+    fp_neg(r, r);
+}
+}
+
+AffinePoint affine_infinity() {
+    AffinePoint r;
+    r.x = fp_zero();
+    r.y = fp_zero();
+    r.infinity = true;
+    return r;
+}
+
+AffinePoint curve_generator() {
+    AffinePoint g;
+    fp_set(g.x, CURVE_GX_M);
+    fp_set(g.y, CURVE_GY_M);
+    g.infinity = false;
+    return g;
+}
+
+void curve_rhs(Fp512& r, const Fp512& x) {
+    // x^3 - 7x + b = x(x^2 - 7) + b
+    Fp512 t = fp_one(), b;
+    fp_mul7(t, t);
+    fp_sqr(r, x);
+    fp_sub(r, r, t);
+    fp_mul(r, r, x);
+    fp_set(b, CURVE_B_M);
+    fp_add(r, r, b);
+}
+
+bool affine_on_curve(const AffinePoint& P) {
+    if (P.infinity) return true;
+
+    Fp512 lhs, rhs;
+    fp_sqr(lhs, P.y);
+    curve_rhs(rhs, P.x);
+    return fp_equal(lhs, rhs);
+}
+
+bool affine_decompress(AffinePoint& r, const Fp512& x, bool y_odd) {
+    Fp512 rhs, y;
+    curve_rhs(rhs, x);
+    if (!fp_sqrt_vartime(y, rhs)) return false;
+
+    if (fp_is_odd(y) != y_odd) {
+        if (fp_is_zero(y)) return false;
+        fp_neg(y, y);
+    }
+    r.x = x;
+    r.y = y;
+    r.infinity = false;
+    return true;
+}
+
+Fp512 curve_b() {
+    Fp512 b;
+    fp_set(b, CURVE_B_M);
+    return b;
+}
+
+AffinePoint affine_add(const AffinePoint& P, const AffinePoint& Q) {
+    if (P.infinity) return Q;
+    if (Q.infinity) return P;
+
+    Fp512 num, den, inv, lambda, t;
+    if (fp_equal(P.x, Q.x)) {
+        if (!fp_equal(P.y, Q.y) || fp_is_zero(P.y)) return affine_infinity();
+        // lambda = (3x^2 + a) / 2y
+        fp_sqr(t, P.x);
+        fp_add(num, t, t);
+        fp_add(num, num, t);
+        fp_set(t, CURVE_A_M);
+        fp_add(num, num, t);
+        fp_add(den, P.y, P.y);
+    } else {
+        fp_sub(num, Q.y, P.y);
+        fp_sub(den, Q.x, P.x);
+    }
+    if (!fp_inv_vartime(inv, den)) return affine_infinity();
+    fp_mul(lambda, num, inv);
+
+    AffinePoint R;
+    R.infinity = false;
+    fp_sqr(t, lambda);
+    fp_sub(t, t, P.x);
+    fp_sub(R.x, t, Q.x);
+    fp_sub(t, P.x, R.x);
+    fp_mul(t, lambda, t);
+    fp_sub(R.y, t, P.y);
+    return R;
+}
+
+void jac_set_infinity(JacobianPoint& r) {
+    r.X = fp_one();
+    r.Y = fp_one();
+    r.Z = fp_zero();
+}
+
+void jac_from_affine(JacobianPoint& r, const AffinePoint& P) {
+    if (P.infinity) {
+        jac_set_infinity(r);
+        return;
+    }
+    r.X = P.x;
+    r.Y = P.y;
+    r.Z = fp_one();
+}
+
+void jac_double(JacobianPoint& r, const JacobianPoint& P) {
+    Fp512 XX, YY, YYYY, ZZ, S, M, T, t;
+
+    fp_sqr(XX, P.X);
+    fp_sqr(YY, P.Y);
+    fp_sqr(YYYY, YY);
+    fp_sqr(ZZ, P.Z);
+
+    // S = 2((X + YY)^2 - XX - YYYY)
+    fp_add(t, P.X, YY);
+    fp_sqr(t, t);
+    fp_sub(t, t, XX);
+    fp_sub(t, t, YYYY);
+    fp_add(S, t, t);
+
+    // M = 3XX + a ZZ^2 = 3XX - 7ZZ^2
+    fp_add(M, XX, XX);
+    fp_add(M, M, XX);
+    fp_sqr(t, ZZ);
+    fp_mul7(t, t);
+    fp_sub(M, M, t);
+
+    // Z3 = (Y + Z)^2 - YY - ZZ (computed before X/Y are overwritten when r aliases P)
+    fp_add(t, P.Y, P.Z);
+    fp_sqr(t, t);
+    fp_sub(t, t, YY);
+    fp_sub(r.Z, t, ZZ);
+
+    // X3 = M^2 - 2S
+    fp_sqr(T, M);
+    fp_sub(T, T, S);
+    fp_sub(T, T, S);
+
+    // Y3 = M(S - X3) - 8YYYY
+    fp_sub(t, S, T);
+    fp_mul(t, M, t);
+    fp_add(YYYY, YYYY, YYYY);
+    fp_add(YYYY, YYYY, YYYY);
+    fp_add(YYYY, YYYY, YYYY);
+    fp_sub(r.Y, t, YYYY);
+    r.X = T;
+}
+
+void jac_add_mixed(JacobianPoint& r, const JacobianPoint& P, const AffinePoint& Q) {
+    if (Q.infinity) {
+        r = P;
+        return;
+    }
+    if (jac_is_infinity(P)) {
+        jac_from_affine(r, Q);
+        return;
+    }
+
+    Fp512 Z1Z1, U2, S2, H, HH, I, J, R, V, t;
+
+    fp_sqr(Z1Z1, P.Z);
+    fp_mul(U2, Q.x, Z1Z1);
+    fp_mul(S2, Q.y, P.Z);
+    fp_mul(S2, S2, Z1Z1);
+    fp_sub(H, U2, P.X);
+    fp_sub(R, S2, P.Y);
+    fp_add(R, R, R);
+
+    if (fp_is_zero(H)) {
+        if (fp_is_zero(R)) {
+            jac_double(r, P);
+        } else {
+            jac_set_infinity(r);
+        }
+        return;
+    }
+
+    fp_sqr(HH, H);
+    fp_add(I, HH, HH);
+    fp_add(I, I, I);
+    fp_mul(J, H, I);
+    fp_mul(V, P.X, I);
+
+    // Z3 = (Z1 + H)^2 - Z1Z1 - HH
+    fp_add(t, P.Z, H);
+    fp_sqr(t, t);
+    fp_sub(t, t, Z1Z1);
+    fp_sub(r.Z, t, HH);
+
+    // Y3 needs Y1 before it is overwritten: keep 2 Y1 J aside.
+    Fp512 YJ;
+    fp_mul(YJ, P.Y, J);
+    fp_add(YJ, YJ, YJ);
+
+    // X3 = R^2 - J - 2V
+    fp_sqr(t, R);
+    fp_sub(t, t, J);
+    fp_sub(t, t, V);
+    fp_sub(r.X, t, V);
+
+    // Y3 = R(V - X3) - 2 Y1 J
+    fp_sub(t, V, r.X);
+    fp_mul(t, R, t);
+    fp_sub(r.Y, t, YJ);
+}
+
+void proj_add_complete(ProjectivePoint& r, const ProjectivePoint& P, const ProjectivePoint& Q) {
+    Fp512 t0, t1, t2, t3, t4, t5, X3, Y3, Z3, b3;
+    fp_set(b3, CURVE_B3_M);
+
+    fp_mul(t0, P.X, Q.X);
+    fp_mul(t1, P.Y, Q.Y);
+    fp_mul(t2, P.Z, Q.Z);
+    fp_add(t3, P.X, P.Y);
+    fp_add(t4, Q.X, Q.Y);
+    fp_mul(t3, t3, t4);
+    fp_add(t4, t0, t1);
+    fp_sub(t3, t3, t4);
+    fp_add(t4, P.X, P.Z);
+    fp_add(t5, Q.X, Q.Z);
+    fp_mul(t4, t4, t5);
+    fp_add(t5, t0, t2);
+    fp_sub(t4, t4, t5);
+    fp_add(t5, P.Y, P.Z);
+    fp_add(X3, Q.Y, Q.Z);
+    fp_mul(t5, t5, X3);
+    fp_add(X3, t1, t2);
+    fp_sub(t5, t5, X3);
+    fp_mul_a(Z3, t4);
+    fp_mul(X3, b3, t2);
+    fp_add(Z3, X3, Z3);
+    fp_sub(X3, t1, Z3);
+    fp_add(Z3, t1, Z3);
+    fp_mul(Y3, X3, Z3);
+    fp_add(t1, t0, t0);
+    fp_add(t1, t1, t0);
+    fp_mul_a(t2, t2);
+    fp_mul(t4, b3, t4);
+    fp_add(t1, t1, t2);
+    fp_sub(t2, t0, t2);
+    fp_mul_a(t2, t2);
+    fp_add(t4, t4, t2);
+    fp_mul(t0, t1, t4);
+    fp_add(Y3, Y3, t0);
+    fp_mul(t0, t5, t4);
+    fp_mul(X3, t3, X3);
+    fp_sub(X3, X3, t0);
+    fp_mul(t0, t3, t1);
+    fp_mul(Z3, t5, Z3);
+    fp_add(Z3, Z3, t0);
+
+    r.X = X3;
+    r.Y = Y3;
+    r.Z = Z3;
+}
+
+AffinePoint jac_to_affine(const JacobianPoint& P) {
+    if (jac_is_infinity(P)) return affine_infinity();
+
+    Fp512 zi, zi2, zi3;
+    fp_inv_vartime(zi, P.Z);
+    fp_sqr(zi2, zi);
+    fp_mul(zi3, zi2, zi);
+
+    AffinePoint r;
+    r.infinity = false;
+    fp_mul(r.x, P.X, zi2);
+    fp_mul(r.y, P.Y, zi3);
+    return r;
+}
+
+void jac_batch_to_affine(const JacobianPoint* in, AffinePoint* out, size_t n) {
+    std::vector<Fp512> zi(n);
+    for (size_t i = 0; i < n; ++i) zi[i] = in[i].Z;
+    fp_batch_inv_vartime(zi.data(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (jac_is_infinity(in[i])) {
+            out[i] = affine_infinity();
+            continue;
+        }
+        Fp512 zi2, zi3;
+        fp_sqr(zi2, zi[i]);
+        fp_mul(zi3, zi2, zi[i]);
+        fp_mul(out[i].x, in[i].X, zi2);
+        fp_mul(out[i].y, in[i].Y, zi3);
+        out[i].infinity = false;
+    }
+}
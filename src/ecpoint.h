@@ -0,0 +1,95 @@
+#ifndef ECPOINT_H
+#define ECPOINT_H
+
+#include "fp512.h"
+
+// Internal point arithmetic for ECCFrog512CK2 (y^2 = x^3 - 7x + b) on top of Fp512.
+// The public API keeps ECCFrog512CK2::Point (affine, mpz_class); these types are what
+// the scalar multiplication routines actually run on.
+
+namespace ecc_const {
+// Group order n
+static constexpr uint64_t N[8] = {0x4392fcb2cc01ef87ULL, 0x2bf8a9c3cb7bdc2aULL, 0x41e2a2cf144534c4ULL, 0xd942f0dddae61b06ULL,
+                                  0xc8584d9982c41881ULL, 0x4ebe93f6ec6ea51aULL, 0x3dd6c4f07dd36667ULL, 0xaeaf714c13bfbff6ULL};
+}
+
+struct AffinePoint {
+    Fp512 x, y;
+    bool infinity;
+};
+
+// Jacobian coordinates: (X, Y, Z) represents (X / Z^2, Y / Z^3). Z == 0 is the point at infinity.
+struct JacobianPoint {
+    Fp512 X, Y, Z;
+};
+
+// Homogeneous projective coordinates: (X, Y, Z) represents (X / Z, Y / Z); (0, 1, 0) is the
+// point at infinity. Used with the complete formulas, which need no special cases.
+struct ProjectivePoint {
+    Fp512 X, Y, Z;
+};
+
+AffinePoint affine_infinity();
+
+// r = x^3 - 7x + b
+void curve_rhs(Fp512& r, const Fp512& x);
+
+// y^2 == x^3 - 7x + b
+bool affine_on_curve(const AffinePoint& P);
+
+// Recovers y with the requested parity; false if x^3 - 7x + b is not a square
+// (or y == 0 and an odd y was asked for).
+bool affine_decompress(AffinePoint& r, const Fp512& x, bool y_odd);
+
+// The generator G and the coefficient b in Montgomery form.
+AffinePoint curve_generator();
+Fp512 curve_b();
+
+// r = 7a as 8a - a: three additions and a subtraction instead of a multiplication.
+inline void fp_mul7(Fp512& r, const Fp512& a) {
+    Fp512 t;
+    fp_add(t, a, a);
+    fp_add(t, t, t);
+    fp_add(t, t, t);
+    fp_sub(r, t, a);
+}
+
+inline void affine_neg(AffinePoint& r, const AffinePoint& P) {
+    r.x = P.x;
+    fp_neg(r.y, P.y);
+    r.infinity = P.infinity;
+}
+
+// Affine addition/doubling; costs one field inversion.
+AffinePoint affine_add(const AffinePoint& P, const AffinePoint& Q);
+
+void jac_set_infinity(JacobianPoint& r);
+void jac_from_affine(JacobianPoint& r, const AffinePoint& P);
+
+inline bool jac_is_infinity(const JacobianPoint& P) {
+    return fp_is_zero(P.Z);
+}
+
+// r = 2P (dbl-2007-bl with a = -7 folded into additions: 1M + 8S). r may alias P.
+void jac_double(JacobianPoint& r, const JacobianPoint& P);
+
+// r = P + Q with Q affine (madd-2007-bl: 7M + 4S). r may alias P.
+void jac_add_mixed(JacobianPoint& r, const JacobianPoint& P, const AffinePoint& Q);
+
+// Back to affine with a single inversion.
+AffinePoint jac_to_affine(const JacobianPoint& P);
+
+// r = P + Q for any inputs, including P == Q and the point at infinity (Renes-Costello-Batina
+// complete addition, algorithm 1: 12M + 2 multiplications by 3b). Branch-free; r may alias P or Q.
+void proj_add_complete(ProjectivePoint& r, const ProjectivePoint& P, const ProjectivePoint& Q);
+
+inline void proj_cswap(ProjectivePoint& P, ProjectivePoint& Q, uint64_t flag) {
+    fp_cswap(P.X, Q.X, flag);
+    fp_cswap(P.Y, Q.Y, flag);
+    fp_cswap(P.Z, Q.Z, flag);
+}
+
+// Normalises n points sharing one inversion (Montgomery's trick).
+void jac_batch_to_affine(const JacobianPoint* in, AffinePoint* out, size_t n);
+
+#endif
@@ -1,40 +1,59 @@
 #include "encrypt.h"
 #include "eccfrog512ck2.h"
+#include "format.h"
+#include "stream.h"
+#include "keyslot.h"
+#include "memory_pool.h"
 #include <sodium.h>
-#include <fstream>
 #include <vector>
 #include <cstring>
+#include <filesystem>
+
+bool encrypt_stream(InputSource& in, OutputSink& out, const std::string& password,
+                    const CryptoOptions& options) {
+    // Os segmentos usam uma DEK aleatória; a senha só embrulha a DEK em um keyslot,
+    // então trocar a senha reescreve apenas o header. No modo de chave pública, cada
+    // destinatário ganha um slot e a senha só entra se tiver sido informada.
+    FileHeader hdr;
+    if (!init_file_header(hdr, password, options)) return false;
+
+    // Saídas que permitem voltar ao header ganham o índice do fluxo (leitura aleatória):
+    // o espaço é reservado agora e o conteúdo selado quando o último segmento sai. Nos
+    // comprimidos, a tabela de segmentos depois do último dá a posição de cada um.
+    if (out.can_rewrite()) {
+        if (hdr.flags & FLAG_COMPRESSED) hdr.flags |= FLAG_SEGMENT_TABLE;
+        hdr.index.assign(segment_index_bytes(hdr), 0);
+    }
+
+    SecretBlock key;   // DEK em memória travada, zerada ao sair (memory_pool.h)
+    if (!seal_file_header(hdr, password, options, key.data())) return false;
+
+    std::vector<unsigned char> header = serialize_header(hdr);
+    if (header.empty() || !out.write(header.data(), header.size())) return false;
+
+    StreamTotals totals;
+    if (!seal_stream(in, out, hdr, key.data(), options, &totals)) return false;
+    if (!hdr.index.empty()) {
+        bool indexed = seal_segment_index(hdr, key.data(), totals);
+        header = serialize_header(hdr);
+        if (!indexed || header.empty() || !out.rewrite(0, header.data(), header.size())) return false;
+    }
+    return out.finish();
+}
 
-bool encrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password) {
-    std::ifstream in(input_file, std::ios::binary);
+bool encrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password,
+                  const CryptoOptions& options) {
+    std::unique_ptr<InputSource> in = open_input(input_file, options.io);
     if (!in) return false;
 
-    std::vector<unsigned char> plaintext((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-
-    // ECCFrog512CK2 não usado diretamente aqui — removido o uso da chave
-    unsigned char salt[crypto_pwhash_SALTBYTES];
-    randombytes_buf(salt, sizeof(salt));
-
-    unsigned char key[crypto_aead_aes256gcm_KEYBYTES];
-    if (crypto_pwhash(key, sizeof(key), password.c_str(), password.size(), salt,
-                      crypto_pwhash_OPSLIMIT_MODERATE, crypto_pwhash_MEMLIMIT_MODERATE, crypto_pwhash_ALG_DEFAULT) != 0)
-        return false;
-
-    unsigned char nonce[crypto_aead_aes256gcm_NPUBBYTES];
-    randombytes_buf(nonce, sizeof(nonce));
-
-    std::vector<unsigned char> ciphertext(plaintext.size() + crypto_aead_aes256gcm_ABYTES);
-    unsigned long long clen;
-
-    if (crypto_aead_aes256gcm_encrypt(ciphertext.data(), &clen, plaintext.data(), plaintext.size(), NULL, 0, NULL, nonce, key) != 0)
-        return false;
-
-    std::ofstream out(output_file, std::ios::binary);
+    std::unique_ptr<OutputSink> out = open_output(output_file, options.io);
     if (!out) return false;
 
-    out.write(reinterpret_cast<const char*>(salt), sizeof(salt));
-    out.write(reinterpret_cast<const char*>(nonce), sizeof(nonce));
-    out.write(reinterpret_cast<const char*>(ciphertext.data()), clen);
-
+    if (!encrypt_stream(*in, *out, password, options)) {
+        out.reset();
+        std::error_code ec;
+        std::filesystem::remove(output_file, ec);
+        return false;
+    }
     return true;
 }
@@ -3,9 +3,17 @@
 
 #include <string>
 #include "eccfrog512ck2.h"
+#include "io_backend.h"
+#include "options.h"
 
 // Criptografa o arquivo de entrada e salva em saída utilizando a senha para derivar a chave.
 // A função espera que a derivação de chave (via Argon2ID) e os cálculos com a curva elíptica sejam feitos internamente.
-bool encrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password);
+// Os segmentos são selados em paralelo conforme options.threads; a saída é idêntica para qualquer valor.
+bool encrypt_file(const std::string& input_file, const std::string& output_file, const std::string& password,
+                  const CryptoOptions& options = CryptoOptions());
+
+// Mesma operação sobre fontes/destinos já abertos (stdin/stdout, por exemplo).
+bool encrypt_stream(InputSource& in, OutputSink& out, const std::string& password,
+                    const CryptoOptions& options = CryptoOptions());
 
 #endif
@@ -0,0 +1,201 @@
+#include "format.h"
+#include <cstring>
+
+static void put_u16(std::vector<unsigned char>& out, uint16_t v) {
+    out.push_back(static_cast<unsigned char>(v));
+    out.push_back(static_cast<unsigned char>(v >> 8));
+}
+
+static uint16_t get_u16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void put_u32(std::vector<unsigned char>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+}
+
+static void put_record(std::vector<unsigned char>& out, uint8_t tag, const unsigned char* value, uint16_t len) {
+    out.push_back(tag);
+    put_u16(out, len);
+    out.insert(out.end(), value, value + len);
+}
+
+static void put_records(std::vector<unsigned char>& out, const FileHeader& hdr) {
+    if (hdr.slots.empty()) {
+        put_record(out, TAG_KDF_SALT, hdr.salt, sizeof(hdr.salt));
+        if (hdr.has_file_id) put_record(out, TAG_FILE_ID, hdr.file_id, sizeof(hdr.file_id));
+    }
+    if (hdr.has_ephemeral) put_record(out, TAG_EPHEMERAL_KEY, hdr.ephemeral, sizeof(hdr.ephemeral));
+    if (!hdr.index.empty())
+        put_record(out, TAG_SEGMENT_INDEX, hdr.index.data(), static_cast<uint16_t>(hdr.index.size()));
+    if (hdr.has_container_index)
+        put_record(out, TAG_CONTAINER_INDEX, hdr.container_index, sizeof(hdr.container_index));
+    for (const KeySlot& slot : hdr.slots) {
+        std::vector<unsigned char> v;
+        v.push_back(slot.kind);
+        v.push_back(slot.has_file_id ? 1 : 0);
+        v.insert(v.end(), slot.salt, slot.salt + sizeof(slot.salt));
+        v.insert(v.end(), slot.file_id, slot.file_id + sizeof(slot.file_id));
+        v.insert(v.end(), slot.nonce, slot.nonce + sizeof(slot.nonce));
+        v.insert(v.end(), slot.wrapped, slot.wrapped + sizeof(slot.wrapped));
+        if (slot.kind == KEYSLOT_PASSWORD) {
+            v.push_back(slot.kdf.alg);
+            put_u32(v, slot.kdf.opslimit);
+            put_u32(v, static_cast<uint32_t>(slot.kdf.memlimit >> 10));
+        }
+        put_record(out, TAG_KEYSLOT, v.data(), static_cast<uint16_t>(v.size()));
+    }
+}
+
+static void write_core(const FileHeader& hdr, unsigned char* c) {
+    std::memcpy(c, FORMAT_MAGIC, sizeof(FORMAT_MAGIC));
+    c[4] = hdr.version;
+    c[5] = hdr.flags;
+    c[6] = static_cast<unsigned char>(hdr.header_len);
+    c[7] = static_cast<unsigned char>(hdr.header_len >> 8);
+    c[8] = static_cast<unsigned char>(hdr.segment_size);
+    c[9] = static_cast<unsigned char>(hdr.segment_size >> 8);
+    c[10] = static_cast<unsigned char>(hdr.segment_size >> 16);
+    c[11] = static_cast<unsigned char>(hdr.segment_size >> 24);
+    std::memcpy(c + 12, hdr.nonce_prefix, NONCE_PREFIX_BYTES);
+    c[19] = hdr.cipher;
+}
+
+bool prepare_header(FileHeader& hdr) {
+    if (hdr.header_len == 0) {
+        std::vector<unsigned char> records;
+        put_records(records, hdr);
+        size_t len = HEADER_CORE_BYTES + records.size() + KEYSLOT_RESERVE * KEYSLOT_RECORD_BYTES;
+        if (len > 0xFFFF) return false;
+        hdr.header_len = static_cast<uint16_t>(len);
+    }
+    write_core(hdr, hdr.core);
+    return true;
+}
+
+std::vector<unsigned char> serialize_header(const FileHeader& hdr) {
+    std::vector<unsigned char> out(HEADER_CORE_BYTES, 0);
+    put_records(out, hdr);
+    if (out.size() > hdr.header_len) return std::vector<unsigned char>();
+
+    // O restante até header_len é preenchimento (tag 0), reservado para novos keyslots.
+    out.resize(hdr.header_len, 0);
+    write_core(hdr, out.data());
+    return out;
+}
+
+bool is_stream_format(const unsigned char* data, size_t len) {
+    return len >= HEADER_CORE_BYTES &&
+           std::memcmp(data, FORMAT_MAGIC, sizeof(FORMAT_MAGIC)) == 0 &&
+           data[4] == FORMAT_VERSION;
+}
+
+bool parse_header_core(const unsigned char* data, size_t len, FileHeader& hdr) {
+    if (!is_stream_format(data, len)) return false;
+
+    hdr.version = data[4];
+    hdr.flags = data[5];
+    hdr.cipher = data[19];
+    hdr.header_len = get_u16(data + 6);
+    hdr.segment_size = get_u32(data + 8);
+    std::memcpy(hdr.nonce_prefix, data + 12, NONCE_PREFIX_BYTES);
+    std::memcpy(hdr.core, data, HEADER_CORE_BYTES);
+
+    if (hdr.header_len < HEADER_CORE_BYTES) return false;
+    if (hdr.segment_size == 0 || hdr.segment_size > MAX_SEGMENT_SIZE) return false;
+    return true;
+}
+
+bool parse_header_records(const unsigned char* data, size_t len, FileHeader& hdr) {
+    bool have_salt = false;
+    size_t password_slots = 0;
+    size_t pos = 0;
+
+    while (pos < len) {
+        uint8_t tag = data[pos];
+        if (tag == TAG_PADDING) break;
+        if (len - pos < 3) return false;
+
+        uint16_t rlen = get_u16(data + pos + 1);
+        pos += 3;
+        if (len - pos < rlen) return false;
+        const unsigned char* value = data + pos;
+
+        switch (tag) {
+        case TAG_KDF_SALT:
+            if (rlen != sizeof(hdr.salt)) return false;
+            std::memcpy(hdr.salt, value, rlen);
+            have_salt = true;
+            break;
+        case TAG_FILE_ID:
+            if (rlen != sizeof(hdr.file_id)) return false;
+            std::memcpy(hdr.file_id, value, rlen);
+            hdr.has_file_id = true;
+            break;
+        case TAG_EPHEMERAL_KEY:
+            if (rlen != sizeof(hdr.ephemeral)) return false;
+            std::memcpy(hdr.ephemeral, value, rlen);
+            hdr.has_ephemeral = true;
+            break;
+        case TAG_SEGMENT_INDEX:
+            hdr.index.assign(value, value + rlen);
+            break;
+        case TAG_CONTAINER_INDEX:
+            if (rlen != sizeof(hdr.container_index)) return false;
+            std::memcpy(hdr.container_index, value, rlen);
+            hdr.has_container_index = true;
+            break;
+        case TAG_KEYSLOT: {
+            if (rlen != KEYSLOT_BASE_RECORD_BYTES - 3 && rlen != KEYSLOT_RECORD_BYTES - 3) return false;
+            KeySlot slot;
+            const unsigned char* v = value;
+            slot.kind = *v++;
+            slot.has_file_id = *v++ != 0;
+            std::memcpy(slot.salt, v, sizeof(slot.salt));
+            v += sizeof(slot.salt);
+            std::memcpy(slot.file_id, v, sizeof(slot.file_id));
+            v += sizeof(slot.file_id);
+            std::memcpy(slot.nonce, v, sizeof(slot.nonce));
+            v += sizeof(slot.nonce);
+            std::memcpy(slot.wrapped, v, sizeof(slot.wrapped));
+            v += sizeof(slot.wrapped);
+            if (rlen == KEYSLOT_RECORD_BYTES - 3) {
+                slot.kdf.alg = v[0];
+                slot.kdf.opslimit = get_u32(v + 1);
+                slot.kdf.memlimit = static_cast<uint64_t>(get_u32(v + 5)) << 10;
+            }
+            // Parâmetros fora dos limites ficam no slot: unlock_header os recusa sem derivar.
+            if (slot.kind == KEYSLOT_PASSWORD && ++password_slots > MAX_PASSWORD_SLOTS) return false;
+            hdr.slots.push_back(slot);
+            break;
+        }
+        default:
+            // Registros desconhecidos são ignorados para permitir extensões compatíveis.
+            break;
+        }
+        pos += rlen;
+    }
+    return have_salt || !hdr.slots.empty();
+}
+
+bool kdf_params_valid(const KdfParams& params) {
+    return params.alg == KDF_ARGON2ID13 &&
+           params.opslimit >= crypto_pwhash_OPSLIMIT_MIN && params.opslimit <= KDF_MAX_OPSLIMIT &&
+           params.memlimit >= crypto_pwhash_MEMLIMIT_MIN && params.memlimit <= KDF_MAX_MEMLIMIT &&
+           params.memlimit % 1024 == 0;
+}
+
+void segment_nonce(const FileHeader& hdr, uint32_t index, bool last,
+                   unsigned char nonce[SEGMENT_NONCE_BYTES]) {
+    std::memcpy(nonce, hdr.nonce_prefix, NONCE_PREFIX_BYTES);
+    nonce[7] = static_cast<unsigned char>(index >> 24);
+    nonce[8] = static_cast<unsigned char>(index >> 16);
+    nonce[9] = static_cast<unsigned char>(index >> 8);
+    nonce[10] = static_cast<unsigned char>(index);
+    nonce[11] = last ? 1 : 0;
+}
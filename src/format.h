@@ -0,0 +1,165 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <sodium.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Formato .ecc versão 2 (streaming):
+//
+//   [núcleo fixo de 20 bytes][registros TLV até header_len][segmento 0][segmento 1]...
+//
+// Núcleo: "CFRG" | versão (1) | flags (1) | header_len (u16 LE) | segment_size (u32 LE)
+//         | nonce_prefix (7) | suíte de cifra (1, ver aead.h; 0 = AES-256-GCM)
+//
+// Cada segmento é o texto claro de até segment_size bytes selado com a suíte do header
+// (ciphertext || tag). O nonce de cada segmento é nonce_prefix || contador (u32 BE)
+// || flag de último segmento, e o núcleo do header entra como dado associado. Isso
+// impede reordenar, duplicar ou truncar segmentos sem que a autenticação falhe.
+//
+// Arquivos antigos (salt | nonce | ciphertext) não têm o magic e seguem pelo caminho legado.
+
+static const unsigned char FORMAT_MAGIC[4] = {'C', 'F', 'R', 'G'};
+static const uint8_t FORMAT_VERSION = 2;
+
+static const size_t HEADER_CORE_BYTES = 20;
+static const size_t NONCE_PREFIX_BYTES = 7;
+static const size_t SEGMENT_NONCE_BYTES = 12;
+static const size_t FILE_ID_BYTES = 16;
+static const size_t DEK_BYTES = crypto_aead_aes256gcm_KEYBYTES;
+static const size_t KEYSLOT_NONCE_BYTES = crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+static const size_t KEYSLOT_WRAPPED_BYTES = DEK_BYTES + crypto_aead_xchacha20poly1305_ietf_ABYTES;
+
+// Espaço livre deixado no header para novos keyslots, permitindo rekey no próprio arquivo.
+static const size_t KEYSLOT_RESERVE = 3;
+// Slots de senha aceitos por header: o da criação mais os que cabem na reserva. Cada um pode
+// custar um Argon2 no teto da KDF, e um header forjado não deve exigir mais que isso.
+static const size_t MAX_PASSWORD_SLOTS = 1 + KEYSLOT_RESERVE;
+static const uint32_t DEFAULT_SEGMENT_SIZE = 64 * 1024;
+static const uint32_t MAX_SEGMENT_SIZE = 16 * 1024 * 1024;
+static const uint64_t MAX_SEGMENTS = 0xFFFFFFFFULL;
+
+// Bits de flags do núcleo.
+static const uint8_t FLAG_CONTAINER = 0x01;   // contêiner de vários arquivos (ver container.h)
+static const uint8_t FLAG_COMPRESSED = 0x02;  // segmentos com prefixo de tamanho e modo LZ4/cru (ver compress.h)
+static const uint8_t FLAG_SEGMENT_TABLE = 0x04; // comprimido com tabela de segmentos após o último (ver stream.h)
+
+// Tags dos registros TLV (tag u8 | len u16 LE | valor). Tag 0 é preenchimento e encerra a leitura.
+enum HeaderTag : uint8_t {
+    TAG_PADDING = 0x00,
+    TAG_KDF_SALT = 0x01,
+    TAG_FILE_ID = 0x02,     // arquivo de um lote: chave = BLAKE2b(Argon2(salt), file_id)
+    TAG_KEYSLOT = 0x03,     // chave de dados embrulhada, com os parâmetros da KDF (repetível)
+    TAG_EPHEMERAL_KEY = 0x04,   // ponto efêmero E = e·G (comprimido) dos slots de destinatário
+    TAG_SEGMENT_INDEX = 0x05,   // totais do fluxo selados com a DEK (ver stream.h)
+    TAG_CONTAINER_INDEX = 0x06, // id, posição e tamanho do índice cifrado de um contêiner
+};
+
+enum KeySlotKind : uint8_t {
+    KEYSLOT_PASSWORD = 0x01,
+    KEYSLOT_RECIPIENT = 0x02,   // salt guarda o id do destinatário (ver recipient.h)
+};
+
+// index_id (16) | offset (u64 LE) | length (u64 LE)
+static const size_t CONTAINER_POINTER_BYTES = 32;
+
+// Ponto comprimido de ECCFrog512CK2: 0x02/0x03 || x (64 bytes).
+static const size_t EPHEMERAL_KEY_BYTES = 65;
+
+// Algoritmos de derivação de senha gravados nos keyslots.
+enum KdfAlg : uint8_t {
+    KDF_ARGON2ID13 = 0x01,   // crypto_pwhash_ALG_ARGON2ID13
+};
+
+// Parâmetros do Argon2 de um keyslot de senha. Os valores padrão são os que eram fixos no
+// código; slots gravados antes deste campo (e headers sem slots) usam exatamente eles.
+struct KdfParams {
+    uint8_t alg = KDF_ARGON2ID13;
+    uint32_t opslimit = crypto_pwhash_OPSLIMIT_MODERATE;
+    uint64_t memlimit = crypto_pwhash_MEMLIMIT_MODERATE;   // bytes; gravado em KiB
+};
+
+// alg (1) | opslimit (u32 LE) | memlimit em KiB (u32 LE)
+static const size_t KDF_PARAMS_BYTES = 9;
+
+// Limites aceitos num header: um arquivo adulterado não pode pedir um Argon2 sem fim nem
+// mais memória do que faz sentido reservar.
+static const uint32_t KDF_MAX_OPSLIMIT = 64;
+static const uint64_t KDF_MAX_MEMLIMIT = 4ULL << 30;
+
+// Algoritmo conhecido, limites dentro do intervalo do libsodium e dos máximos acima,
+// memória em KiB inteiros.
+bool kdf_params_valid(const KdfParams& params);
+
+// Chave de dados (DEK) do arquivo embrulhada com XChaCha20-Poly1305 por uma chave
+// derivada da senha ou de um acordo de chaves com um destinatário (KEK). O núcleo do
+// header é o dado associado do embrulho.
+//   kind (1) | flags (1) | salt (16) | file_id (16) | nonce (24) | DEK embrulhada (48)
+//   | parâmetros da KDF (9, só em slots de senha)
+// Slots de senha sem os parâmetros (arquivos anteriores) usam KdfParams padrão.
+struct KeySlot {
+    uint8_t kind = KEYSLOT_PASSWORD;
+    bool has_file_id = false;
+    unsigned char salt[crypto_pwhash_SALTBYTES] = {0};
+    unsigned char file_id[FILE_ID_BYTES] = {0};
+    unsigned char nonce[KEYSLOT_NONCE_BYTES] = {0};
+    unsigned char wrapped[KEYSLOT_WRAPPED_BYTES] = {0};
+    KdfParams kdf;
+};
+
+static const size_t KEYSLOT_BASE_RECORD_BYTES = 3 + 2 + crypto_pwhash_SALTBYTES + FILE_ID_BYTES +
+                                                KEYSLOT_NONCE_BYTES + KEYSLOT_WRAPPED_BYTES;
+static const size_t KEYSLOT_RECORD_BYTES = KEYSLOT_BASE_RECORD_BYTES + KDF_PARAMS_BYTES;
+
+struct FileHeader {
+    uint8_t version = FORMAT_VERSION;
+    uint8_t flags = 0;
+    uint8_t cipher = 0;   // CipherSuite
+    uint32_t segment_size = DEFAULT_SEGMENT_SIZE;
+    unsigned char nonce_prefix[NONCE_PREFIX_BYTES] = {0};
+    unsigned char salt[crypto_pwhash_SALTBYTES] = {0};
+    bool has_file_id = false;
+    unsigned char file_id[FILE_ID_BYTES] = {0};
+    bool has_ephemeral = false;
+    unsigned char ephemeral[EPHEMERAL_KEY_BYTES] = {0};
+
+    // Índice selado (número de segmentos e bytes de texto claro). A cifragem reserva o
+    // espaço e o preenche quando o fluxo termina; vazio quando a saída não permite voltar
+    // ao header (stdout) e em arquivos anteriores.
+    std::vector<unsigned char> index;
+
+    // Contêineres: onde está o índice atual. Reescrito no lugar a cada inclusão de arquivos.
+    bool has_container_index = false;
+    unsigned char container_index[CONTAINER_POINTER_BYTES] = {0};
+
+    // Arquivos com keyslots cifram os segmentos com uma DEK aleatória; sem eles
+    // (primeiros arquivos v2), a chave vem direto de salt/file_id acima.
+    std::vector<KeySlot> slots;
+
+    // Bytes do núcleo serializado; usados como dado associado de todos os segmentos.
+    unsigned char core[HEADER_CORE_BYTES] = {0};
+    uint16_t header_len = 0;
+};
+
+// Fixa header_len (se ainda 0: registros atuais + KEYSLOT_RESERVE slots livres) e o núcleo.
+// Deve ser chamada antes de embrulhar keyslots, que autenticam o núcleo.
+bool prepare_header(FileHeader& hdr);
+
+// Serializa o header em exatamente header_len bytes; vazio se os registros não cabem.
+std::vector<unsigned char> serialize_header(const FileHeader& hdr);
+
+// Verifica se os primeiros bytes do arquivo pertencem ao formato streaming.
+bool is_stream_format(const unsigned char* data, size_t len);
+
+// Interpreta o núcleo; retorna header_len através de hdr.
+bool parse_header_core(const unsigned char* data, size_t len, FileHeader& hdr);
+
+// Interpreta os registros TLV que seguem o núcleo (len = header_len - HEADER_CORE_BYTES).
+bool parse_header_records(const unsigned char* data, size_t len, FileHeader& hdr);
+
+// Nonce do segmento `index`; `last` marca o segmento final do fluxo.
+void segment_nonce(const FileHeader& hdr, uint32_t index, bool last,
+                   unsigned char nonce[SEGMENT_NONCE_BYTES]);
+
+#endif
@@ -0,0 +1,182 @@
+#include "fp512.h"
+#include <gmp.h>
+#include <vector>
+
+namespace {
+// p - 2 (Fermat inversion exponent)
+constexpr uint64_t P_MINUS_2[8] = {0xdc74976b30a260c7ULL, 0xfacd9a49b39d5beeULL, 0x2c36ba5e27705dafULL, 0xebea6f6e7b0e959dULL,
+                                   0xc8584d9982c41882ULL, 0x4ebe93f6ec6ea51aULL, 0x3dd6c4f07dd36667ULL, 0xaeaf714c13bfbff6ULL};
+// p - 1 = q * 2^3; (q - 1) / 2
+constexpr uint64_t SQRT_Q_HALF[8] = {0xedc74976b30a260cULL, 0xffacd9a49b39d5beULL, 0xd2c36ba5e27705daULL, 0x2ebea6f6e7b0e959ULL,
+                                     0xac8584d9982c4188ULL, 0x74ebe93f6ec6ea51ULL, 0x63dd6c4f07dd3666ULL, 0x0aeaf714c13bfbffULL};
+// 3^q in Montgomery form (3 is the smallest non-residue)
+constexpr uint64_t SQRT_C[8] = {0x3d9bef9c29652124ULL, 0xd7d06dd582f3fb1cULL, 0xeb064f81232aeeeaULL, 0x548d9dfae19c5e19ULL,
+                                0xbc9bb8215c046a22ULL, 0xf88b51dd8f3851f0ULL, 0x88c3b389e0cd0d80ULL, 0x4ef9ea1f9eb3d321ULL};
+constexpr int SQRT_S = 3;
+}
+
+void fp_to_mont(Fp512& r, const uint64_t plain[8]) {
+    Fp512 a, r2;
+    fp_set(a, plain);
+    fp_set(r2, fp512_const::R2);
+    fp_mul(r, a, r2);
+}
+
+void fp_from_mont(uint64_t plain[8], const Fp512& a) {
+    Fp512 one = fp_zero(), t;
+    one.v[0] = 1;
+    fp_mul(t, a, one);
+    for (int i = 0; i < 8; ++i) plain[i] = t.v[i];
+}
+
+bool fp_from_limbs(Fp512& r, const uint64_t plain[8]) {
+    // Reject values >= p.
+    for (int i = 7; i >= 0; --i) {
+        if (plain[i] < fp512_const::P[i]) break;
+        if (plain[i] > fp512_const::P[i] || i == 0) return false;
+    }
+    fp_to_mont(r, plain);
+    return true;
+}
+
+bool fp_from_mpz(Fp512& r, const mpz_class& z) {
+    if (sgn(z) < 0 || mpz_sizeinbase(z.get_mpz_t(), 2) > 512) return false;
+
+    uint64_t plain[8] = {0};
+    size_t count = 0;
+    mpz_export(plain, &count, -1, sizeof(uint64_t), 0, 0, z.get_mpz_t());
+    return fp_from_limbs(r, plain);
+}
+
+void fp_to_mpz(mpz_class& z, const Fp512& a) {
+    uint64_t plain[8];
+    fp_from_mont(plain, a);
+    mpz_import(z.get_mpz_t(), 8, -1, sizeof(uint64_t), 0, 0, plain);
+}
+
+void fp_pow(Fp512& r, const Fp512& a, const uint64_t e[8]) {
+    // Fixed 4-bit windows: 16-entry table, 512 squarings and 128 multiplications.
+    Fp512 table[16];
+    table[0] = fp_one();
+    table[1] = a;
+    for (int i = 2; i < 16; ++i) fp_mul(table[i], table[i - 1], a);
+
+    Fp512 acc = fp_one();
+    for (int limb = 7; limb >= 0; --limb) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            fp_sqr(acc, acc);
+            fp_sqr(acc, acc);
+            fp_sqr(acc, acc);
+            fp_sqr(acc, acc);
+            unsigned w = static_cast<unsigned>((e[limb] >> shift) & 0xF);
+
+            // Scan the whole table so the access pattern does not depend on the window.
+            Fp512 sel = table[0];
+            for (unsigned k = 1; k < 16; ++k) fp_cmov(sel, table[k], static_cast<uint64_t>(k == w));
+            fp_mul(acc, acc, sel);
+        }
+    }
+    r = acc;
+}
+
+void fp_inv(Fp512& r, const Fp512& a) {
+    fp_pow(r, a, P_MINUS_2);
+}
+
+bool fp_inv_vartime(Fp512& r, const Fp512& a) {
+    if (fp_is_zero(a)) return false;
+
+    // gcdext needs {u} >= {v}: with u = a + p and v = p, s * u + t * v = 1 gives
+    // s = a^-1 mod p. Working directly on the Montgomery value aR yields a^-1 R^-1,
+    // which one multiplication by R^3 turns into a^-1 R.
+    mp_limb_t u[10], v[10], g[10], s[10];
+    mp_limb_t carry = mpn_add_n(u, reinterpret_cast<const mp_limb_t*>(a.v),
+                                reinterpret_cast<const mp_limb_t*>(fp512_const::P), 8);
+    u[8] = carry;
+    mp_size_t un = carry ? 9 : 8;
+    for (int i = 0; i < 8; ++i) v[i] = fp512_const::P[i];
+
+    mp_size_t sn = 0;
+    mp_size_t gn = mpn_gcdext(g, s, &sn, u, un, v, 8);
+    if (gn != 1 || g[0] != 1) return false;
+
+    uint64_t plain[8] = {0};
+    mp_size_t len = sn < 0 ? -sn : sn;
+    for (mp_size_t i = 0; i < len && i < 8; ++i) plain[i] = s[i];
+    if (sn < 0) {
+        mp_limb_t tmp[8];
+        mpn_sub_n(tmp, reinterpret_cast<const mp_limb_t*>(fp512_const::P), reinterpret_cast<mp_limb_t*>(plain), 8);
+        for (int i = 0; i < 8; ++i) plain[i] = tmp[i];
+    }
+
+    Fp512 inv, r3;
+    fp_set(inv, plain);
+    fp_set(r3, fp512_const::R3);
+    fp_mul(r, inv, r3);
+    return true;
+}
+
+size_t fp_batch_inv_vartime(Fp512* a, size_t n) {
+    // prefix[i] = product of the nonzero elements before i.
+    std::vector<Fp512> prefix(n);
+    Fp512 acc = fp_one();
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i] = acc;
+        if (fp_is_zero(a[i])) continue;
+        fp_mul(acc, acc, a[i]);
+        ++count;
+    }
+    if (count == 0) return 0;
+
+    Fp512 inv;
+    fp_inv_vartime(inv, acc);
+    for (size_t i = n; i-- > 0;) {
+        if (fp_is_zero(a[i])) continue;
+        Fp512 ai;
+        fp_mul(ai, inv, prefix[i]);
+        fp_mul(inv, inv, a[i]);
+        a[i] = ai;
+    }
+    return count;
+}
+
+bool fp_sqrt_vartime(Fp512& r, const Fp512& a) {
+    if (fp_is_zero(a)) {
+        r = a;
+        return true;
+    }
+
+    // w = a^((q-1)/2), x = a^((q+1)/2), t = a^q.
+    Fp512 w, x, t, c, b;
+    fp_pow(w, a, SQRT_Q_HALF);
+    fp_mul(x, a, w);
+    fp_mul(t, x, w);
+    fp_set(c, SQRT_C);
+
+    const Fp512 one = fp_one();
+    int m = SQRT_S;
+    while (!fp_equal(t, one)) {
+        // Least i with t^(2^i) == 1.
+        int i = 0;
+        Fp512 t2 = t;
+        while (!fp_equal(t2, one)) {
+            fp_sqr(t2, t2);
+            if (++i == m) return false;   // a is not a square
+        }
+        b = c;
+        for (int k = 0; k < m - i - 1; ++k) fp_sqr(b, b);
+        fp_mul(x, x, b);
+        fp_sqr(c, b);
+        fp_mul(t, t, c);
+        m = i;
+    }
+    r = x;
+    return true;
+}
+
+bool fp_is_odd(const Fp512& a) {
+    uint64_t plain[8];
+    fp_from_mont(plain, a);
+    return plain[0] & 1;
+}
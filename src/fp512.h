@@ -0,0 +1,167 @@
+#ifndef FP512_H
+#define FP512_H
+
+#include <gmpxx.h>
+#include <cstddef>
+#include <cstdint>
+
+static_assert(sizeof(mp_limb_t) == sizeof(uint64_t), "Fp512 requires 64-bit GMP limbs");
+
+// Fixed-width arithmetic in the base field of ECCFrog512CK2.
+//
+// Elements are 8 little-endian 64-bit limbs kept in Montgomery form (a * 2^512 mod p).
+// Everything lives on the stack: no mpz temporaries, no heap allocation. add/sub/mul
+// and fp_inv run in constant time; functions suffixed _vartime may branch on the value
+// and are meant for public data only.
+struct Fp512 {
+    uint64_t v[8];
+};
+
+namespace fp512_const {
+// p
+static constexpr uint64_t P[8] = {0xdc74976b30a260c9ULL, 0xfacd9a49b39d5beeULL, 0x2c36ba5e27705dafULL, 0xebea6f6e7b0e959dULL,
+                                  0xc8584d9982c41882ULL, 0x4ebe93f6ec6ea51aULL, 0x3dd6c4f07dd36667ULL, 0xaeaf714c13bfbff6ULL};
+// -p^-1 mod 2^64
+static constexpr uint64_t N0 = 0x7d22ac59f0a84687ULL;
+// 2^512 mod p (Montgomery one)
+static constexpr uint64_t ONE[8] = {0x238b6894cf5d9f37ULL, 0x053265b64c62a411ULL, 0xd3c945a1d88fa250ULL, 0x1415909184f16a62ULL,
+                                    0x37a7b2667d3be77dULL, 0xb1416c0913915ae5ULL, 0xc2293b0f822c9998ULL, 0x51508eb3ec404009ULL};
+// 2^1024 mod p
+static constexpr uint64_t R2[8] = {0x4651bb46f7b7aef7ULL, 0x1c08b681f5454ee7ULL, 0xdf26ba52517d592eULL, 0xd01be80efc2d5d34ULL,
+                                   0xb00f2a19c2341103ULL, 0xba2494f502d52c8aULL, 0x39fe31562a5d1160ULL, 0x57269882413cdf43ULL};
+// 2^1536 mod p
+static constexpr uint64_t R3[8] = {0x10096d3501fe348aULL, 0x45fdb87bf025a31aULL, 0x3f1b744e8533182fULL, 0xca68da269bfc2b69ULL,
+                                   0xcb7f9db631182affULL, 0x9f76926d7abce758ULL, 0x52a58ec76f742a8eULL, 0x4fff567b3fe856f9ULL};
+}
+
+inline void fp_set(Fp512& r, const uint64_t src[8]) {
+    for (int i = 0; i < 8; ++i) r.v[i] = src[i];
+}
+
+inline Fp512 fp_zero() {
+    Fp512 r;
+    for (int i = 0; i < 8; ++i) r.v[i] = 0;
+    return r;
+}
+
+inline Fp512 fp_one() {
+    Fp512 r;
+    fp_set(r, fp512_const::ONE);
+    return r;
+}
+
+// r = t - p if t >= p (t given as 8 limbs plus a carry limb), else t. Constant time.
+inline void fp_reduce_once(Fp512& r, const uint64_t t[8], uint64_t carry) {
+    mp_limb_t d[8];
+    mp_limb_t borrow = mpn_sub_n(d, reinterpret_cast<const mp_limb_t*>(t),
+                                 reinterpret_cast<const mp_limb_t*>(fp512_const::P), 8);
+    // Keep t only when it was below p: no carry out and the subtraction borrowed.
+    uint64_t keep = static_cast<uint64_t>(0) - (borrow & (carry ^ 1));
+    for (int i = 0; i < 8; ++i) r.v[i] = (t[i] & keep) | (d[i] & ~keep);
+}
+
+inline void fp_add(Fp512& r, const Fp512& a, const Fp512& b) {
+    uint64_t t[8];
+    mp_limb_t carry = mpn_add_n(reinterpret_cast<mp_limb_t*>(t), reinterpret_cast<const mp_limb_t*>(a.v),
+                                reinterpret_cast<const mp_limb_t*>(b.v), 8);
+    fp_reduce_once(r, t, carry);
+}
+
+inline void fp_sub(Fp512& r, const Fp512& a, const Fp512& b) {
+    uint64_t t[8];
+    mp_limb_t borrow = mpn_sub_n(reinterpret_cast<mp_limb_t*>(t), reinterpret_cast<const mp_limb_t*>(a.v),
+                                 reinterpret_cast<const mp_limb_t*>(b.v), 8);
+    // Add p back when the subtraction wrapped.
+    uint64_t mask = static_cast<uint64_t>(0) - borrow;
+    mp_limb_t fix[8];
+    for (int i = 0; i < 8; ++i) fix[i] = fp512_const::P[i] & mask;
+    mpn_add_n(reinterpret_cast<mp_limb_t*>(r.v), reinterpret_cast<const mp_limb_t*>(t), fix, 8);
+}
+
+inline void fp_neg(Fp512& r, const Fp512& a) {
+    fp_sub(r, fp_zero(), a);
+}
+
+// Montgomery reduction of a 16-limb product t: r = t * 2^-512 mod p. mpn_addmul_1 runs in
+// time independent of the data; the carry out of each row is added back in one pass at the
+// end instead of rippling through mpn_add_1, which may stop early.
+inline void fp_redc(Fp512& r, mp_limb_t t[16]) {
+    const mp_limb_t* p = reinterpret_cast<const mp_limb_t*>(fp512_const::P);
+    mp_limb_t cy[8];
+    for (int i = 0; i < 8; ++i) {
+        mp_limb_t m = t[i] * fp512_const::N0;
+        cy[i] = mpn_addmul_1(t + i, p, 8, m);
+    }
+    mp_limb_t carry = mpn_add_n(t + 8, t + 8, cy, 8);
+    fp_reduce_once(r, reinterpret_cast<const uint64_t*>(t + 8), carry);
+}
+
+// Montgomery product r = a * b * 2^-512 mod p. The 8x8 product uses GMP's mpn kernels
+// (assembly on the common targets), which beat a portable CIOS loop here.
+inline void fp_mul(Fp512& r, const Fp512& a, const Fp512& b) {
+    mp_limb_t t[16];
+    mpn_mul_n(t, reinterpret_cast<const mp_limb_t*>(a.v), reinterpret_cast<const mp_limb_t*>(b.v), 8);
+    fp_redc(r, t);
+}
+
+inline void fp_sqr(Fp512& r, const Fp512& a) {
+    mp_limb_t t[16];
+    mpn_sqr(t, reinterpret_cast<const mp_limb_t*>(a.v), 8);
+    fp_redc(r, t);
+}
+
+inline bool fp_is_zero(const Fp512& a) {
+    uint64_t acc = 0;
+    for (int i = 0; i < 8; ++i) acc |= a.v[i];
+    return acc == 0;
+}
+
+inline bool fp_equal(const Fp512& a, const Fp512& b) {
+    uint64_t acc = 0;
+    for (int i = 0; i < 8; ++i) acc |= a.v[i] ^ b.v[i];
+    return acc == 0;
+}
+
+// r = a when flag is 1, unchanged when 0. Constant time.
+inline void fp_cmov(Fp512& r, const Fp512& a, uint64_t flag) {
+    uint64_t mask = static_cast<uint64_t>(0) - flag;
+    for (int i = 0; i < 8; ++i) r.v[i] ^= (r.v[i] ^ a.v[i]) & mask;
+}
+
+// Swaps a and b when flag is 1. Constant time.
+inline void fp_cswap(Fp512& a, Fp512& b, uint64_t flag) {
+    uint64_t mask = static_cast<uint64_t>(0) - flag;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t t = (a.v[i] ^ b.v[i]) & mask;
+        a.v[i] ^= t;
+        b.v[i] ^= t;
+    }
+}
+
+// Conversions between Montgomery form and plain integers.
+void fp_to_mont(Fp512& r, const uint64_t plain[8]);
+void fp_from_mont(uint64_t plain[8], const Fp512& a);
+bool fp_from_limbs(Fp512& r, const uint64_t plain[8]);   // false if the value is >= p
+bool fp_from_mpz(Fp512& r, const mpz_class& z);           // false if z is outside [0, p)
+void fp_to_mpz(mpz_class& z, const Fp512& a);
+
+// r = a^e for a public exponent given as 8 little-endian limbs.
+void fp_pow(Fp512& r, const Fp512& a, const uint64_t e[8]);
+
+// r = a^-1 (Fermat, constant time). a must be nonzero.
+void fp_inv(Fp512& r, const Fp512& a);
+
+// r = a^-1 using GMP's extended gcd on the limbs (no heap); false if a == 0.
+bool fp_inv_vartime(Fp512& r, const Fp512& a);
+
+// Inverts n elements in place with one inversion (Montgomery's trick). Zero entries are
+// left untouched; returns how many nonzero elements were inverted.
+size_t fp_batch_inv_vartime(Fp512* a, size_t n);
+
+// Square root (Tonelli-Shanks, p - 1 = q * 2^3); false if a is not a square.
+bool fp_sqrt_vartime(Fp512& r, const Fp512& a);
+
+// Parity of the plain (non-Montgomery) value.
+bool fp_is_odd(const Fp512& a);
+
+#endif
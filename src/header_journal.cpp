@@ -0,0 +1,109 @@
+#include "header_journal.h"
+#include "format.h"
+#include "io_backend.h"
+#include <sodium.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const unsigned char JOURNAL_MAGIC[4] = {'C', 'F', 'H', 'J'};
+static const size_t JOURNAL_HASH_BYTES = crypto_generichash_BYTES;
+static const size_t JOURNAL_MAX_BYTES = sizeof(JOURNAL_MAGIC) + 2 + 0xFFFF + JOURNAL_HASH_BYTES;
+
+static std::string journal_path(const std::string& path) {
+    return path + ".journal";
+}
+
+// magic | tamanho u16 LE | header | BLAKE2b(magic..header)
+static std::vector<unsigned char> journal_record(const std::vector<unsigned char>& header) {
+    std::vector<unsigned char> record(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    record.push_back(static_cast<unsigned char>(header.size()));
+    record.push_back(static_cast<unsigned char>(header.size() >> 8));
+    record.insert(record.end(), header.begin(), header.end());
+    unsigned char hash[JOURNAL_HASH_BYTES];
+    crypto_generichash(hash, sizeof(hash), record.data(), record.size(), NULL, 0);
+    record.insert(record.end(), hash, hash + sizeof(hash));
+    return record;
+}
+
+static bool parse_journal_record(const std::vector<unsigned char>& record, std::vector<unsigned char>& header) {
+    const size_t fixed = sizeof(JOURNAL_MAGIC) + 2;
+    if (record.size() < fixed + HEADER_CORE_BYTES + JOURNAL_HASH_BYTES ||
+        std::memcmp(record.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0)
+        return false;
+    size_t len = static_cast<size_t>(record[4]) | (static_cast<size_t>(record[5]) << 8);
+    if (record.size() != fixed + len + JOURNAL_HASH_BYTES) return false;
+
+    unsigned char hash[JOURNAL_HASH_BYTES];
+    crypto_generichash(hash, sizeof(hash), record.data(), fixed + len, NULL, 0);
+    if (sodium_memcmp(hash, record.data() + fixed + len, sizeof(hash)) != 0) return false;
+    header.assign(record.begin() + fixed, record.begin() + fixed + len);
+    return true;
+}
+
+bool write_header_journaled(int fd, const std::string& path, const std::vector<unsigned char>& header) {
+    if (header.size() < HEADER_CORE_BYTES || header.size() > 0xFFFF || ::flock(fd, LOCK_EX) != 0) return false;
+
+    // O_EXCL: um diário existente é uma reescrita pendente, que a recuperação conclui antes.
+    std::string journal = journal_path(path);
+    std::vector<unsigned char> record = journal_record(header);
+    int jfd = ::open(journal.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    bool ok = jfd >= 0;
+    if (ok) {
+        bool written = pwrite_exact(jfd, record.data(), record.size(), 0) && ::fdatasync(jfd) == 0;
+        if (::close(jfd) != 0) written = false;
+        if (!written || !sync_parent_dir(path)) {
+            // O header não foi tocado: o diário incompleto só atrapalharia a próxima tentativa.
+            ::unlink(journal.c_str());
+            ok = false;
+        }
+    }
+
+    // Daqui em diante, uma queda ou um erro deixam o diário para recover_header_journal.
+    ok = ok && pwrite_exact(fd, header.data(), header.size(), 0) && ::fdatasync(fd) == 0 &&
+         ::unlink(journal.c_str()) == 0 && sync_parent_dir(path);
+    ::flock(fd, LOCK_UN);
+    return ok;
+}
+
+// Aplica ou descarta o diário de path; fd é o arquivo, já com flock exclusivo.
+static bool apply_journal(int fd, const std::string& path, const std::string& journal) {
+    int jfd = ::open(journal.c_str(), O_RDONLY | O_CLOEXEC);
+    if (jfd < 0) return errno == ENOENT;   // concluído por outro processo enquanto esperávamos o lock
+
+    struct stat st;
+    std::vector<unsigned char> record;
+    bool read = fstat(jfd, &st) == 0 && static_cast<uint64_t>(st.st_size) <= JOURNAL_MAX_BYTES;
+    if (read) {
+        record.resize(static_cast<size_t>(st.st_size));
+        read = pread_exact(jfd, record.data(), record.size(), 0);
+    }
+    ::close(jfd);
+    if (!read) return false;
+
+    std::vector<unsigned char> header;
+    unsigned char core[HEADER_CORE_BYTES];
+    bool apply = parse_journal_record(record, header);
+    if (apply) {
+        // O núcleo não muda numa reescrita, e o prefixo de nonce é único por arquivo.
+        if (!pread_exact(fd, core, sizeof(core), 0)) return false;
+        apply = std::memcmp(core, header.data(), sizeof(core)) == 0;
+    }
+    if (apply && (!pwrite_exact(fd, header.data(), header.size(), 0) || ::fdatasync(fd) != 0)) return false;
+    return ::unlink(journal.c_str()) == 0 && sync_parent_dir(path);
+}
+
+bool recover_header_journal(const std::string& path) {
+    std::string journal = journal_path(path);
+    struct stat st;
+    if (::stat(journal.c_str(), &st) != 0) return true;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::flock(fd, LOCK_EX) == 0 && apply_journal(fd, path, journal);
+    ::close(fd);
+    return ok;
+}
@@ -0,0 +1,28 @@
+#ifndef HEADER_JOURNAL_H
+#define HEADER_JOURNAL_H
+
+#include <string>
+#include <vector>
+
+// Reescrita do header no lugar, resistente a quedas.
+//
+// O header guarda a única cópia dos keyslots: um pwrite interrompido no meio (alguns KiB
+// com vários slots e destinatários) deixaria o arquivo inteiro ilegível. Por isso o novo
+// header vai antes para um diário ao lado do arquivo (<arquivo>.journal: magic, tamanho,
+// header e BLAKE2b), gravado e sincronizado por inteiro; só então o header é reescrito e o
+// diário removido. Depois de uma queda:
+//   - diário incompleto (o BLAKE2b não bate): o header não foi tocado e o diário é descartado;
+//   - diário completo: o header pode estar rasgado e é regravado a partir do diário;
+//   - diário cujo núcleo difere do arquivo: o arquivo foi substituído depois; é descartado.
+// O flock no arquivo serializa a reescrita e a recuperação entre processos.
+
+// Grava header (mesmo núcleo e header_len do atual) no início de fd, aberto em path, via
+// diário. Falso se já existe um diário pendente ou em erro de E/S.
+bool write_header_journaled(int fd, const std::string& path, const std::vector<unsigned char>& header);
+
+// Conclui uma reescrita interrompida de path, se houver diário. Verdadeiro se não havia o
+// que fazer ou se o diário foi aplicado ou descartado; falso se um diário válido não pôde
+// ser aplicado (arquivo somente leitura, por exemplo). Custa um stat quando não há diário.
+bool recover_header_journal(const std::string& path);
+
+#endif
@@ -0,0 +1,585 @@
+#include "io_backend.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef CRYPTOFROG_HAVE_URING
+#include "memory_pool.h"
+#include <sodium.h>
+#include <liburing.h>
+#include <mutex>
+#endif
+
+// ---------- iostream ----------
+
+class StreamInput : public InputSource {
+public:
+    explicit StreamInput(std::istream& stream) : in(stream) {}
+    explicit StreamInput(std::unique_ptr<std::ifstream> file) : owned(std::move(file)), in(*owned) {}
+
+    size_t acquire(unsigned char* scratch, size_t len, const unsigned char** data) override {
+        size_t got = 0;
+        while (got < len && in) {
+            in.read(reinterpret_cast<char*>(scratch + got), len - got);
+            got += static_cast<size_t>(in.gcount());
+        }
+        *data = scratch;
+        return got;
+    }
+
+    bool at_end() override { return in.peek() == std::char_traits<char>::eof(); }
+    bool failed() const override { return in.bad(); }
+
+private:
+    std::unique_ptr<std::ifstream> owned;
+    std::istream& in;
+};
+
+class StreamOutput : public OutputSink {
+public:
+    explicit StreamOutput(std::ostream& stream) : out(stream) {}
+    explicit StreamOutput(std::unique_ptr<std::ofstream> file) : owned(std::move(file)), out(*owned) {}
+
+    bool write(const unsigned char* data, size_t len) override {
+        out.write(reinterpret_cast<const char*>(data), len);
+        return static_cast<bool>(out);
+    }
+
+    bool finish() override {
+        out.flush();
+        if (owned) owned->close();
+        return static_cast<bool>(out);
+    }
+
+    bool can_rewrite() const override { return owned != nullptr; }
+
+    bool rewrite(uint64_t offset, const unsigned char* data, size_t len) override {
+        if (!owned) return false;
+        std::streampos end = out.tellp();
+        out.seekp(static_cast<std::streamoff>(offset));
+        out.write(reinterpret_cast<const char*>(data), len);
+        out.seekp(end);
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::unique_ptr<std::ofstream> owned;
+    std::ostream& out;
+};
+
+// ---------- descritores / mmap ----------
+
+static bool write_all(int fd, const unsigned char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+class MmapInput : public InputSource {
+public:
+    MmapInput(const unsigned char* data, size_t size) : base(data), length(size) {
+        if (base) madvise(const_cast<unsigned char*>(base), length, MADV_SEQUENTIAL);
+    }
+    ~MmapInput() override {
+        if (base) munmap(const_cast<unsigned char*>(base), length);
+    }
+
+    size_t acquire(unsigned char*, size_t len, const unsigned char** data) override {
+        size_t n = std::min(len, length - pos);
+        *data = base + pos;
+        pos += n;
+        return n;
+    }
+
+    bool at_end() override { return pos >= length; }
+    bool failed() const override { return false; }
+
+private:
+    const unsigned char* base;
+    size_t length;
+    size_t pos = 0;
+};
+
+class FdOutput : public OutputSink {
+public:
+    explicit FdOutput(int descriptor) : fd(descriptor) {
+        struct stat st;
+        regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    }
+    ~FdOutput() override {
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool write(const unsigned char* data, size_t len) override {
+        ok = ok && write_all(fd, data, len);
+        return ok;
+    }
+
+    bool finish() override {
+        if (fd >= 0 && ::close(fd) != 0) ok = false;
+        fd = -1;
+        return ok;
+    }
+
+    bool can_rewrite() const override { return regular; }
+
+    bool rewrite(uint64_t offset, const unsigned char* data, size_t len) override {
+        ok = ok && regular && fd >= 0 && pwrite_exact(fd, data, len, offset);
+        return ok;
+    }
+
+private:
+    int fd;
+    bool regular;
+    bool ok = true;
+};
+
+// Abre o arquivo para leitura; retorna -1 se não for um arquivo regular.
+static int open_regular(const std::string& path, struct stat& st) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::unique_ptr<InputSource> open_stream_input(const std::string& path) {
+    std::unique_ptr<std::ifstream> file(new std::ifstream(path, std::ios::binary));
+    if (!*file) return nullptr;
+    return std::unique_ptr<InputSource>(new StreamInput(std::move(file)));
+}
+
+static std::unique_ptr<InputSource> open_mmap_input(const std::string& path) {
+    struct stat st;
+    int fd = open_regular(path, st);
+    if (fd < 0) return open_stream_input(path);
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = nullptr;
+    if (size > 0) {
+        map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            return open_stream_input(path);
+        }
+    }
+    ::close(fd);
+    return std::unique_ptr<InputSource>(new MmapInput(static_cast<const unsigned char*>(map), size));
+}
+
+static int open_output_fd(const std::string& path) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+}
+
+// ---------- io_uring ----------
+
+#ifdef CRYPTOFROG_HAVE_URING
+
+static const unsigned URING_DEPTH = 8;
+static const size_t URING_CHUNK = 1024 * 1024;
+static const size_t URING_IDLE_RINGS = 4;   // 8 MiB de buffers cada
+
+// Anel de buffers registrados no kernel. Os buffers vêm do pool de E/S (memory_pool.h), e
+// o anel inteiro, já registrado, passa de um arquivo para o próximo (uring_rings).
+struct UringRing {
+    struct io_uring ring;
+    BufferPool::Lease storage;
+    bool ready = false;
+
+    bool init() {
+        if (io_uring_queue_init(URING_DEPTH, &ring, 0) < 0) return false;
+        ready = true;
+        storage = io_buffer_pool().acquire(URING_DEPTH * URING_CHUNK);
+        struct iovec iov[URING_DEPTH];
+        for (unsigned i = 0; i < URING_DEPTH; ++i) {
+            iov[i].iov_base = buffer(i);
+            iov[i].iov_len = URING_CHUNK;
+        }
+        return io_uring_register_buffers(&ring, iov, URING_DEPTH) == 0;
+    }
+
+    // O anel sai antes dos buffers: o membro storage só é devolvido depois deste corpo.
+    ~UringRing() {
+        if (ready) io_uring_queue_exit(&ring);
+    }
+
+    unsigned char* buffer(unsigned i) { return storage.data() + i * URING_CHUNK; }
+
+    // Espera uma conclusão; devolve o índice do buffer e o resultado da operação.
+    bool wait(unsigned& slot, int& res) {
+        struct io_uring_cqe* cqe;
+        int rc;
+        do {
+            rc = io_uring_wait_cqe(&ring, &cqe);
+        } while (rc == -EINTR);
+        if (rc < 0) return false;
+        slot = static_cast<unsigned>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+        res = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        return true;
+    }
+};
+
+// Anéis ociosos: sem io_uring_queue_init nem registro de buffers por arquivo num lote.
+// Só voltam anéis sem operações em voo, com os buffers zerados.
+class UringRingPool {
+public:
+    std::unique_ptr<UringRing> acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                std::unique_ptr<UringRing> ring = std::move(idle.back());
+                idle.pop_back();
+                return ring;
+            }
+        }
+        std::unique_ptr<UringRing> ring(new UringRing);
+        if (!ring->init()) ring.reset();
+        return ring;
+    }
+
+    void release(std::unique_ptr<UringRing> ring) {
+        sodium_memzero(ring->storage.data(), ring->storage.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() < URING_IDLE_RINGS) idle.push_back(std::move(ring));
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<UringRing>> idle;
+};
+
+static UringRingPool& uring_rings() {
+    // Nunca destruído, como os pools de memory_pool.h.
+    static UringRingPool* pool = new UringRingPool;
+    return *pool;
+}
+
+// Mantém até URING_DEPTH leituras sequenciais em voo à frente do consumidor.
+class UringInput : public InputSource {
+public:
+    UringInput(int descriptor, uint64_t size) : fd(descriptor), length(size) {}
+    ~UringInput() override {
+        drain();
+        bool idle = std::none_of(slots, slots + URING_DEPTH, [](const Slot& s) { return s.busy; });
+        if (uring && idle && !error) uring_rings().release(std::move(uring));
+        ::close(fd);
+    }
+
+    bool init() {
+        uring = uring_rings().acquire();
+        if (!uring) return false;
+        for (unsigned i = 0; i < URING_DEPTH; ++i) submit(i);
+        return true;
+    }
+
+    size_t acquire(unsigned char* scratch, size_t len, const unsigned char** data) override {
+        size_t got = 0;
+        while (got < len && !error && consumed < length) {
+            Slot& head = slots[head_slot];
+            while (!head.done && !error) complete_one();
+            if (error) break;
+
+            size_t n = std::min(len - got, head.len - head.pos);
+            std::memcpy(scratch + got, uring->buffer(head_slot) + head.pos, n);
+            head.pos += n;
+            got += n;
+            consumed += n;
+            if (head.pos == head.len) {
+                submit(head_slot);
+                head_slot = (head_slot + 1) % URING_DEPTH;
+            }
+        }
+        *data = scratch;
+        return got;
+    }
+
+    bool at_end() override { return consumed >= length; }
+    bool failed() const override { return error; }
+
+private:
+    struct Slot {
+        uint64_t offset = 0;
+        size_t len = 0, pos = 0;
+        bool busy = false, done = false;
+    };
+
+    void submit(unsigned i) {
+        Slot& s = slots[i];
+        s.busy = s.done = false;
+        s.pos = 0;
+        if (next_offset >= length) return;
+        s.offset = next_offset;
+        s.len = static_cast<size_t>(std::min<uint64_t>(URING_CHUNK, length - next_offset));
+        next_offset += s.len;
+
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&uring->ring);
+        io_uring_prep_read_fixed(sqe, fd, uring->buffer(i), s.len, s.offset, i);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+        s.busy = true;
+        if (io_uring_submit(&uring->ring) < 0) error = true;
+    }
+
+    void complete_one() {
+        unsigned i;
+        int res;
+        if (!uring->wait(i, res) || i >= URING_DEPTH) {
+            error = true;
+            return;
+        }
+        Slot& s = slots[i];
+        s.busy = false;
+        if (res < 0 || static_cast<size_t>(res) != s.len) error = true;
+        s.done = true;
+    }
+
+    void drain() {
+        for (unsigned i = 0; i < URING_DEPTH; ++i) {
+            while (slots[i].busy && uring && uring->ready) {
+                unsigned j;
+                int res;
+                if (!uring->wait(j, res) || j >= URING_DEPTH) return;
+                slots[j].busy = false;
+            }
+        }
+    }
+
+    int fd;
+    uint64_t length;
+    std::unique_ptr<UringRing> uring;
+    Slot slots[URING_DEPTH];
+    unsigned head_slot = 0;
+    uint64_t next_offset = 0, consumed = 0;
+    bool error = false;
+};
+
+// Copia a saída para o anel e envia escritas posicionais sem bloquear o pipeline.
+class UringOutput : public OutputSink {
+public:
+    explicit UringOutput(int descriptor) : fd(descriptor) {
+        struct stat st;
+        regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    }
+    ~UringOutput() override {
+        if (fd >= 0) {
+            wait_all();
+            ::close(fd);
+        }
+        if (uring && ok && in_flight == 0) uring_rings().release(std::move(uring));
+    }
+
+    bool init() {
+        uring = uring_rings().acquire();
+        return uring != nullptr;
+    }
+
+    bool write(const unsigned char* data, size_t len) override {
+        while (len > 0 && ok) {
+            if (fill == URING_CHUNK) flush_current();
+            size_t n = std::min(len, URING_CHUNK - fill);
+            std::memcpy(uring->buffer(current) + fill, data, n);
+            fill += n;
+            data += n;
+            len -= n;
+        }
+        return ok;
+    }
+
+    bool finish() override {
+        if (fill > 0) flush_current();
+        wait_all();
+        if (fd >= 0 && ::close(fd) != 0) ok = false;
+        fd = -1;
+        return ok;
+    }
+
+    bool can_rewrite() const override { return regular; }
+
+    // Esvazia o anel antes, para que a escrita posicional não corra com uma pendente.
+    bool rewrite(uint64_t offset, const unsigned char* data, size_t len) override {
+        if (fill > 0) flush_current();
+        wait_all();
+        ok = ok && regular && fd >= 0 && pwrite_exact(fd, data, len, offset);
+        return ok;
+    }
+
+private:
+    void flush_current() {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&uring->ring);
+        io_uring_prep_write_fixed(sqe, fd, uring->buffer(current), fill, offset, current);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(current)));
+        if (io_uring_submit(&uring->ring) < 0) ok = false;
+        pending[current] = fill;
+        in_flight++;
+        offset += fill;
+        fill = 0;
+
+        current = (current + 1) % URING_DEPTH;
+        while (pending[current] != 0 && ok) reap();
+    }
+
+    void reap() {
+        unsigned i;
+        int res;
+        if (!uring->wait(i, res) || i >= URING_DEPTH) {
+            ok = false;
+            return;
+        }
+        if (res < 0 || static_cast<size_t>(res) != pending[i]) ok = false;
+        pending[i] = 0;
+        in_flight--;
+    }
+
+    void wait_all() {
+        while (in_flight > 0 && ok) reap();
+    }
+
+    int fd;
+    bool regular;
+    std::unique_ptr<UringRing> uring;
+    size_t pending[URING_DEPTH] = {0};
+    unsigned current = 0, in_flight = 0;
+    size_t fill = 0;
+    uint64_t offset = 0;
+    bool ok = true;
+};
+
+static std::unique_ptr<InputSource> open_uring_input(const std::string& path) {
+    struct stat st;
+    int fd = open_regular(path, st);
+    if (fd < 0) return open_stream_input(path);
+    std::unique_ptr<UringInput> in(new UringInput(fd, static_cast<uint64_t>(st.st_size)));
+    if (!in->init()) return open_mmap_input(path);
+    return std::unique_ptr<InputSource>(in.release());
+}
+
+static std::unique_ptr<OutputSink> open_uring_output(const std::string& path) {
+    int fd = open_output_fd(path);
+    if (fd < 0) return nullptr;
+    std::unique_ptr<UringOutput> out(new UringOutput(fd));
+    if (!out->init()) return nullptr;
+    return std::unique_ptr<OutputSink>(out.release());
+}
+
+#endif
+
+// ---------- fábrica ----------
+
+std::unique_ptr<InputSource> open_input(const std::string& path, IoBackend backend) {
+    switch (backend) {
+    case IoBackend::Mmap:
+        return open_mmap_input(path);
+    case IoBackend::Uring:
+#ifdef CRYPTOFROG_HAVE_URING
+        return open_uring_input(path);
+#else
+        // Sem liburing na compilação: o caminho mapeado é o mais próximo.
+        return open_mmap_input(path);
+#endif
+    case IoBackend::Stream:
+    default:
+        return open_stream_input(path);
+    }
+}
+
+std::unique_ptr<OutputSink> open_output(const std::string& path, IoBackend backend) {
+    if (backend == IoBackend::Stream) {
+        std::unique_ptr<std::ofstream> file(new std::ofstream(path, std::ios::binary));
+        if (!*file) return nullptr;
+        return std::unique_ptr<OutputSink>(new StreamOutput(std::move(file)));
+    }
+#ifdef CRYPTOFROG_HAVE_URING
+    if (backend == IoBackend::Uring) {
+        std::unique_ptr<OutputSink> out = open_uring_output(path);
+        if (out) return out;
+    }
+#endif
+    int fd = open_output_fd(path);
+    if (fd < 0) return nullptr;
+    return std::unique_ptr<OutputSink>(new FdOutput(fd));
+}
+
+std::unique_ptr<InputSource> wrap_input(std::istream& in) {
+    return std::unique_ptr<InputSource>(new StreamInput(in));
+}
+
+std::unique_ptr<OutputSink> wrap_output(std::ostream& out) {
+    return std::unique_ptr<OutputSink>(new StreamOutput(out));
+}
+
+bool read_exact(InputSource& in, unsigned char* buf, size_t len) {
+    while (len > 0) {
+        const unsigned char* data;
+        size_t got = in.acquire(buf, len, &data);
+        if (got == 0) return false;
+        if (data != buf) std::memcpy(buf, data, got);
+        buf += got;
+        len -= got;
+    }
+    return true;
+}
+
+bool pread_exact(int fd, unsigned char* buf, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool pwrite_exact(int fd, const unsigned char* buf, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, buf, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool sync_parent_dir(const std::string& path) {
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool parse_io_backend(const std::string& name, IoBackend& backend) {
+    if (name == "stream") backend = IoBackend::Stream;
+    else if (name == "mmap") backend = IoBackend::Mmap;
+    else if (name == "uring") backend = IoBackend::Uring;
+    else return false;
+    return true;
+}
+
+const char* io_backend_name(IoBackend backend) {
+    switch (backend) {
+    case IoBackend::Mmap: return "mmap";
+    case IoBackend::Uring: return "uring";
+    default: return "stream";
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Backends de E/S sob encrypt_file/decrypt_file.
+//   Stream: ifstream/ofstream (caminho original, também usado para stdin/stdout)
+//   Mmap:   entrada mapeada em memória, segmentos lidos sem cópia; saída via write(2)
+//   Uring:  io_uring com um anel de buffers registrados e leituras/escritas antecipadas
+//           (disponível quando compilado com CRYPTOFROG_HAVE_URING)
+enum class IoBackend {
+    Stream,
+    Mmap,
+    Uring,
+};
+
+class InputSource {
+public:
+    virtual ~InputSource() {}
+
+    // Obtém até len bytes. *data aponta para os bytes lidos: ou scratch, ou memória
+    // do próprio backend (mmap), válida enquanto a fonte existir. Retorna 0 no fim.
+    virtual size_t acquire(unsigned char* scratch, size_t len, const unsigned char** data) = 0;
+
+    // Verdadeiro quando não há mais bytes a ler.
+    virtual bool at_end() = 0;
+
+    virtual bool failed() const = 0;
+};
+
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+    virtual bool write(const unsigned char* data, size_t len) = 0;
+
+    // Descarrega escritas pendentes; deve ser chamado antes de considerar a saída completa.
+    virtual bool finish() = 0;
+
+    // Reescreve bytes já emitidos (antes de finish), como o header completado ao fim da
+    // cifragem. Só arquivos regulares aceitam; stdout e pipes ficam com o padrão.
+    virtual bool can_rewrite() const { return false; }
+    virtual bool rewrite(uint64_t, const unsigned char*, size_t) { return false; }
+};
+
+std::unique_ptr<InputSource> open_input(const std::string& path, IoBackend backend);
+std::unique_ptr<OutputSink> open_output(const std::string& path, IoBackend backend);
+
+// Adaptadores para fluxos já abertos (stdin/stdout, buffers em memória).
+std::unique_ptr<InputSource> wrap_input(std::istream& in);
+std::unique_ptr<OutputSink> wrap_output(std::ostream& out);
+
+// Lê exatamente len bytes para buf; falso se a fonte terminar antes.
+bool read_exact(InputSource& in, unsigned char* buf, size_t len);
+
+// pread/pwrite de exatamente len bytes em offset, repetindo leituras/escritas parciais e
+// chamadas interrompidas (EINTR); falso em erro ou, na leitura, no fim do arquivo.
+bool pread_exact(int fd, unsigned char* buf, size_t len, uint64_t offset);
+bool pwrite_exact(int fd, const unsigned char* buf, size_t len, uint64_t offset);
+
+// Sincroniza o diretório de path, para que criações, remoções e renomeações cheguem ao disco.
+bool sync_parent_dir(const std::string& path);
+
+bool parse_io_backend(const std::string& name, IoBackend& backend);
+const char* io_backend_name(IoBackend backend);
+
+#endif
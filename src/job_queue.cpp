@@ -0,0 +1,111 @@
+#include "job_queue.h"
+#include "encrypt.h"
+#include "decrypt.h"
+#include "progress.h"
+#include "shred.h"
+#include "stats.h"
+#include <sodium.h>
+#include <filesystem>
+#include <memory>
+
+static JobResult execute(const Job& job, JobProgress& progress) {
+    OperationStats stats;
+    CryptoOptions options;
+    options.stats = &stats;
+    options.progress = &progress;
+
+    JobResult result;
+    result.ok = job.kind == JobKind::Encrypt ? encrypt_file(job.input, job.output, job.password, options)
+                                             : decrypt_file(job.input, job.output, job.password, options);
+    if (!result.ok) {
+        result.cancelled = progress.cancelled();
+        return result;
+    }
+    result.summary = stats.summary();
+    // Cancelado depois do último lote: a saída está completa, mas o original fica.
+    if (job.shred_input && !progress.cancelled()) result.wiped = shred_file(job.input);
+    return result;
+}
+
+JobQueue::JobQueue(Callbacks cb) : callbacks(std::move(cb)) {
+    worker = std::thread([this] { run(); });
+}
+
+JobQueue::~JobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (running) running->cancel();
+        for (Entry& entry : queue)
+            if (!entry.job.password.empty()) sodium_memzero(&entry.job.password[0], entry.job.password.size());
+        queue.clear();
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+uint64_t JobQueue::submit(Job job) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = next_id++;
+        queue.push_back(Entry{id, std::move(job), false});
+    }
+    wake.notify_all();
+    return id;
+}
+
+void JobQueue::cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id == running_id && running) running->cancel();
+    for (Entry& entry : queue)
+        if (entry.id == id) entry.cancelled = true;
+}
+
+void JobQueue::cancel_all() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) running->cancel();
+    for (Entry& entry : queue) entry.cancelled = true;
+}
+
+size_t JobQueue::unfinished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + (running_id ? 1 : 0);
+}
+
+void JobQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+
+        Entry entry = std::move(queue.front());
+        queue.pop_front();
+
+        // O total é o tamanho da entrada; o pipeline soma os bytes lidos por lote.
+        std::error_code ec;
+        uint64_t total = std::filesystem::file_size(entry.job.input, ec);
+        const uint64_t id = entry.id;
+        std::unique_ptr<JobProgress> progress(new JobProgress(ec ? 0 : total, [this, id](uint64_t done, uint64_t all) {
+            if (callbacks.progress) callbacks.progress(id, done, all);
+        }));
+        running_id = id;
+        running = progress.get();
+        lock.unlock();
+
+        JobResult result;
+        if (entry.cancelled) {
+            result.cancelled = true;
+        } else {
+            if (callbacks.started) callbacks.started(id, entry.job);
+            result = execute(entry.job, *progress);
+        }
+        if (!entry.job.password.empty()) sodium_memzero(&entry.job.password[0], entry.job.password.size());
+        entry.job.password.clear();
+        if (callbacks.finished) callbacks.finished(id, entry.job, result);
+
+        lock.lock();
+        running_id = 0;
+        running = nullptr;
+    }
+}
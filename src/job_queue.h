@@ -0,0 +1,82 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class JobProgress;
+
+enum class JobKind {
+    Encrypt,
+    Decrypt,
+};
+
+struct Job {
+    JobKind kind = JobKind::Encrypt;
+    std::string input, output, password;
+    bool shred_input = false;   // após cifrar, sobrescreve e remove o original (shred_file)
+};
+
+struct JobResult {
+    bool ok = false;
+    bool cancelled = false;   // falhou porque foi cancelado (ou nem chegou a rodar)
+    bool wiped = false;       // shred_input concluído
+    std::string summary;      // OperationStats::summary() de um job concluído
+};
+
+// Fila de operações da GUI, executadas uma de cada vez numa thread própria: os segmentos
+// de cada arquivo já ocupam todos os núcleos, e um Argon2 por vez limita a memória.
+// Os callbacks rodam na thread da fila, em ordem (started, progress..., finished), e não
+// podem chamar a fila de volta; quem mexe em interface os repassa ao próprio laço.
+// A senha de cada job é apagada da memória quando ele termina.
+class JobQueue {
+public:
+    struct Callbacks {
+        std::function<void(uint64_t id, const Job& job)> started;
+        std::function<void(uint64_t id, uint64_t done, uint64_t total)> progress;   // bytes de entrada
+        std::function<void(uint64_t id, const Job& job, const JobResult& result)> finished;
+    };
+
+    explicit JobQueue(Callbacks callbacks);
+    ~JobQueue();   // cancela o job em andamento, descarta a fila e espera a thread
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    // Enfileira e devolve o id do job (crescente a partir de 1).
+    uint64_t submit(Job job);
+
+    // Um job na fila termina sem rodar; o em andamento para no próximo lote de segmentos.
+    // Em ambos os casos finished chega com cancelled.
+    void cancel(uint64_t id);
+    void cancel_all();
+
+    // Jobs ainda não terminados, contando o em andamento.
+    size_t unfinished() const;
+
+private:
+    struct Entry {
+        uint64_t id;
+        Job job;
+        bool cancelled;
+    };
+
+    void run();
+
+    Callbacks callbacks;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Entry> queue;
+    uint64_t next_id = 1;
+    uint64_t running_id = 0;
+    JobProgress* running = nullptr;   // válido enquanto running_id != 0, sob mutex
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif
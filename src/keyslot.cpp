@@ -0,0 +1,205 @@
+#include "keyslot.h"
+#include "header_journal.h"
+#include "session.h"
+#include "recipient.h"
+#include "aead.h"
+#include "memory_pool.h"
+#include "stats.h"
+#include <sodium.h>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+static_assert(DEK_BYTES <= SECRET_BLOCK_BYTES, "DEKs e KEKs cabem num bloco de segredo");
+
+static bool wrap_dek(KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                     const unsigned char kek[DEK_BYTES], const unsigned char dek[DEK_BYTES]) {
+    randombytes_buf(slot.nonce, sizeof(slot.nonce));
+    unsigned long long wlen;
+    return crypto_aead_xchacha20poly1305_ietf_encrypt(slot.wrapped, &wlen, dek, DEK_BYTES,
+                                                      core, HEADER_CORE_BYTES, NULL, slot.nonce, kek) == 0 &&
+           wlen == KEYSLOT_WRAPPED_BYTES;
+}
+
+static bool unwrap_dek(const KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                       const unsigned char kek[DEK_BYTES], unsigned char dek[DEK_BYTES]) {
+    unsigned long long dlen;
+    return crypto_aead_xchacha20poly1305_ietf_decrypt(dek, &dlen, NULL, slot.wrapped, sizeof(slot.wrapped),
+                                                      core, HEADER_CORE_BYTES, slot.nonce, kek) == 0 &&
+           dlen == DEK_BYTES;
+}
+
+bool seal_password_slot(KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                        const std::string& password, KeySession* session,
+                        const unsigned char dek[DEK_BYTES], const KdfParams& params) {
+    slot.kind = KEYSLOT_PASSWORD;
+    slot.kdf = params;
+    if (session) {
+        if (!session->batch_salt(slot.salt, params)) return false;
+        randombytes_buf(slot.file_id, sizeof(slot.file_id));
+        slot.has_file_id = true;
+    } else {
+        randombytes_buf(slot.salt, sizeof(slot.salt));
+        slot.has_file_id = false;
+    }
+
+    SecretBlock kek;
+    return derive_salted_key(slot.salt, slot.has_file_id ? slot.file_id : nullptr, password, session, kek.data(),
+                             params) &&
+           wrap_dek(slot, core, kek.data(), dek);
+}
+
+bool seal_recipient_slot(KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                         const RecipientSet& recipients, size_t index,
+                         const unsigned char dek[DEK_BYTES]) {
+    slot.kind = KEYSLOT_RECIPIENT;
+    std::memcpy(slot.salt, recipients.recipient(index).id, sizeof(slot.salt));
+    randombytes_buf(slot.file_id, sizeof(slot.file_id));
+    slot.has_file_id = true;
+
+    SecretBlock kek;
+    recipients.derive_kek(index, slot.file_id, kek.data());
+    return wrap_dek(slot, core, kek.data(), dek);
+}
+
+bool unlock_header(const FileHeader& hdr, const std::string& password, KeySession* session,
+                   unsigned char key[DEK_BYTES], int* slot_index) {
+    if (hdr.slots.empty()) {
+        if (slot_index) *slot_index = -1;
+        return derive_stream_key(hdr, password, session, key);
+    }
+
+    for (size_t i = 0; i < hdr.slots.size(); ++i) {
+        const KeySlot& slot = hdr.slots[i];
+        if (slot.kind != KEYSLOT_PASSWORD || !kdf_params_valid(slot.kdf)) continue;
+
+        SecretBlock kek;
+        bool ok = derive_salted_key(slot.salt, slot.has_file_id ? slot.file_id : nullptr, password, session,
+                                    kek.data(), slot.kdf) &&
+                  unwrap_dek(slot, hdr.core, kek.data(), key);
+        if (ok) {
+            if (slot_index) *slot_index = static_cast<int>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool unlock_header_identity(const FileHeader& hdr, const Identity& identity, unsigned char key[DEK_BYTES]) {
+    if (!hdr.has_ephemeral) return false;
+
+    const Recipient& self = identity.public_key();
+    for (const KeySlot& slot : hdr.slots) {
+        if (slot.kind != KEYSLOT_RECIPIENT || !slot.has_file_id) continue;
+        if (sodium_memcmp(slot.salt, self.id, sizeof(slot.salt)) != 0) continue;
+
+        SecretBlock kek;
+        bool ok = identity.derive_kek(hdr.ephemeral, slot.file_id, kek.data()) &&
+                  unwrap_dek(slot, hdr.core, kek.data(), key);
+        if (ok) return true;
+    }
+    return false;
+}
+
+bool init_file_header(FileHeader& hdr, const std::string& password, const CryptoOptions& options) {
+    CipherSuite cipher;
+    if (!aead_resolve(options.cipher, cipher, options.allow_unportable_cipher)) return false;
+    hdr.cipher = static_cast<uint8_t>(cipher);
+    if (options.compression != Compression::None) {
+        if (!compression_available(options.compression)) return false;
+        hdr.flags |= FLAG_COMPRESSED;
+    }
+    randombytes_buf(hdr.nonce_prefix, sizeof(hdr.nonce_prefix));
+
+    const RecipientSet* recipients = options.recipients;
+    if (recipients) {
+        if (!recipients->valid()) return false;
+        hdr.has_ephemeral = true;
+        std::memcpy(hdr.ephemeral, recipients->ephemeral(), sizeof(hdr.ephemeral));
+    }
+    bool password_slot = !recipients || !password.empty();
+    hdr.slots.resize((recipients ? recipients->size() : 0) + (password_slot ? 1 : 0));
+    return !hdr.slots.empty();
+}
+
+bool seal_file_header(FileHeader& hdr, const std::string& password, const CryptoOptions& options,
+                      unsigned char key[DEK_BYTES]) {
+    if (!prepare_header(hdr)) return false;
+
+    StageTimer timer(options.stats, Stage::Kdf);
+    randombytes_buf(key, DEK_BYTES);
+    const RecipientSet* recipients = options.recipients;
+    size_t recipient_count = recipients ? recipients->size() : 0;
+    bool ok = true;
+    for (size_t i = 0; i < recipient_count && ok; ++i)
+        ok = seal_recipient_slot(hdr.slots[i], hdr.core, *recipients, i, key);
+    if (ok && hdr.slots.size() > recipient_count)
+        ok = seal_password_slot(hdr.slots[recipient_count], hdr.core, password, options.session, key, options.kdf);
+    if (!ok) sodium_memzero(key, DEK_BYTES);
+    return ok;
+}
+
+bool unlock_file_header(const FileHeader& hdr, const std::string& password, const CryptoOptions& options,
+                        unsigned char key[DEK_BYTES]) {
+    StageTimer timer(options.stats, Stage::Kdf);
+    return options.identity ? unlock_header_identity(hdr, *options.identity, key)
+                            : unlock_header(hdr, password, options.session, key);
+}
+
+static bool rekey_header(int fd, const std::string& path, RekeyMode mode, const std::string& password, const std::string& new_password,
+                         KeySession* session, KeySession* new_session, const KdfParams& params) {
+    unsigned char core[HEADER_CORE_BYTES];
+    FileHeader hdr;
+    if (!pread_exact(fd, core, sizeof(core), 0) || !parse_header_core(core, sizeof(core), hdr)) return false;
+
+    std::vector<unsigned char> records(hdr.header_len - HEADER_CORE_BYTES);
+    if (!pread_exact(fd, records.data(), records.size(), HEADER_CORE_BYTES) ||
+        !parse_header_records(records.data(), records.size(), hdr))
+        return false;
+
+    // Arquivos sem keyslots cifram os segmentos com a própria chave da senha:
+    // trocar a senha exigiria recifrar tudo.
+    if (hdr.slots.empty()) return false;
+
+    SecretBlock dek;
+    int index;
+    if (!unlock_header(hdr, password, session, dek.data(), &index)) return false;
+
+    bool ok = true;
+    switch (mode) {
+    case RekeyMode::Replace:
+        ok = seal_password_slot(hdr.slots[index], hdr.core, new_password, new_session, dek.data(), params);
+        break;
+    case RekeyMode::Add: {
+        size_t passwords = 0;
+        for (const KeySlot& s : hdr.slots) passwords += s.kind == KEYSLOT_PASSWORD;
+        if (passwords >= MAX_PASSWORD_SLOTS) return false;
+        KeySlot slot;
+        ok = seal_password_slot(slot, hdr.core, new_password, new_session, dek.data(), params);
+        hdr.slots.push_back(slot);
+        break;
+    }
+    case RekeyMode::Remove:
+        ok = hdr.slots.size() > 1;
+        if (ok) hdr.slots.erase(hdr.slots.begin() + index);
+        break;
+    }
+    if (!ok) return false;
+
+    // header_len não muda: o novo header ocupa o mesmo espaço, os segmentos ficam intactos.
+    // O diário garante que uma queda no meio da escrita não perde os keyslots.
+    std::vector<unsigned char> header = serialize_header(hdr);
+    return !header.empty() && write_header_journaled(fd, path, header);
+}
+
+bool rekey_file(const std::string& path, RekeyMode mode, const std::string& password,
+                const std::string& new_password, KeySession* session, KeySession* new_session,
+                const KdfParams& params) {
+    if (!recover_header_journal(path)) return false;
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = rekey_header(fd, path, mode, password, new_password, session, new_session, params);
+    if (::close(fd) != 0) ok = false;
+    return ok;
+}
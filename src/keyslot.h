@@ -0,0 +1,59 @@
+#ifndef KEYSLOT_H
+#define KEYSLOT_H
+
+#include "format.h"
+#include "options.h"
+#include <string>
+
+class KeySession;
+class RecipientSet;
+class Identity;
+
+// Preenche um keyslot de senha para a DEK, derivando a KEK com params (gravados no slot).
+// O header já deve ter passado por prepare_header, pois o núcleo é autenticado junto com
+// a DEK embrulhada. Com session, o slot usa o salt do lote e um file_id próprio (sem novo Argon2).
+bool seal_password_slot(KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                        const std::string& password, KeySession* session,
+                        const unsigned char dek[DEK_BYTES], const KdfParams& params = KdfParams());
+
+// Preenche o slot do destinatário `index` de recipients: KEK do acordo de chaves com o
+// efêmero do lote e file_id próprio do slot. O header deve carregar o efêmero.
+bool seal_recipient_slot(KeySlot& slot, const unsigned char core[HEADER_CORE_BYTES],
+                         const RecipientSet& recipients, size_t index,
+                         const unsigned char dek[DEK_BYTES]);
+
+// Recupera a chave dos segmentos. Headers com keyslots: testa cada slot de senha com os
+// parâmetros gravados nele (slots com parâmetros fora dos limites são pulados) e devolve o
+// índice do slot aberto em *slot_index. Headers sem slots: deriva direto.
+bool unlock_header(const FileHeader& hdr, const std::string& password, KeySession* session,
+                   unsigned char key[DEK_BYTES], int* slot_index = nullptr);
+
+// Como unlock_header, mas abre o slot de destinatário de identity (sem senha nem Argon2).
+bool unlock_header_identity(const FileHeader& hdr, const Identity& identity, unsigned char key[DEK_BYTES]);
+
+// Header de um arquivo novo, em duas etapas. init_file_header escolhe a suíte, sorteia o
+// prefixo de nonce e reserva um keyslot por destinatário, mais o da senha (sempre sem
+// destinatários, e com eles só se a senha não for vazia). O chamador pode então acrescentar
+// registros; seal_file_header fixa o núcleo, sorteia a DEK e sela os keyslots.
+bool init_file_header(FileHeader& hdr, const std::string& password, const CryptoOptions& options);
+bool seal_file_header(FileHeader& hdr, const std::string& password, const CryptoOptions& options,
+                      unsigned char key[DEK_BYTES]);
+
+// unlock_header ou unlock_header_identity, conforme options.identity.
+bool unlock_file_header(const FileHeader& hdr, const std::string& password, const CryptoOptions& options,
+                        unsigned char key[DEK_BYTES]);
+
+// Operações de keyslot sobre um arquivo existente. Só o header é reescrito (no lugar, via
+// diário: ver header_journal.h), então o custo independe do tamanho do arquivo. O slot da nova senha usa params, o que
+// também permite subir o custo do Argon2 de arquivos antigos sem recifrá-los.
+enum class RekeyMode {
+    Replace,    // troca o slot da senha atual por um da nova senha
+    Add,        // mantém a senha atual e adiciona outra
+    Remove,     // remove o slot da senha informada (exige que reste outro)
+};
+
+bool rekey_file(const std::string& path, RekeyMode mode, const std::string& password,
+                const std::string& new_password, KeySession* session = nullptr,
+                KeySession* new_session = nullptr, const KdfParams& params = KdfParams());
+
+#endif
@@ -2,20 +2,43 @@
 #include "encrypt.h"
 #include "decrypt.h"
 #include "utils.h"
+#include "job_queue.h"
+#include "cli.h"
 
 #include <gtk/gtk.h>
 #include <sodium.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <thread>
-#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 #include <filesystem>
 
 static GtkWidget *entry_input = NULL;
 static GtkWidget *entry_output = NULL;
 static GtkWidget *entry_password = NULL;
 static GtkWidget *window_main = NULL;
+static GtkWidget *progress_bar = NULL;
+static GtkWidget *label_status = NULL;
+static GtkWidget *btn_cancel = NULL;
+
+// Arquivos escolhidos no Browse (um ou vários).
+static std::vector<std::string> selected_files;
+
+// Operações rodam na fila (job_queue.h), fora da thread do GTK; os eventos voltam ao laço
+// principal por g_idle_add. O progresso é coalescido: no máximo um idle pendente por vez.
+static JobQueue *jobs = NULL;
+static std::atomic<uint64_t> progress_job{0}, progress_done{0}, progress_total{0};
+static std::atomic<bool> progress_posted{false};
+static uint64_t current_job = 0;
+
+// Lote em andamento: o diálogo de resultado aparece quando a fila esvazia.
+static size_t batch_submitted = 0, batch_finished = 0, batch_ok = 0;
+static std::string batch_report;
 
 void show_message(const std::string& title, const std::string& message) {
     GtkWidget *dialog = gtk_message_dialog_new(
@@ -29,41 +52,93 @@ void show_message(const std::string& title, const std::string& message) {
     gtk_widget_destroy(dialog);
 }
 
+// Tela de boot sem bloquear: a janela principal já está pronta e responde enquanto as
+// linhas aparecem por timer; a tela some sozinha ou com um clique. --no-splash ou
+// CRYPTOFROG_SPLASH=0 pulam a tela.
+struct BootScreen {
+    GtkWidget *window;
+    GtkWidget *label;
+    std::string text;
+    size_t next_line = 0;
+};
+
+static const char *const BOOT_LINES[] = {
+    "[ OK ] Initializing CryptoFrog Engine...",
+    "[ OK ] AES-GCM secure channels online.",
+    "[ OK ] Curve ECCFrog512CK2 validated.",
+    "[ OK ] SapoGPT linked.",
+    "[ OK ] Argon2ID configured.",
+    "[ READY ] Launching GUI..."
+};
+static const size_t BOOT_LINE_COUNT = sizeof(BOOT_LINES) / sizeof(BOOT_LINES[0]);
+
+static gboolean on_boot_tick(gpointer data) {
+    BootScreen *boot = static_cast<BootScreen *>(data);
+    if (!boot->window) {
+        delete boot;
+        return G_SOURCE_REMOVE;
+    }
+    if (boot->next_line == BOOT_LINE_COUNT) {
+        gtk_widget_destroy(boot->window);   // on_boot_destroy zera boot->window
+        delete boot;
+        return G_SOURCE_REMOVE;
+    }
+    boot->text += std::string(BOOT_LINES[boot->next_line++]) + "\n";
+    gtk_label_set_text(GTK_LABEL(boot->label), boot->text.c_str());
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_boot_destroy(GtkWidget *, gpointer data) {
+    static_cast<BootScreen *>(data)->window = NULL;
+}
+
+static gboolean on_boot_click(GtkWidget *widget, GdkEventButton *, gpointer) {
+    gtk_widget_destroy(widget);
+    return TRUE;
+}
+
+static bool splash_enabled(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--no-splash") == 0) return false;
+    const char *env = std::getenv("CRYPTOFROG_SPLASH");
+    return !(env && std::strcmp(env, "0") == 0);
+}
+
 void show_boot_screen() {
-    GtkWidget *boot = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(boot), "CryptoFrog Bootloader 🐸");
-    gtk_window_set_default_size(GTK_WINDOW(boot), 460, 220);
-    gtk_window_set_resizable(GTK_WINDOW(boot), FALSE);
+    BootScreen *boot = new BootScreen;
+    boot->window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(boot->window), "CryptoFrog Bootloader 🐸");
+    gtk_window_set_default_size(GTK_WINDOW(boot->window), 460, 220);
+    gtk_window_set_resizable(GTK_WINDOW(boot->window), FALSE);
+    gtk_window_set_transient_for(GTK_WINDOW(boot->window), GTK_WINDOW(window_main));
+    gtk_window_set_position(GTK_WINDOW(boot->window), GTK_WIN_POS_CENTER_ON_PARENT);
 
     GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
     gtk_container_set_border_width(GTK_CONTAINER(box), 20);
-    gtk_container_add(GTK_CONTAINER(boot), box);
-
-    GtkWidget *label = gtk_label_new("");
-    gtk_widget_set_halign(label, GTK_ALIGN_START);
-    gtk_widget_set_valign(label, GTK_ALIGN_CENTER);
-    gtk_box_pack_start(GTK_BOX(box), label, TRUE, TRUE, 0);
-
-    gtk_widget_show_all(boot);
-
-    std::vector<std::string> lines = {
-        "[ OK ] Initializing CryptoFrog Engine...",
-        "[ OK ] AES-GCM secure channels online.",
-        "[ OK ] Curve ECCFrog512CK2 validated.",
-        "[ OK ] SapoGPT linked.",
-        "[ OK ] Argon2ID configured.",
-        "[ READY ] Launching GUI..."
-    };
+    gtk_container_add(GTK_CONTAINER(boot->window), box);
 
-    std::string output;
-    for (const auto& line : lines) {
-        output += line + "\n";
-        gtk_label_set_text(GTK_LABEL(label), output.c_str());
-        while (gtk_events_pending()) gtk_main_iteration();
-        std::this_thread::sleep_for(std::chrono::milliseconds(700));
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
-    gtk_widget_destroy(boot);
+    boot->label = gtk_label_new("");
+    gtk_widget_set_halign(boot->label, GTK_ALIGN_START);
+    gtk_widget_set_valign(boot->label, GTK_ALIGN_CENTER);
+    gtk_box_pack_start(GTK_BOX(box), boot->label, TRUE, TRUE, 0);
+
+    gtk_widget_add_events(boot->window, GDK_BUTTON_PRESS_MASK);
+    g_signal_connect(boot->window, "button-press-event", G_CALLBACK(on_boot_click), NULL);
+    g_signal_connect(boot->window, "destroy", G_CALLBACK(on_boot_destroy), boot);
+
+    gtk_widget_show_all(boot->window);
+    g_timeout_add(150, on_boot_tick, boot);
+}
+
+// Saída padrão de uma entrada: tira o .ecc ou acrescenta.
+static std::string default_output(const std::string &input) {
+    if (input.size() >= 4 && input.substr(input.size() - 4) == ".ecc")
+        return input.substr(0, input.size() - 4);
+    return input + ".ecc";
+}
+
+static std::string base_name(const std::string &path) {
+    return std::filesystem::path(path).filename().string();
 }
 
 void on_file_choose(GtkButton *, gpointer) {
@@ -74,60 +149,200 @@ void on_file_choose(GtkButton *, gpointer) {
         "_Cancel", GTK_RESPONSE_CANCEL,
         "_Open", GTK_RESPONSE_ACCEPT,
         NULL);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
 
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-        char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
-        if (filename) {
-            gtk_entry_set_text(GTK_ENTRY(entry_input), filename);
-            std::string fname(filename);
-            g_free(filename);
-
-            // Preencher automaticamente o output
-            if (fname.size() >= 4 && fname.substr(fname.size() - 4) == ".ecc") {
-                gtk_entry_set_text(GTK_ENTRY(entry_output), fname.substr(0, fname.size() - 4).c_str());
-            } else {
-                gtk_entry_set_text(GTK_ENTRY(entry_output), (fname + ".ecc").c_str());
-            }
+        GSList *names = gtk_file_chooser_get_filenames(GTK_FILE_CHOOSER(dialog));
+        selected_files.clear();
+        for (GSList *it = names; it; it = it->next) {
+            selected_files.push_back(static_cast<char *>(it->data));
+            g_free(it->data);
+        }
+        g_slist_free(names);
+
+        // Preencher automaticamente o output; com vários arquivos, cada saída fica ao lado da entrada
+        if (selected_files.size() == 1) {
+            gtk_entry_set_text(GTK_ENTRY(entry_input), selected_files[0].c_str());
+            gtk_entry_set_text(GTK_ENTRY(entry_output), default_output(selected_files[0]).c_str());
+        } else if (!selected_files.empty()) {
+            std::string text = std::to_string(selected_files.size()) + " files: " + base_name(selected_files[0]) + ", ...";
+            gtk_entry_set_text(GTK_ENTRY(entry_input), text.c_str());
+            gtk_entry_set_text(GTK_ENTRY(entry_output), "(next to each input file)");
         }
     }
     gtk_widget_destroy(dialog);
 }
 
-void on_encrypt_clicked(GtkButton *, gpointer) {
-    const gchar *input = gtk_entry_get_text(GTK_ENTRY(entry_input));
-    const gchar *output = gtk_entry_get_text(GTK_ENTRY(entry_output));
-    const gchar *password = gtk_entry_get_text(GTK_ENTRY(entry_password));
+// Eventos da fila entregues ao laço do GTK. O job vai sem a senha (event_job): em started
+// a fila ainda não a apagou, e a cópia ficaria no heap depois do delete.
+struct JobEvent {
+    uint64_t id;
+    Job job;
+    bool finished;
+    JobResult result;
+};
+
+static Job event_job(const Job &job) {
+    Job copy;
+    copy.kind = job.kind;
+    copy.input = job.input;
+    copy.output = job.output;
+    copy.shred_input = job.shred_input;
+    return copy;
+}
 
-    if (!input || !output || !password || !*input || !*output || !*password) {
-        show_message("Error", "All fields are required");
-        return;
+static void set_busy(bool busy) {
+    gtk_widget_set_sensitive(btn_cancel, busy);
+    if (!busy) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress_bar), 0);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(progress_bar), "");
+        gtk_label_set_text(GTK_LABEL(label_status), "Ready");
     }
-    if (!std::filesystem::exists(input)) {
-        show_message("Error", "Input file not found");
-        return;
+}
+
+static std::string result_line(const Job &job, const JobResult &result) {
+    bool enc = job.kind == JobKind::Encrypt;
+    if (result.cancelled) return base_name(job.input) + ": cancelled";
+    if (!result.ok) return base_name(job.input) + (enc ? ": encryption failed" : ": decryption failed");
+    if (enc && job.shred_input && !result.wiped) return base_name(job.input) + ": encrypted, original not wiped";
+    return base_name(job.input) + (enc ? ": encrypted" : ": decrypted");
+}
+
+// Resultado de um job sozinho, com as mesmas mensagens de antes da fila.
+static void show_single_result(const Job &job, const JobResult &result) {
+    bool enc = job.kind == JobKind::Encrypt;
+    const char *title = enc ? "Encryption" : "Decryption";
+    if (result.cancelled) {
+        show_message(title, "Operation cancelled.");
+    } else if (!result.ok) {
+        show_message(title, enc ? "Encryption failed!" : "Decryption failed!");
+    } else if (enc) {
+        // O original em claro é sobrescrito antes de sair do disco.
+        show_message(title, std::string(result.wiped ? "File encrypted successfully!"
+                                                     : "File encrypted, but the original could not be wiped.") +
+                                "\n\n" + result.summary);
+    } else {
+        show_message(title, "File decrypted successfully!\n\n" + result.summary);
+    }
+}
+
+static gboolean on_job_event(gpointer data) {
+    JobEvent *event = static_cast<JobEvent *>(data);
+    if (!window_main) {
+        delete event;
+        return G_SOURCE_REMOVE;
+    }
+    if (!event->finished) {
+        current_job = event->id;
+        std::string text = std::string(event->job.kind == JobKind::Encrypt ? "Encrypting " : "Decrypting ") +
+                           base_name(event->job.input) + " (" + std::to_string(batch_finished + 1) + " of " +
+                           std::to_string(batch_submitted) + ")";
+        gtk_label_set_text(GTK_LABEL(label_status), text.c_str());
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress_bar), 0);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(progress_bar), "key derivation...");
+        delete event;
+        return G_SOURCE_REMOVE;
     }
 
-    bool ok = encrypt_file(input, output, password);
-    if (ok) std::filesystem::remove(input);
-    show_message("Encryption", ok ? "File encrypted successfully!" : "Encryption failed!");
+    current_job = 0;
+    ++batch_finished;
+    if (event->result.ok) ++batch_ok;
+    batch_report += result_line(event->job, event->result) + "\n";
+    if (batch_finished == batch_submitted) {
+        set_busy(false);
+        if (batch_submitted == 1) {
+            show_single_result(event->job, event->result);
+        } else {
+            show_message("CryptoFrog", std::to_string(batch_ok) + " of " + std::to_string(batch_submitted) +
+                                           " files done.\n\n" + batch_report);
+        }
+        batch_submitted = batch_finished = batch_ok = 0;
+        batch_report.clear();
+    }
+    delete event;
+    return G_SOURCE_REMOVE;
 }
 
-void on_decrypt_clicked(GtkButton *, gpointer) {
-    const gchar *input = gtk_entry_get_text(GTK_ENTRY(entry_input));
+static gboolean on_progress_idle(gpointer) {
+    progress_posted = false;
+    if (!window_main || progress_job != current_job || current_job == 0) return G_SOURCE_REMOVE;
+    uint64_t done = progress_done, total = progress_total;
+    double fraction = total ? std::min(1.0, double(done) / total) : 0;
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.0f%% (%.1f of %.1f MiB)", fraction * 100, done / 1048576.0,
+                  total / 1048576.0);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress_bar), fraction);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(progress_bar), text);
+    return G_SOURCE_REMOVE;
+}
+
+static JobQueue::Callbacks gui_callbacks() {
+    JobQueue::Callbacks cb;
+    cb.started = [](uint64_t id, const Job &job) {
+        g_idle_add(on_job_event, new JobEvent{id, event_job(job), false, JobResult()});
+    };
+    cb.progress = [](uint64_t id, uint64_t done, uint64_t total) {
+        progress_job = id;
+        progress_done = done;
+        progress_total = total;
+        if (!progress_posted.exchange(true)) g_idle_add(on_progress_idle, NULL);
+    };
+    cb.finished = [](uint64_t id, const Job &job, const JobResult &result) {
+        g_idle_add(on_job_event, new JobEvent{id, event_job(job), true, result});
+    };
+    return cb;
+}
+
+// Enfileira a operação para os arquivos escolhidos; a janela segue respondendo.
+static void queue_selected(JobKind kind) {
     const gchar *output = gtk_entry_get_text(GTK_ENTRY(entry_output));
     const gchar *password = gtk_entry_get_text(GTK_ENTRY(entry_password));
 
-    if (!input || !output || !password || !*input || !*output || !*password) {
+    if (selected_files.empty() || !output || !password || !*output || !*password) {
         show_message("Error", "All fields are required");
         return;
     }
-    if (!std::filesystem::exists(input)) {
-        show_message("Error", "Encrypted file not found");
-        return;
+    for (const std::string &input : selected_files) {
+        if (!std::filesystem::exists(input)) {
+            show_message("Error", (kind == JobKind::Encrypt ? "Input file not found: " : "Encrypted file not found: ") +
+                                      input);
+            return;
+        }
+    }
+
+    for (const std::string &input : selected_files) {
+        Job job;
+        job.kind = kind;
+        job.input = input;
+        job.output = selected_files.size() == 1 ? std::string(output) : default_output(input);
+        job.password = password;
+        job.shred_input = kind == JobKind::Encrypt;
+        jobs->submit(std::move(job));
+        ++batch_submitted;
     }
+    set_busy(true);
+    if (!current_job) {
+        std::string text = std::to_string(batch_submitted - batch_finished) + " queued";
+        gtk_label_set_text(GTK_LABEL(label_status), text.c_str());
+    }
+}
 
-    bool ok = decrypt_file(input, output, password);
-    show_message("Decryption", ok ? "File decrypted successfully!" : "Decryption failed!");
+void on_encrypt_clicked(GtkButton *, gpointer) {
+    queue_selected(JobKind::Encrypt);
+}
+
+void on_decrypt_clicked(GtkButton *, gpointer) {
+    queue_selected(JobKind::Decrypt);
+}
+
+void on_cancel_clicked(GtkButton *, gpointer) {
+    jobs->cancel_all();
+    gtk_label_set_text(GTK_LABEL(label_status), "Cancelling...");
+}
+
+static void on_main_destroy(GtkWidget *, gpointer) {
+    window_main = NULL;
+    gtk_main_quit();
 }
 
 int main(int argc, char *argv[]) {
@@ -136,16 +351,19 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    gtk_init(&argc, &argv);
+    // Subcomandos rodam sem GTK (servidores, cron, sem display).
+    if (is_cli_command(argc, argv)) {
+        return run_cli(argc, argv);
+    }
 
-    show_boot_screen();
+    gtk_init(&argc, &argv);
 
     window_main = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window_main), "CryptoFrog 🐸");
     gtk_window_set_default_size(GTK_WINDOW(window_main), 500, 300);
     gtk_window_set_resizable(GTK_WINDOW(window_main), FALSE);
     gtk_container_set_border_width(GTK_CONTAINER(window_main), 12);
-    g_signal_connect(window_main, "destroy", G_CALLBACK(gtk_main_quit), NULL);
+    g_signal_connect(window_main, "destroy", G_CALLBACK(on_main_destroy), NULL);
 
     GtkCssProvider *provider = gtk_css_provider_new();
     gtk_css_provider_load_from_path(provider, "cryptofrog.css", NULL);
@@ -186,8 +404,26 @@ int main(int argc, char *argv[]) {
     g_signal_connect(btn_decrypt, "clicked", G_CALLBACK(on_decrypt_clicked), NULL);
     gtk_box_pack_start(GTK_BOX(btn_box), btn_decrypt, TRUE, TRUE, 0);
 
+    btn_cancel = gtk_button_new_with_label("Cancel");
+    g_signal_connect(btn_cancel, "clicked", G_CALLBACK(on_cancel_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(btn_box), btn_cancel, TRUE, TRUE, 0);
+
+    progress_bar = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(progress_bar), TRUE);
+    gtk_box_pack_start(GTK_BOX(vbox), progress_bar, FALSE, FALSE, 0);
+
+    label_status = gtk_label_new("");
+    gtk_widget_set_halign(label_status, GTK_ALIGN_START);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 0);
+
+    jobs = new JobQueue(gui_callbacks());
+
     gtk_widget_show_all(window_main);
+    set_busy(false);
+    if (splash_enabled(argc, argv)) show_boot_screen();
     gtk_main();
 
+    // Cancela o que ainda estiver na fila e espera o job em andamento parar.
+    delete jobs;
     return 0;
 }
\ No newline at end of file
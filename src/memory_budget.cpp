@@ -0,0 +1,105 @@
+#include "memory_budget.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+MemoryBudget::MemoryBudget(uint64_t bytes, unsigned slots) {
+    stats.limit_bytes = bytes;
+    stats.limit_slots = std::max(1u, slots);
+}
+
+MemoryBudget::Reservation MemoryBudget::reserve(uint64_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t ticket = next_ticket++;
+    auto admissible = [&] {
+        if (ticket != serving) return false;
+        if (slots_used == 0) return true;
+        return slots_used < stats.limit_slots && bytes_used + bytes <= stats.limit_bytes;
+    };
+    if (!admissible()) {
+        stats.waited++;
+        cv.wait(lock, admissible);
+    }
+    bytes_used += bytes;
+    slots_used++;
+    serving++;
+    stats.admitted++;
+    stats.peak_bytes = std::max(stats.peak_bytes, bytes_used);
+    stats.peak_slots = std::max(stats.peak_slots, slots_used);
+
+    // O próximo da fila pode caber também.
+    cv.notify_all();
+    return Reservation(this, bytes);
+}
+
+void MemoryBudget::release(uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_used -= bytes;
+        slots_used--;
+    }
+    cv.notify_all();
+}
+
+void MemoryBudget::configure(uint64_t bytes, unsigned slots) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.limit_bytes = bytes;
+        stats.limit_slots = std::max(1u, slots);
+    }
+    cv.notify_all();
+}
+
+MemoryBudget::Usage MemoryBudget::usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+// Lê um limite de cgroup; "max" (sem limite), ausência ou lixo viram 0.
+static uint64_t read_limit(const std::string& path) {
+    std::ifstream in(path);
+    std::string text;
+    if (!(in >> text) || text == "max") return 0;
+    try {
+        return std::stoull(text);
+    } catch (...) {
+        return 0;
+    }
+}
+
+static uint64_t cgroup_limit() {
+    // cgroup v2: o limite efetivo é o menor entre o grupo do processo e os ancestrais.
+    uint64_t limit = 0;
+    std::ifstream self("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(self, line)) {
+        if (line.compare(0, 3, "0::") != 0) continue;
+        std::string path = line.substr(3);
+        for (;;) {
+            uint64_t v = read_limit("/sys/fs/cgroup" + path + "/memory.max");
+            if (v && (!limit || v < limit)) limit = v;
+            if (path.empty() || path == "/") break;
+            path = path.substr(0, path.find_last_of('/'));
+        }
+    }
+    // cgroup v1: valores absurdos (sem limite) ficam acima da RAM e são descartados pelo chamador.
+    uint64_t v1 = read_limit("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+    if (v1 && (!limit || v1 < limit)) limit = v1;
+    return limit;
+}
+
+uint64_t detect_memory_limit() {
+    long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGESIZE);
+    uint64_t physical = pages > 0 && page_size > 0 ? static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size)
+                                                   : 0;
+    uint64_t cgroup = cgroup_limit();
+    if (!physical) return cgroup;
+    return cgroup ? std::min(physical, cgroup) : physical;
+}
+
+MemoryBudget& kdf_budget() {
+    static MemoryBudget budget(detect_memory_limit() / 4 * 3, ThreadPool::resolve_threads(0));
+    return budget;
+}
@@ -0,0 +1,73 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Orçamento de memória e de núcleos para etapas pesadas que rodam em paralelo (Argon2).
+//
+// Cada derivação reserva a memória que o Argon2 vai alocar e um slot (um por núcleo: o
+// Argon2 da libsodium usa uma thread). Quem não cabe espera na fila, por ordem de chegada,
+// enquanto os outros jobs seguem com a E/S e a cifra, que usam pouca memória. Uma reserva
+// maior que o orçamento inteiro é admitida sozinha, para não travar a fila.
+class MemoryBudget {
+public:
+    MemoryBudget(uint64_t bytes, unsigned slots);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // Devolve a reserva ao sair de escopo.
+    class Reservation {
+    public:
+        Reservation(Reservation&& other) noexcept : budget(other.budget), bytes(other.bytes) { other.budget = nullptr; }
+        ~Reservation() { if (budget) budget->release(bytes); }
+
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+        Reservation& operator=(Reservation&&) = delete;
+
+    private:
+        friend class MemoryBudget;
+        Reservation(MemoryBudget* owner, uint64_t reserved) : budget(owner), bytes(reserved) {}
+        MemoryBudget* budget;
+        uint64_t bytes;
+    };
+
+    // Bloqueia até bytes e um slot caberem no orçamento.
+    Reservation reserve(uint64_t bytes);
+
+    // Novos limites; reservas em andamento continuam valendo.
+    void configure(uint64_t bytes, unsigned slots);
+
+    struct Usage {
+        uint64_t limit_bytes = 0;
+        unsigned limit_slots = 0;
+        uint64_t peak_bytes = 0;
+        unsigned peak_slots = 0;
+        uint64_t admitted = 0;
+        uint64_t waited = 0;   // reservas que tiveram de esperar
+    };
+    Usage usage() const;
+
+private:
+    void release(uint64_t bytes);
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    uint64_t bytes_used = 0;
+    unsigned slots_used = 0;
+    uint64_t next_ticket = 0, serving = 0;
+    Usage stats;
+};
+
+// Memória disponível para o processo: a menor entre a RAM física e o limite do cgroup
+// (memory.max no v2, memory.limit_in_bytes no v1).
+uint64_t detect_memory_limit();
+
+// Orçamento global das derivações de senha: 3/4 de detect_memory_limit() (o resto fica para
+// os buffers de segmentos e o próprio processo) e um slot por núcleo.
+MemoryBudget& kdf_budget();
+
+#endif
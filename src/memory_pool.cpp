@@ -0,0 +1,150 @@
+#include "memory_pool.h"
+#include <sodium.h>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+static const size_t REGION_BLOCKS = 256;   // 16 KiB travados por região
+static const size_t PAGE_BYTES = 4096;
+static const size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+
+unsigned char* SecureArena::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_blocks.empty()) {
+        // Regiões não são devolvidas: a arena vive o processo inteiro. Se sodium_malloc
+        // falhar, a região vem do heap comum (ainda zerada na devolução, mas sem mlock).
+        const size_t region_bytes = REGION_BLOCKS * SECRET_BLOCK_BYTES;
+        unsigned char* region = static_cast<unsigned char*>(sodium_malloc(region_bytes));
+        if (region) {
+            totals.locked_bytes += region_bytes;
+        } else {
+            region = static_cast<unsigned char*>(std::calloc(REGION_BLOCKS, SECRET_BLOCK_BYTES));
+            if (!region) throw std::bad_alloc();
+            totals.unlocked_bytes += region_bytes;
+        }
+        sodium_memzero(region, region_bytes);
+        for (size_t i = REGION_BLOCKS; i-- > 0;) free_blocks.push_back(region + i * SECRET_BLOCK_BYTES);
+    }
+    unsigned char* block = free_blocks.back();
+    free_blocks.pop_back();
+    totals.blocks++;
+    totals.in_use++;
+    totals.peak_in_use = std::max(totals.peak_in_use, totals.in_use);
+    return block;
+}
+
+void SecureArena::release(unsigned char* block) {
+    sodium_memzero(block, SECRET_BLOCK_BYTES);
+    std::lock_guard<std::mutex> lock(mutex);
+    free_blocks.push_back(block);
+    totals.in_use--;
+}
+
+SecureArena::Counters SecureArena::counters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+SecureArena& secure_arena() {
+    // Nunca destruída: blocos podem ser devolvidos por objetos estáticos durante o encerramento.
+    static SecureArena* arena = new SecureArena;
+    return *arena;
+}
+
+BufferPool::Lease& BufferPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool = other.pool;
+        ptr = other.ptr;
+        bytes = other.bytes;
+        capacity = other.capacity;
+        other.pool = nullptr;
+        other.ptr = nullptr;
+        other.bytes = other.capacity = 0;
+    }
+    return *this;
+}
+
+void BufferPool::Lease::reset() {
+    if (ptr) pool->release(ptr, capacity);
+    pool = nullptr;
+    ptr = nullptr;
+    bytes = capacity = 0;
+}
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+BufferPool::Lease BufferPool::acquire(size_t bytes) {
+    Lease lease;
+    if (bytes == 0) return lease;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    const bool huge = huge_pages && bytes >= HUGE_PAGE_BYTES;
+    const size_t align = huge ? HUGE_PAGE_BYTES : PAGE_BYTES;
+    const size_t capacity = (bytes + align - 1) / align * align;
+
+    auto bucket = idle.find(capacity);
+    if (bucket != idle.end() && !bucket->second.empty()) {
+        lease.ptr = bucket->second.back();
+        bucket->second.pop_back();
+        totals.idle_bytes -= capacity;
+        totals.reuses++;
+    } else {
+        lock.unlock();
+        void* p = nullptr;
+        if (posix_memalign(&p, align, capacity) != 0) throw std::bad_alloc();
+        if (huge) madvise(p, capacity, MADV_HUGEPAGE);   // só uma dica: sem THP, páginas comuns
+        lease.ptr = static_cast<unsigned char*>(p);
+        lock.lock();
+        totals.allocations++;
+        if (huge) totals.huge_page_bytes += capacity;
+    }
+    lease.pool = this;
+    lease.bytes = bytes;
+    lease.capacity = capacity;
+    return lease;
+}
+
+void BufferPool::release(unsigned char* ptr, size_t capacity) {
+    // Os lotes guardam texto claro: nada fica no pool sem ser zerado.
+    sodium_memzero(ptr, capacity);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (totals.idle_bytes + capacity > idle_limit) {
+        std::free(ptr);
+        return;
+    }
+    idle[capacity].push_back(ptr);
+    totals.idle_bytes += capacity;
+}
+
+void BufferPool::set_huge_pages(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    huge_pages = enabled;
+}
+
+void BufferPool::set_idle_limit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle_limit = bytes;
+}
+
+void BufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& bucket : idle)
+        for (unsigned char* ptr : bucket.second) std::free(ptr);
+    idle.clear();
+    totals.idle_bytes = 0;
+}
+
+BufferPool::Counters BufferPool::counters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+BufferPool& io_buffer_pool() {
+    // Nunca destruído, pelo mesmo motivo da arena: leases podem sobreviver a main().
+    static BufferPool* pool = new BufferPool;
+    return *pool;
+}
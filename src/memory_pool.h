@@ -0,0 +1,120 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Memória reaproveitada entre operações do processo (jobs da CLI, fila da GUI).
+//
+// Segredos (DEKs, KEKs, chaves mestras) ficam em blocos de SECRET_BLOCK_BYTES tirados de
+// regiões de sodium_malloc: páginas travadas com mlock (fora do swap), guard pages em volta.
+// Uma região atende muitos blocos, então a chave de cada arquivo não custa mmap/mprotect.
+// Cada bloco é zerado ao voltar para a arena.
+//
+// Buffers de E/S (lotes de segmentos) vêm de um pool de buffers alinhados à página, ou a
+// 2 MiB com transparent huge pages (set_huge_pages). Buffers devolvidos são zerados e
+// guardados por tamanho para o próximo arquivo, até idle_limit bytes ociosos.
+
+static const size_t SECRET_BLOCK_BYTES = 64;
+
+class SecureArena {
+public:
+    struct Counters {
+        uint64_t blocks = 0;          // blocos entregues desde o início
+        uint64_t in_use = 0, peak_in_use = 0;
+        uint64_t locked_bytes = 0;    // regiões de sodium_malloc (mlock sujeito a RLIMIT_MEMLOCK)
+        uint64_t unlocked_bytes = 0;  // regiões comuns, se sodium_malloc falhar
+    };
+
+    SecureArena() = default;
+    SecureArena(const SecureArena&) = delete;
+    SecureArena& operator=(const SecureArena&) = delete;
+
+    unsigned char* acquire();                 // bloco zerado
+    void release(unsigned char* block);       // zera e devolve
+    Counters counters() const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<unsigned char*> free_blocks;
+    Counters totals;
+};
+
+SecureArena& secure_arena();
+
+// Bloco de segredo com escopo: nasce zerado e é zerado ao sair de escopo.
+class SecretBlock {
+public:
+    SecretBlock() : block(secure_arena().acquire()) {}
+    ~SecretBlock() { secure_arena().release(block); }
+
+    SecretBlock(const SecretBlock&) = delete;
+    SecretBlock& operator=(const SecretBlock&) = delete;
+
+    unsigned char* data() { return block; }
+    const unsigned char* data() const { return block; }
+
+private:
+    unsigned char* block;
+};
+
+class BufferPool {
+public:
+    // Buffer emprestado; volta ao pool quando sai de escopo. Vazio para pedidos de 0 bytes.
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept { *this = std::move(other); }
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease() { reset(); }
+
+        unsigned char* data() const { return ptr; }
+        size_t size() const { return bytes; }
+        void reset();
+
+    private:
+        friend class BufferPool;
+        BufferPool* pool = nullptr;
+        unsigned char* ptr = nullptr;
+        size_t bytes = 0;
+        size_t capacity = 0;
+    };
+
+    struct Counters {
+        uint64_t allocations = 0;   // buffers novos
+        uint64_t reuses = 0;        // pedidos atendidos por um buffer ocioso
+        uint64_t idle_bytes = 0;
+        uint64_t huge_page_bytes = 0;   // alocados com MADV_HUGEPAGE
+    };
+
+    BufferPool() = default;
+    ~BufferPool();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    Lease acquire(size_t bytes);
+
+    // Buffers de 2 MiB ou mais passam a ser alinhados a 2 MiB e marcados com MADV_HUGEPAGE.
+    void set_huge_pages(bool enabled);
+    void set_idle_limit(size_t bytes);
+    void trim();   // libera todos os buffers ociosos
+
+    Counters counters() const;
+
+private:
+    void release(unsigned char* ptr, size_t capacity);
+
+    mutable std::mutex mutex;
+    std::map<size_t, std::vector<unsigned char*>> idle;   // por capacidade
+    bool huge_pages = false;
+    size_t idle_limit = size_t(256) << 20;
+    Counters totals;
+};
+
+BufferPool& io_buffer_pool();
+
+#endif
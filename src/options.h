@@ -0,0 +1,59 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "aead.h"
+#include "compress.h"
+#include "format.h"
+#include "io_backend.h"
+
+class KeySession;
+class RecipientSet;
+class Identity;
+class OperationStats;
+class JobProgress;
+
+// Ajustes de execução compartilhados por encrypt_file/decrypt_file.
+// Fora cipher, allow_unportable_cipher, compression e kdf, não alteram o formato: o mesmo arquivo é produzido com
+// qualquer combinação.
+struct CryptoOptions {
+    // Threads usadas para selar/abrir segmentos. 0 = todos os núcleos, 1 = single-thread.
+    unsigned threads = 0;
+
+    // Backend de leitura/escrita dos arquivos.
+    IoBackend io = IoBackend::Stream;
+
+    // Suíte de cifra dos segmentos de arquivos novos. A decifragem usa a suíte gravada no
+    // header, qualquer que seja esta escolha.
+    CipherChoice cipher = CipherChoice::Auto;
+
+    // Permite gravar suítes que nem todo build abre (AEGIS-256, ver aead_portable); sem
+    // isso, Aegis256 é recusada e Fastest escolhe só entre as portáveis.
+    bool allow_unportable_cipher = false;
+
+    // Compressão dos segmentos de arquivos novos, gravada no header (FLAG_COMPRESSED).
+    // Segmentos que a amostra de entropia aponta como incompressíveis vão crus.
+    Compression compression = Compression::None;
+
+    // Parâmetros do Argon2 do slot de senha de arquivos novos, gravados no próprio slot.
+    // A decifragem usa os parâmetros de cada slot, qualquer que seja esta escolha.
+    KdfParams kdf;
+
+    // Sessão de chaves de um lote (opcional). Com ela, o Argon2 roda uma vez por lote e
+    // cada arquivo usa uma subchave própria; sem ela, cada arquivo roda o Argon2.
+    KeySession* session = nullptr;
+
+    // Modo de chave pública (opcional). Na cifragem, recipients embrulha a DEK para cada
+    // destinatário (a senha só ganha slot se não for vazia); na decifragem, identity abre
+    // o slot do destinatário em vez de usar a senha.
+    const RecipientSet* recipients = nullptr;
+    const Identity* identity = nullptr;
+
+    // Medidas por estágio (opcional, ver stats.h): tempo de KDF, leitura, cifra e escrita,
+    // bytes e pico de memória. Pode ser compartilhado entre jobs paralelos.
+    OperationStats* stats = nullptr;
+
+    // Progresso em bytes de entrada e pedido de cancelamento (opcional, ver progress.h).
+    JobProgress* progress = nullptr;
+};
+
+#endif
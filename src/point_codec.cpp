@@ -0,0 +1,90 @@
+#include "point_codec.h"
+#include <cstring>
+
+void store_be512(unsigned char out[64], const uint64_t limbs[8]) {
+    for (int i = 0; i < 8; ++i) {
+        uint64_t w = limbs[7 - i];
+        for (int j = 7; j >= 0; --j) {
+            out[i * 8 + j] = static_cast<unsigned char>(w);
+            w >>= 8;
+        }
+    }
+}
+
+void load_be512(uint64_t limbs[8], const unsigned char in[64]) {
+    for (int i = 0; i < 8; ++i) {
+        uint64_t w = 0;
+        for (int j = 0; j < 8; ++j) w = (w << 8) | in[i * 8 + j];
+        limbs[7 - i] = w;
+    }
+}
+
+bool mpz_to_be_bytes(unsigned char* out, size_t len, const mpz_class& z) {
+    if (sgn(z) < 0) return false;
+    size_t bytes = (mpz_sizeinbase(z.get_mpz_t(), 2) + 7) / 8;
+    if (bytes > len) return false;
+
+    std::memset(out, 0, len);
+    size_t count = 0;
+    mpz_export(out + len - bytes, &count, 1, 1, 0, 0, z.get_mpz_t());
+    return true;
+}
+
+void mpz_from_be_bytes(mpz_class& z, const unsigned char* in, size_t len) {
+    mpz_import(z.get_mpz_t(), len, 1, 1, 0, 0, in);
+}
+
+void encode_fp(unsigned char out[64], const Fp512& a) {
+    uint64_t plain[8];
+    fp_from_mont(plain, a);
+    store_be512(out, plain);
+}
+
+bool decode_fp(Fp512& r, const unsigned char in[64]) {
+    uint64_t plain[8];
+    load_be512(plain, in);
+    return fp_from_limbs(r, plain);
+}
+
+size_t encode_point_compressed(unsigned char* out, size_t out_len, const AffinePoint& P) {
+    if (P.infinity || out_len < COMPRESSED_POINT_BYTES) return 0;
+    out[0] = fp_is_odd(P.y) ? 0x03 : 0x02;
+    encode_fp(out + 1, P.x);
+    return COMPRESSED_POINT_BYTES;
+}
+
+size_t encode_point_uncompressed(unsigned char* out, size_t out_len, const AffinePoint& P) {
+    if (P.infinity || out_len < UNCOMPRESSED_POINT_BYTES) return 0;
+    out[0] = 0x04;
+    encode_fp(out + 1, P.x);
+    encode_fp(out + 1 + COORD_BYTES, P.y);
+    return UNCOMPRESSED_POINT_BYTES;
+}
+
+bool decode_point(AffinePoint& P, const unsigned char* in, size_t len) {
+    if (len == COMPRESSED_POINT_BYTES && (in[0] == 0x02 || in[0] == 0x03)) {
+        Fp512 x;
+        return decode_fp(x, in + 1) && affine_decompress(P, x, in[0] == 0x03);
+    }
+    if (len == UNCOMPRESSED_POINT_BYTES && in[0] == 0x04) {
+        P.infinity = false;
+        return decode_fp(P.x, in + 1) && decode_fp(P.y, in + 1 + COORD_BYTES) && affine_on_curve(P);
+    }
+    return false;
+}
+
+size_t encode_scalar(unsigned char* out, size_t out_len, const uint64_t k[8]) {
+    if (out_len < SCALAR_BYTES) return 0;
+    store_be512(out, k);
+    return SCALAR_BYTES;
+}
+
+bool decode_scalar(uint64_t k[8], const unsigned char* in, size_t len) {
+    if (len != SCALAR_BYTES) return false;
+    load_be512(k, in);
+    for (int i = 7; i >= 0; --i) {
+        if (k[i] < ecc_const::N[i]) return true;
+        if (k[i] > ecc_const::N[i]) return false;
+    }
+    return false;   // k == n
+}
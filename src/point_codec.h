@@ -0,0 +1,43 @@
+#ifndef POINT_CODEC_H
+#define POINT_CODEC_H
+
+#include "ecpoint.h"
+#include <gmpxx.h>
+#include <cstddef>
+#include <cstdint>
+
+// Binary encodings for ECCFrog512CK2 keys, written straight into caller buffers: no hex
+// strings and no intermediate vectors. Coordinates and scalars are 64 big-endian bytes.
+//
+//   compressed     0x02 | 0x03 (parity of y) || x     65 bytes
+//   uncompressed   0x04 || x || y                      129 bytes
+//   scalar         k                                   64 bytes
+
+static const size_t COORD_BYTES = 64;
+static const size_t SCALAR_BYTES = 64;
+static const size_t COMPRESSED_POINT_BYTES = 1 + COORD_BYTES;
+static const size_t UNCOMPRESSED_POINT_BYTES = 1 + 2 * COORD_BYTES;
+
+// 8 little-endian limbs <-> 64 big-endian bytes.
+void store_be512(unsigned char out[64], const uint64_t limbs[8]);
+void load_be512(uint64_t limbs[8], const unsigned char in[64]);
+
+// mpz <-> big-endian bytes, left-padded to len. false if z is negative or does not fit.
+bool mpz_to_be_bytes(unsigned char* out, size_t len, const mpz_class& z);
+void mpz_from_be_bytes(mpz_class& z, const unsigned char* in, size_t len);
+
+// Field elements travel as their plain value; decode_fp rejects values >= p.
+void encode_fp(unsigned char out[64], const Fp512& a);
+bool decode_fp(Fp512& r, const unsigned char in[64]);
+
+// Encoders return the bytes written, 0 if out_len is too small or P is the point at infinity.
+// decode_point takes either form and rejects non-canonical coordinates and points off the curve.
+size_t encode_point_compressed(unsigned char* out, size_t out_len, const AffinePoint& P);
+size_t encode_point_uncompressed(unsigned char* out, size_t out_len, const AffinePoint& P);
+bool decode_point(AffinePoint& P, const unsigned char* in, size_t len);
+
+// Scalars; decode_scalar rejects values >= n.
+size_t encode_scalar(unsigned char* out, size_t out_len, const uint64_t k[8]);
+bool decode_scalar(uint64_t k[8], const unsigned char* in, size_t len);
+
+#endif
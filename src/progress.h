@@ -0,0 +1,44 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// Progresso e cancelamento de uma operação em andamento (CryptoOptions::progress).
+// O leitor do pipeline de segmentos soma os bytes de entrada de cada lote e, antes de ler
+// o próximo, consulta cancelled(): uma operação cancelada falha como qualquer erro e
+// encrypt_file/decrypt_file apagam a saída parcial. O Argon2 não é interrompido; o
+// cancelamento vale a partir do primeiro lote.
+class JobProgress {
+public:
+    // Chamado na thread do leitor a cada lote, com os bytes lidos até ali; quem atualiza
+    // interface deve repassar para a própria thread (g_idle_add na GUI).
+    typedef std::function<void(uint64_t done, uint64_t total)> Callback;
+
+    explicit JobProgress(uint64_t total = 0, Callback callback = Callback())
+        : total_bytes(total), on_advance(std::move(callback)) {}
+
+    JobProgress(const JobProgress&) = delete;
+    JobProgress& operator=(const JobProgress&) = delete;
+
+    void advance(uint64_t bytes) {
+        uint64_t now = done_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (on_advance) on_advance(now, total_bytes);
+    }
+
+    uint64_t done() const { return done_bytes.load(std::memory_order_relaxed); }
+    uint64_t total() const { return total_bytes; }
+
+    // Pode ser chamado de qualquer thread.
+    void cancel() { cancel_flag.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancel_flag.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> done_bytes{0};
+    std::atomic<bool> cancel_flag{false};
+    const uint64_t total_bytes;
+    Callback on_advance;
+};
+
+#endif
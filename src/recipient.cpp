@@ -0,0 +1,215 @@
+#include "recipient.h"
+#include "point_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Contexto de domínio da KEK de destinatário.
+static const char RECIPIENT_KEK_CONTEXT[] = "cryptofrog.recipient-kek.v1";
+
+static_assert(EPHEMERAL_KEY_BYTES == COMPRESSED_POINT_BYTES, "efêmero é um ponto comprimido");
+static_assert(COORD_BYTES <= SECRET_BLOCK_BYTES, "x compartilhado cabe num bloco de segredo");
+
+static const ECCFrog512CK2& curve() {
+    static const ECCFrog512CK2 instance;
+    return instance;
+}
+
+// Zera os limbs antes de liberar: o destrutor do mpz não limpa a memória.
+static void wipe_mpz(mpz_class& z) {
+    size_t limbs = mpz_size(z.get_mpz_t());
+    if (limbs) sodium_memzero(mpz_limbs_modify(z.get_mpz_t(), limbs), limbs * sizeof(mp_limb_t));
+    z = 0;
+}
+
+// Escalar uniforme em [1, n-1].
+static void random_scalar(mpz_class& k) {
+    const mpz_class n = curve().get_n();
+    unsigned char buf[SCALAR_BYTES + 16];
+    do {
+        randombytes_buf(buf, sizeof(buf));
+        mpz_from_be_bytes(k, buf, sizeof(buf));
+        k %= n;
+    } while (k == 0);
+    sodium_memzero(buf, sizeof(buf));
+}
+
+static void recipient_kek(const unsigned char shared_x[COORD_BYTES], const unsigned char ephemeral[EPHEMERAL_KEY_BYTES],
+                          const unsigned char recipient[EPHEMERAL_KEY_BYTES], const unsigned char file_id[FILE_ID_BYTES],
+                          unsigned char kek[RECIPIENT_KEK_BYTES]) {
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, shared_x, COORD_BYTES, RECIPIENT_KEK_BYTES);
+    crypto_generichash_update(&state, reinterpret_cast<const unsigned char*>(RECIPIENT_KEK_CONTEXT),
+                              sizeof(RECIPIENT_KEK_CONTEXT) - 1);
+    crypto_generichash_update(&state, ephemeral, EPHEMERAL_KEY_BYTES);
+    crypto_generichash_update(&state, recipient, EPHEMERAL_KEY_BYTES);
+    crypto_generichash_update(&state, file_id, FILE_ID_BYTES);
+    crypto_generichash_final(&state, kek, RECIPIENT_KEK_BYTES);
+    sodium_memzero(&state, sizeof(state));
+}
+
+// x(k·P) em 64 bytes; falso se o ponto é inválido ou o resultado é o infinito.
+static bool shared_x(const ECCFrog512CK2::Point& P, const mpz_class& k, unsigned char out[COORD_BYTES]) {
+    try {
+        mpz_class x = curve().ecdh_x(P, k);
+        bool ok = mpz_to_be_bytes(out, COORD_BYTES, x);
+        wipe_mpz(x);
+        return ok;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void make_recipient(const ECCFrog512CK2::Point& point, Recipient& r) {
+    r.point = point;
+    point.encode_compressed(r.encoded, sizeof(r.encoded));
+    crypto_generichash(r.id, sizeof(r.id), r.encoded, sizeof(r.encoded), NULL, 0);
+}
+
+bool load_recipient(const std::string& path, Recipient& r, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    try {
+        ECCFrog512CK2::Point point = curve().point_from_pgp(text.str());
+        if (point.at_infinity) throw std::runtime_error("point at infinity");
+        make_recipient(point, r);
+    } catch (const std::exception& e) {
+        error = path + ": " + e.what();
+        return false;
+    }
+    return true;
+}
+
+RecipientSet::RecipientSet(const std::vector<Recipient>& recipients)
+    : list(recipients), shared(new SecretBlock[recipients.size()]) {
+    if (list.empty()) return;
+
+    // Escalares secretos passam só pelos caminhos em tempo constante.
+    mpz_class e;
+    random_scalar(e);
+    ECCFrog512CK2::Point E = curve().scalar_mul_ct(curve().get_G(), e);
+    E.encode_compressed(eph, sizeof(eph));
+
+    ready = true;
+    for (size_t i = 0; i < list.size() && ready; ++i) {
+        ready = shared_x(list[i].point, e, shared[i].data());
+    }
+    wipe_mpz(e);
+}
+
+void RecipientSet::derive_kek(size_t i, const unsigned char file_id[FILE_ID_BYTES],
+                              unsigned char kek[RECIPIENT_KEK_BYTES]) const {
+    recipient_kek(shared[i].data(), eph, list[i].encoded, file_id, kek);
+}
+
+Identity::~Identity() {
+    wipe_mpz(secret);
+}
+
+bool Identity::set_secret(const mpz_class& d) {
+    if (d <= 0 || d >= curve().get_n()) return false;
+    secret = d;
+    make_recipient(curve().scalar_mul_ct(curve().get_G(), secret), pub);
+    ready = true;
+    return true;
+}
+
+bool Identity::generate() {
+    mpz_class d;
+    random_scalar(d);
+    bool ok = set_secret(d);
+    wipe_mpz(d);
+    return ok;
+}
+
+bool Identity::load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        error = "cannot read " + path;
+        return false;
+    }
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n' || line.back() == ' ')) line.pop_back();
+
+    mpz_class d;
+    bool ok = line.size() == 2 * SCALAR_BYTES && d.set_str(line, 16) == 0 && set_secret(d);
+    wipe_mpz(d);
+    sodium_memzero(&line[0], line.size());
+    if (!ok) error = path + ": not a cryptofrog secret key";
+    return ok;
+}
+
+static bool write_key_file(const std::string& path, const std::string& text, mode_t mode, bool overwrite) {
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL);
+    int fd = ::open(path.c_str(), flags, mode);
+    if (fd < 0) return false;
+    bool ok = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()) && ::fsync(fd) == 0;
+    if (::close(fd) != 0) ok = false;
+    return ok;
+}
+
+bool Identity::save(const std::string& base, bool overwrite, std::string& error) const {
+    if (!ready) {
+        error = "no key";
+        return false;
+    }
+    unsigned char raw[SCALAR_BYTES];
+    mpz_to_be_bytes(raw, sizeof(raw), secret);
+    std::string hex(2 * sizeof(raw) + 1, '\0');
+    sodium_bin2hex(&hex[0], hex.size(), raw, sizeof(raw));
+    hex.back() = '\n';
+    sodium_memzero(raw, sizeof(raw));
+
+    bool ok = write_key_file(base + ".key", hex, 0600, overwrite);
+    sodium_memzero(&hex[0], hex.size());
+    if (!ok) {
+        error = "cannot write " + base + ".key";
+        return false;
+    }
+    if (!write_key_file(base + ".pub", pub.point.to_compressed_hex() + "\n", 0644, overwrite)) {
+        error = "cannot write " + base + ".pub";
+        return false;
+    }
+    return true;
+}
+
+bool Identity::derive_kek(const unsigned char ephemeral[EPHEMERAL_KEY_BYTES], const unsigned char file_id[FILE_ID_BYTES],
+                          unsigned char kek[RECIPIENT_KEK_BYTES]) const {
+    if (!ready) return false;
+    std::string id(reinterpret_cast<const char*>(ephemeral), EPHEMERAL_KEY_BYTES);
+
+    // O lock cobre o acordo de chaves: arquivos paralelos do mesmo lote esperam o primeiro.
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(shared.begin(), shared.end(),
+                           [&](const std::pair<std::string, SecretBlock>& s) { return s.first == id; });
+    if (it != shared.end()) {
+        shared.splice(shared.begin(), shared, it);
+    } else {
+        ECCFrog512CK2::Point E;
+        try {
+            E = curve().point_from_bytes(ephemeral, EPHEMERAL_KEY_BYTES);
+        } catch (const std::exception&) {
+            return false;
+        }
+        SecretBlock x;
+        if (!shared_x(E, secret, x.data())) return false;
+        // O menos usado sai primeiro; o SecretBlock zera o segredo ao voltar para a arena.
+        if (shared.size() >= MAX_CACHED_SHARED) shared.pop_back();
+        shared.emplace_front(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+        it = shared.begin();
+        std::memcpy(it->second.data(), x.data(), COORD_BYTES);
+    }
+    recipient_kek(it->second.data(), ephemeral, pub.encoded, file_id, kek);
+    return true;
+}
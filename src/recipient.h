@@ -0,0 +1,100 @@
+#ifndef RECIPIENT_H
+#define RECIPIENT_H
+
+#include "eccfrog512ck2.h"
+#include "format.h"
+#include "memory_pool.h"
+#include <sodium.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Modo de chave pública sobre ECCFrog512CK2.
+//
+// Cada lote sorteia um efêmero e e grava E = e·G no header (TAG_EPHEMERAL_KEY). Para cada
+// destinatário Q, o segredo x(e·Q) sai da escada x-only em tempo constante, e a KEK de um
+// arquivo é BLAKE2b(x(e·Q), contexto || E || Q || file_id). Ela embrulha a DEK num keyslot
+// KEYSLOT_RECIPIENT. Cifrar para N destinatários custa N acordos de chave por lote,
+// N embrulhos por arquivo e uma passada de AEAD sobre os dados, sem Argon2.
+
+static const size_t RECIPIENT_ID_BYTES = crypto_pwhash_SALTBYTES;   // ocupa o campo salt do slot
+static const size_t RECIPIENT_KEK_BYTES = DEK_BYTES;
+
+// Chave pública de um destinatário.
+struct Recipient {
+    ECCFrog512CK2::Point point;
+    unsigned char encoded[EPHEMERAL_KEY_BYTES];   // ponto comprimido
+    unsigned char id[RECIPIENT_ID_BYTES];         // BLAKE2b(encoded), localiza o slot ao decifrar
+};
+
+// Monta o destinatário a partir de um ponto já validado.
+void make_recipient(const ECCFrog512CK2::Point& point, Recipient& r);
+
+// Lê uma chave pública (hex ou bloco PGP, via point_from_pgp).
+bool load_recipient(const std::string& path, Recipient& r, std::string& error);
+
+// Efêmero do lote e segredos compartilhados, calculados uma vez por destinatário.
+class RecipientSet {
+public:
+    explicit RecipientSet(const std::vector<Recipient>& recipients);
+
+    RecipientSet(const RecipientSet&) = delete;
+    RecipientSet& operator=(const RecipientSet&) = delete;
+
+    bool valid() const { return ready; }
+    size_t size() const { return list.size(); }
+    const unsigned char* ephemeral() const { return eph; }
+    const Recipient& recipient(size_t i) const { return list[i]; }
+
+    // KEK do destinatário i para o file_id de um arquivo.
+    void derive_kek(size_t i, const unsigned char file_id[FILE_ID_BYTES],
+                    unsigned char kek[RECIPIENT_KEK_BYTES]) const;
+
+private:
+    std::vector<Recipient> list;
+    std::unique_ptr<SecretBlock[]> shared;   // x(e·Q) de cada destinatário, em memória travada
+    unsigned char eph[EPHEMERAL_KEY_BYTES];
+    bool ready = false;
+};
+
+// Chave privada de um destinatário. Os segredos compartilhados ficam em cache por efêmero:
+// os arquivos de um mesmo lote usam o mesmo E e pagam um único acordo de chaves. O cache
+// guarda os MAX_CACHED_SHARED efêmeros usados mais recentemente, para que decifrar arquivos
+// de muitos lotes não acumule memória travada.
+class Identity {
+public:
+    static const size_t MAX_CACHED_SHARED = 16;
+
+    Identity() = default;
+    ~Identity();
+
+    Identity(const Identity&) = delete;
+    Identity& operator=(const Identity&) = delete;
+
+    bool generate();
+    bool load(const std::string& path, std::string& error);
+
+    // Grava base.key (segredo, modo 0600) e base.pub (ponto comprimido em hex).
+    bool save(const std::string& base, bool overwrite, std::string& error) const;
+
+    const Recipient& public_key() const { return pub; }
+
+    // KEK do slot deste destinatário num header com efêmero E.
+    bool derive_kek(const unsigned char ephemeral[EPHEMERAL_KEY_BYTES], const unsigned char file_id[FILE_ID_BYTES],
+                    unsigned char kek[RECIPIENT_KEK_BYTES]) const;
+
+private:
+    bool set_secret(const mpz_class& d);
+
+    mpz_class secret;
+    Recipient pub;
+    bool ready = false;
+    // x(d·E) por efêmero, do usado mais recentemente ao menos; memória travada.
+    mutable std::list<std::pair<std::string, SecretBlock>> shared;
+    mutable std::mutex mutex;
+};
+
+#endif
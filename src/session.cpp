@@ -0,0 +1,150 @@
+#include "session.h"
+#include "memory_budget.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
+// Contexto de domínio da derivação de subchaves por arquivo.
+static const char FILE_KEY_CONTEXT[] = "cryptofrog.file-key.v1";
+
+static_assert(KeySession::KEY_BYTES <= SECRET_BLOCK_BYTES, "chaves mestras cabem num bloco de segredo");
+
+KeySession::KeySession(const std::string& password) : secret(password) {}
+
+KeySession::~KeySession() {
+    if (!secret.empty()) sodium_memzero(&secret[0], secret.size());
+}
+
+bool KeySession::batch_salt(unsigned char out[crypto_pwhash_SALTBYTES], const KdfParams& params) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!salt_ready) {
+            randombytes_buf(salt, sizeof(salt));
+            salt_ready = true;
+        }
+        std::memcpy(out, salt, sizeof(salt));
+    }
+    SecretBlock master;
+    return master_for_salt(out, master.data(), params);
+}
+
+bool KeySession::master_for_salt(const unsigned char salt_in[crypto_pwhash_SALTBYTES], unsigned char master[KEY_BYTES],
+                                 const KdfParams& params) {
+    // O mesmo salt com outros parâmetros é outra chave (p.ex. um rekey que só sobe o custo).
+    std::string id(reinterpret_cast<const char*>(salt_in), crypto_pwhash_SALTBYTES);
+    id += static_cast<char>(params.alg);
+    id += std::to_string(params.opslimit) + ":" + std::to_string(params.memlimit);
+
+    // Jobs do mesmo lote esperam a primeira derivação em vez de repeti-la; salts diferentes
+    // derivam ao mesmo tempo (o lock não cobre o Argon2).
+    std::unique_lock<std::mutex> lock(mutex);
+    derived.wait(lock, [&] { return pending.count(id) == 0; });
+    auto it = std::find_if(masters.begin(), masters.end(),
+                           [&](const std::pair<std::string, SecretBlock>& m) { return m.first == id; });
+    if (it != masters.end()) {
+        masters.splice(masters.begin(), masters, it);
+        std::memcpy(master, it->second.data(), KEY_BYTES);
+        return true;
+    }
+
+    pending.insert(id);
+    lock.unlock();
+    bool ok = derive_password_key(secret, salt_in, master, params);
+    lock.lock();
+    pending.erase(id);
+    if (ok) {
+        // A menos usada sai primeiro; o SecretBlock zera a chave ao voltar para a arena.
+        if (masters.size() >= MAX_CACHED_MASTERS) masters.pop_back();
+        masters.emplace_front(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+        std::memcpy(masters.front().second.data(), master, KEY_BYTES);
+    }
+    derived.notify_all();
+    return ok;
+}
+
+bool derive_password_key(const std::string& password, const unsigned char salt[crypto_pwhash_SALTBYTES],
+                         unsigned char key[KeySession::KEY_BYTES], const KdfParams& params) {
+    if (!kdf_params_valid(params)) return false;
+    MemoryBudget::Reservation reservation = kdf_budget().reserve(params.memlimit);
+    return crypto_pwhash(key, KeySession::KEY_BYTES, password.c_str(), password.size(), salt,
+                         params.opslimit, static_cast<size_t>(params.memlimit),
+                         crypto_pwhash_ALG_ARGON2ID13) == 0;
+}
+
+// Tempo de uma derivação com params, em milissegundos (0 se falhou).
+static double time_kdf(const KdfParams& params) {
+    unsigned char salt[crypto_pwhash_SALTBYTES];
+    unsigned char key[KeySession::KEY_BYTES];
+    randombytes_buf(salt, sizeof(salt));
+    auto start = std::chrono::steady_clock::now();
+    bool ok = derive_password_key("cryptofrog calibration", salt, key, params);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    sodium_memzero(key, sizeof(key));
+    return ok ? ms : 0;
+}
+
+KdfParams calibrate_kdf(unsigned target_ms, uint64_t max_memory, unsigned* measured_ms) {
+    // Mínimo prático de 8 MiB: abaixo disso o Argon2 deixa de ser memory-hard de verdade.
+    const uint64_t floor_memory = 8ULL << 20;
+    KdfParams params;
+    params.opslimit = 1;
+    params.memlimit = std::min<uint64_t>(std::max(max_memory, floor_memory), KDF_MAX_MEMLIMIT) & ~((1ULL << 20) - 1);
+
+    // Uma passada acima do alvo: reduz a memória na proporção do excesso (o tempo do Argon2
+    // é quase linear nela), com folga de 10%, até caber ou chegar ao mínimo.
+    double one_pass = time_kdf(params);
+    while (one_pass > target_ms && params.memlimit > floor_memory) {
+        uint64_t scaled = static_cast<uint64_t>(params.memlimit * (0.9 * target_ms / one_pass));
+        params.memlimit = std::max<uint64_t>(scaled & ~((1ULL << 20) - 1), floor_memory);
+        one_pass = time_kdf(params);
+    }
+
+    // O custo é linear nas passadas mais um fixo (alocar e preencher a memória): duas medidas
+    // separam os dois. A medida final corrige o excesso.
+    double ms = one_pass;
+    if (one_pass > 0 && one_pass * 2 <= target_ms) {
+        params.opslimit = 2;
+        double per_pass = std::max(time_kdf(params) - one_pass, one_pass / 4);
+        double passes = 1 + (target_ms - one_pass) / per_pass;
+        params.opslimit = static_cast<uint32_t>(std::max(1.0, std::min<double>(passes, KDF_MAX_OPSLIMIT)));
+        ms = time_kdf(params);
+    }
+    if (ms > target_ms * 1.1 && params.opslimit > 1) {
+        params.opslimit--;
+        ms = time_kdf(params);
+    }
+    if (measured_ms) *measured_ms = static_cast<unsigned>(ms + 0.5);
+    return params;
+}
+
+void derive_file_key(const unsigned char master[KeySession::KEY_BYTES],
+                     const unsigned char file_id[FILE_ID_BYTES], unsigned char key[KeySession::KEY_BYTES]) {
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, master, KeySession::KEY_BYTES, KeySession::KEY_BYTES);
+    crypto_generichash_update(&state, reinterpret_cast<const unsigned char*>(FILE_KEY_CONTEXT),
+                              sizeof(FILE_KEY_CONTEXT) - 1);
+    crypto_generichash_update(&state, file_id, FILE_ID_BYTES);
+    crypto_generichash_final(&state, key, KeySession::KEY_BYTES);
+    sodium_memzero(&state, sizeof(state));
+}
+
+bool derive_salted_key(const unsigned char salt[crypto_pwhash_SALTBYTES], const unsigned char* file_id,
+                       const std::string& password, KeySession* session,
+                       unsigned char key[KeySession::KEY_BYTES], const KdfParams& params) {
+    // Sem file_id a chave é a própria saída do Argon2, que também fica em cache por salt.
+    if (!file_id) {
+        return session ? session->master_for_salt(salt, key, params) : derive_password_key(password, salt, key, params);
+    }
+
+    SecretBlock master;
+    bool ok = session ? session->master_for_salt(salt, master.data(), params)
+                      : derive_password_key(password, salt, master.data(), params);
+    if (ok) derive_file_key(master.data(), file_id, key);
+    return ok;
+}
+
+bool derive_stream_key(const FileHeader& hdr, const std::string& password, KeySession* session,
+                       unsigned char key[KeySession::KEY_BYTES]) {
+    return derive_salted_key(hdr.salt, hdr.has_file_id ? hdr.file_id : nullptr, password, session, key);
+}
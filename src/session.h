@@ -0,0 +1,79 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "format.h"
+#include "memory_pool.h"
+#include <sodium.h>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+// Sessão de chaves para lotes de arquivos.
+//
+// O Argon2 roda uma única vez por salt de lote e produz uma chave mestra; cada arquivo
+// recebe um file_id aleatório e sua chave é BLAKE2b(chave mestra, file_id). O header de
+// cada arquivo guarda o salt do lote, os parâmetros da KDF e o file_id, então ele continua
+// decifrável sozinho (ao custo de um Argon2). Ao decifrar, as chaves mestras ficam em cache
+// por salt e parâmetros, e arquivos do mesmo lote pagam só a derivação da subchave. O cache
+// guarda as MAX_CACHED_MASTERS usadas mais recentemente: um lote com milhares de salts
+// distintos não acumula memória travada. Salts diferentes derivam em paralelo, dentro do
+// orçamento de kdf_budget().
+class KeySession {
+public:
+    static const size_t KEY_BYTES = crypto_aead_aes256gcm_KEYBYTES;
+    static const size_t MAX_CACHED_MASTERS = 16;
+
+    explicit KeySession(const std::string& password);
+    ~KeySession();
+
+    KeySession(const KeySession&) = delete;
+    KeySession& operator=(const KeySession&) = delete;
+
+    // Salt do lote usado para novos arquivos (o Argon2 com params roda na primeira chamada).
+    bool batch_salt(unsigned char salt[crypto_pwhash_SALTBYTES], const KdfParams& params = KdfParams());
+
+    // Chave mestra para um salt; roda o Argon2 apenas se (salt, params) ainda não está em cache.
+    bool master_for_salt(const unsigned char salt[crypto_pwhash_SALTBYTES], unsigned char master[KEY_BYTES],
+                         const KdfParams& params = KdfParams());
+
+    const std::string& password() const { return secret; }
+
+private:
+    std::string secret;
+    unsigned char salt[crypto_pwhash_SALTBYTES];
+    bool salt_ready = false;
+    // Da usada mais recentemente à menos; memória travada (memory_pool.h).
+    std::list<std::pair<std::string, SecretBlock>> masters;
+    std::set<std::string> pending;   // (salt, params) com Argon2 em andamento
+    std::mutex mutex;
+    std::condition_variable derived;
+};
+
+// Argon2id sobre a senha com params (recusados se !kdf_params_valid); espera vaga de
+// params.memlimit em kdf_budget() antes de alocar.
+bool derive_password_key(const std::string& password, const unsigned char salt[crypto_pwhash_SALTBYTES],
+                         unsigned char key[KeySession::KEY_BYTES], const KdfParams& params = KdfParams());
+
+// Mede o Argon2 nesta máquina e escolhe parâmetros para uma derivação de ~target_ms: a maior
+// memória até max_memory (reduzida enquanto uma passada sozinha estoura o alvo) e
+// então quantas passadas cabem no tempo. *measured_ms recebe o tempo medido da escolha.
+KdfParams calibrate_kdf(unsigned target_ms, uint64_t max_memory, unsigned* measured_ms = nullptr);
+
+// Subchave de um arquivo a partir da chave mestra do lote.
+void derive_file_key(const unsigned char master[KeySession::KEY_BYTES],
+                     const unsigned char file_id[FILE_ID_BYTES], unsigned char key[KeySession::KEY_BYTES]);
+
+// Chave derivada de (salt, file_id opcional): Argon2 direto, ou mestra do lote + file_id.
+// Com session, usa (e alimenta) o cache de chaves mestras.
+bool derive_salted_key(const unsigned char salt[crypto_pwhash_SALTBYTES], const unsigned char* file_id,
+                       const std::string& password, KeySession* session,
+                       unsigned char key[KeySession::KEY_BYTES], const KdfParams& params = KdfParams());
+
+// Chave de segmentos de headers sem keyslots (salt/file_id no próprio header, parâmetros padrão).
+bool derive_stream_key(const FileHeader& hdr, const std::string& password, KeySession* session,
+                       unsigned char key[KeySession::KEY_BYTES]);
+
+#endif
@@ -0,0 +1,122 @@
+#include "shred.h"
+#include "io_backend.h"
+#include "thread_pool.h"
+#include <sodium.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+void ShredStats::merge(const ShredStats& other) {
+    files += other.files;
+    bytes += other.bytes;
+    written += other.written;
+}
+
+Shredder::Shredder(const ShredOptions& options) : opts(options) {
+    if (opts.chunk_bytes == 0) opts.chunk_bytes = ShredOptions().chunk_bytes;
+}
+
+Shredder::~Shredder() {
+    if (!buffer.empty()) sodium_memzero(buffer.data(), buffer.size());
+}
+
+bool Shredder::shred(const std::string& path, ShredStats& stats) {
+    auto start = Clock::now();
+    int fd = ::open(path.c_str(), O_WRONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (buffer.size() < opts.chunk_bytes && size > 0) buffer.resize(opts.chunk_bytes);
+
+    // Cada passada sobrescreve o arquivo inteiro com o mesmo chunk, renovado por passada:
+    // gerar aleatoriedade para cada chunk custaria CPU sem mudar o resultado no disco.
+    const unsigned total_passes = opts.passes + (opts.zero_pass ? 1 : 0);
+    bool ok = true;
+    for (unsigned pass = 0; pass < total_passes && ok && size > 0; ++pass) {
+        if (pass < opts.passes) randombytes_buf(buffer.data(), buffer.size());
+        else std::fill(buffer.begin(), buffer.end(), 0);
+        for (uint64_t pos = 0; pos < size && ok; pos += buffer.size()) {
+            size_t len = static_cast<size_t>(std::min<uint64_t>(buffer.size(), size - pos));
+            ok = pwrite_exact(fd, buffer.data(), len, pos);
+        }
+        if (ok && opts.sync) ok = ::fdatasync(fd) == 0;
+        if (ok) stats.written += size;
+    }
+    if (::close(fd) != 0) ok = false;
+    if (ok && opts.remove) ok = ::unlink(path.c_str()) == 0;
+
+    if (ok) {
+        stats.files++;
+        stats.bytes += size;
+    }
+    stats.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    return ok;
+}
+
+bool shred_file(const std::string& path, const ShredOptions& options, ShredStats* stats) {
+    Shredder shredder(options);
+    ShredStats local;
+    return shredder.shred(path, stats ? *stats : local);
+}
+
+bool shred_paths(const std::vector<std::string>& paths, const ShredOptions& options, ShredStats& stats,
+                 std::vector<std::string>& failed) {
+    auto start = Clock::now();
+    std::vector<std::string> files, dirs, links;
+    for (const std::string& root : paths) {
+        std::error_code ec;
+        if (!fs::is_directory(fs::symlink_status(root, ec))) {
+            files.push_back(root);
+            continue;
+        }
+        dirs.push_back(root);
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_symlink(ec)) links.push_back(it->path().string());
+            else if (it->is_directory(ec)) dirs.push_back(it->path().string());
+            else if (it->is_regular_file(ec)) files.push_back(it->path().string());
+        }
+        if (ec) failed.push_back(root);
+    }
+
+    // Cada worker tem seu Shredder (e seu buffer) e pega os arquivos de jobs em jobs.
+    unsigned jobs = ThreadPool::resolve_threads(options.jobs);
+    if (jobs > files.size()) jobs = std::max<size_t>(1, files.size());
+    std::vector<ShredStats> per_job(jobs);
+    std::mutex failed_mutex;
+    ThreadPool pool(jobs);
+    pool.parallel_for(jobs, [&](size_t job) {
+        Shredder shredder(options);
+        for (size_t i = job; i < files.size(); i += jobs) {
+            if (shredder.shred(files[i], per_job[job])) continue;
+            std::lock_guard<std::mutex> lock(failed_mutex);
+            failed.push_back(files[i]);
+        }
+    });
+    for (const ShredStats& s : per_job) stats.merge(s);
+
+    // Links simbólicos dentro das árvores saem sem tocar no alvo; depois, os diretórios
+    // esvaziados, dos mais fundos para a raiz.
+    if (options.remove) {
+        for (const std::string& link : links) {
+            if (::unlink(link.c_str()) != 0) failed.push_back(link);
+        }
+        std::sort(dirs.begin(), dirs.end(), [](const std::string& a, const std::string& b) { return a.size() > b.size(); });
+        for (const std::string& dir : dirs) {
+            if (::rmdir(dir.c_str()) != 0) failed.push_back(dir);
+        }
+    }
+    stats.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    return failed.empty();
+}
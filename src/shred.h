@@ -0,0 +1,59 @@
+#ifndef SHRED_H
+#define SHRED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Apagamento seguro de arquivos: sobrescreve o conteúdo no lugar e só então remove.
+//
+// A memória é constante: cada worker reusa um buffer de chunk_bytes, qualquer que seja o
+// tamanho do arquivo. Em SSDs (wear leveling) e em sistemas de arquivos copy-on-write ou com
+// journal de dados, os blocos antigos podem sobreviver à sobrescrita; nesses casos, só cifrar
+// desde o início protege de verdade.
+struct ShredOptions {
+    unsigned passes = 1;            // passadas de bytes aleatórios
+    bool zero_pass = false;         // passada final extra com zeros
+    size_t chunk_bytes = 1 << 20;   // tamanho do buffer reusado e de cada escrita
+    bool sync = true;               // fdatasync ao fim de cada passada (barreira antes da próxima)
+    unsigned jobs = 0;              // arquivos em paralelo em shred_paths; 0 = núcleos
+    bool remove = true;             // remove o arquivo (e diretórios esvaziados) no fim
+};
+
+struct ShredStats {
+    uint64_t files = 0;
+    uint64_t bytes = 0;     // tamanho somado dos arquivos
+    uint64_t written = 0;   // bytes escritos em todas as passadas
+    double seconds = 0;
+
+    double mib_per_s() const { return seconds > 0 ? written / seconds / (1 << 20) : 0; }
+    void merge(const ShredStats& other);
+};
+
+// Um worker: guarda o buffer entre arquivos.
+class Shredder {
+public:
+    explicit Shredder(const ShredOptions& options = ShredOptions());
+    ~Shredder();
+
+    Shredder(const Shredder&) = delete;
+    Shredder& operator=(const Shredder&) = delete;
+
+    // Só arquivos regulares; links simbólicos são recusados (O_NOFOLLOW).
+    bool shred(const std::string& path, ShredStats& stats);
+
+private:
+    ShredOptions opts;
+    std::vector<unsigned char> buffer;
+};
+
+bool shred_file(const std::string& path, const ShredOptions& options = ShredOptions(),
+                ShredStats* stats = nullptr);
+
+// Arquivos e árvores de diretórios, com options.jobs workers. Os caminhos que falharam vão
+// para failed; verdadeiro se nenhum falhou.
+bool shred_paths(const std::vector<std::string>& paths, const ShredOptions& options, ShredStats& stats,
+                 std::vector<std::string>& failed);
+
+#endif
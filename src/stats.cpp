@@ -0,0 +1,88 @@
+#include "stats.h"
+#include "memory_pool.h"
+#include <cstdio>
+#include <sys/resource.h>
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {"kdf", "read", "crypt", "write"};
+
+OperationStats::OperationStats() : started(std::chrono::steady_clock::now()) {
+    for (unsigned i = 0; i < STAGE_COUNT; ++i) {
+        ns[i] = 0;
+        bytes[i] = 0;
+        calls[i] = 0;
+    }
+}
+
+void OperationStats::add(Stage stage, uint64_t elapsed_ns, uint64_t n_bytes, uint64_t n_calls) {
+    unsigned i = static_cast<unsigned>(stage);
+    ns[i].fetch_add(elapsed_ns, std::memory_order_relaxed);
+    bytes[i].fetch_add(n_bytes, std::memory_order_relaxed);
+    calls[i].fetch_add(n_calls, std::memory_order_relaxed);
+}
+
+void OperationStats::add_file(bool ok, uint64_t count) {
+    (ok ? files : failed).fetch_add(count, std::memory_order_relaxed);
+}
+
+OperationStats::Snapshot OperationStats::snapshot() const {
+    Snapshot s;
+    for (unsigned i = 0; i < STAGE_COUNT; ++i) {
+        s.stages[i].seconds = ns[i].load(std::memory_order_relaxed) / 1e9;
+        s.stages[i].bytes = bytes[i].load(std::memory_order_relaxed);
+        s.stages[i].calls = calls[i].load(std::memory_order_relaxed);
+    }
+    s.files = files.load(std::memory_order_relaxed);
+    s.failed = failed.load(std::memory_order_relaxed);
+    s.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    s.peak_rss_bytes = peak_rss_bytes();
+    BufferPool::Counters buffers = io_buffer_pool().counters();
+    SecureArena::Counters secrets = secure_arena().counters();
+    s.buffer_allocations = buffers.allocations;
+    s.buffer_reuses = buffers.reuses;
+    s.secret_blocks = secrets.blocks;
+    s.locked_bytes = secrets.locked_bytes;
+    return s;
+}
+
+std::string OperationStats::to_json() const {
+    Snapshot s = snapshot();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "{\"files\":%llu,\"failed\":%llu,\"wall_seconds\":%.6f,\"peak_rss_bytes\":%llu,",
+                  static_cast<unsigned long long>(s.files), static_cast<unsigned long long>(s.failed), s.wall_seconds,
+                  static_cast<unsigned long long>(s.peak_rss_bytes));
+    std::string json = buf;
+    std::snprintf(buf, sizeof(buf),
+                  "\"memory\":{\"buffer_allocations\":%llu,\"buffer_reuses\":%llu,\"secret_blocks\":%llu,"
+                  "\"locked_bytes\":%llu},\"stages\":{",
+                  static_cast<unsigned long long>(s.buffer_allocations), static_cast<unsigned long long>(s.buffer_reuses),
+                  static_cast<unsigned long long>(s.secret_blocks), static_cast<unsigned long long>(s.locked_bytes));
+    json += buf;
+    for (unsigned i = 0; i < STAGE_COUNT; ++i) {
+        const StageTotals& t = s.stages[i];
+        std::snprintf(buf, sizeof(buf), "%s\"%s\":{\"seconds\":%.6f,\"bytes\":%llu,\"calls\":%llu,\"mib_per_s\":%.1f}",
+                      i ? "," : "", STAGE_NAMES[i], t.seconds, static_cast<unsigned long long>(t.bytes),
+                      static_cast<unsigned long long>(t.calls), t.mib_per_s());
+        json += buf;
+    }
+    return json + "}}";
+}
+
+std::string OperationStats::summary() const {
+    Snapshot s = snapshot();
+    const StageTotals& crypt = s[Stage::Crypt];
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "%.1f MiB in %.2f s (%.0f MiB/s)\n"
+                  "key derivation %.2f s, read %.2f s, cipher %.2f s, write %.2f s\n"
+                  "peak memory %.0f MiB",
+                  crypt.bytes / 1048576.0, s.wall_seconds, s.wall_seconds > 0 ? crypt.bytes / s.wall_seconds / 1048576.0 : 0,
+                  s[Stage::Kdf].seconds, s[Stage::Read].seconds, crypt.seconds, s[Stage::Write].seconds,
+                  s.peak_rss_bytes / 1048576.0);
+    return buf;
+}
+
+uint64_t peak_rss_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // KiB no Linux
+}
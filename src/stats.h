@@ -0,0 +1,100 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Estágios medidos de uma operação. Kdf cobre o desbloqueio/selagem do header (Argon2,
+// espera no orçamento de memória e embrulho da DEK); os outros são os do pipeline de
+// segmentos, que rodam sobrepostos em threads próprias.
+enum class Stage : unsigned {
+    Kdf,
+    Read,
+    Crypt,   // AEAD e, em arquivos comprimidos, LZ4
+    Write,
+};
+static const unsigned STAGE_COUNT = 4;
+
+// Medidas acumuladas de uma ou mais operações (um job da CLI, uma ação da GUI). Contadores
+// atômicos: jobs paralelos podem compartilhar o mesmo objeto. O custo por lote de
+// segmentos é de duas leituras do relógio monotônico e três somas atômicas; sem objeto
+// de medidas (CryptoOptions::stats nulo) nada é medido.
+class OperationStats {
+public:
+    OperationStats();
+
+    OperationStats(const OperationStats&) = delete;
+    OperationStats& operator=(const OperationStats&) = delete;
+
+    // Tempo (ns), bytes e chamadas (derivações, lotes ou segmentos) de um estágio.
+    void add(Stage stage, uint64_t ns, uint64_t bytes = 0, uint64_t calls = 1);
+    void add_file(bool ok, uint64_t count = 1);
+
+    // Recomeça a contagem do tempo total (antes de qualquer job usar o objeto).
+    void restart() { started = std::chrono::steady_clock::now(); }
+
+    struct StageTotals {
+        double seconds = 0;   // tempo ocupado do estágio, somado entre jobs
+        uint64_t bytes = 0;
+        uint64_t calls = 0;
+        double mib_per_s() const { return seconds > 0 ? bytes / seconds / (1 << 20) : 0; }
+    };
+    struct Snapshot {
+        StageTotals stages[STAGE_COUNT];
+        uint64_t files = 0, failed = 0;
+        double wall_seconds = 0;   // desde a construção
+        uint64_t peak_rss_bytes = 0;
+        // Pools de memória do processo inteiro, como o pico de memória (memory_pool.h):
+        // buffers de E/S novos e reaproveitados, blocos de segredo entregues e bytes travados.
+        uint64_t buffer_allocations = 0, buffer_reuses = 0;
+        uint64_t secret_blocks = 0, locked_bytes = 0;
+        const StageTotals& operator[](Stage s) const { return stages[static_cast<unsigned>(s)]; }
+    };
+    Snapshot snapshot() const;
+
+    // Objeto JSON de uma linha (chaves em inglês, para ferramentas externas).
+    std::string to_json() const;
+
+    // Resumo legível em poucas linhas (GUI).
+    std::string summary() const;
+
+private:
+    std::chrono::steady_clock::time_point started;
+    std::atomic<uint64_t> ns[STAGE_COUNT], bytes[STAGE_COUNT], calls[STAGE_COUNT];
+    std::atomic<uint64_t> files{0}, failed{0};
+};
+
+// Mede um trecho e soma em stats ao sair de escopo; com stats nulo não lê o relógio.
+class StageTimer {
+public:
+    StageTimer(OperationStats* stats, Stage stage)
+        : stats(stats), stage(stage), start(stats ? std::chrono::steady_clock::now()
+                                                  : std::chrono::steady_clock::time_point()) {}
+    ~StageTimer() {
+        if (!stats) return;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        stats->add(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), bytes, calls);
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    // Bytes e chamadas atribuídos ao trecho (padrão: 0 bytes, 1 chamada).
+    void record(uint64_t n_bytes, uint64_t n_calls = 1) {
+        bytes = n_bytes;
+        calls = n_calls;
+    }
+
+private:
+    OperationStats* stats;
+    Stage stage;
+    std::chrono::steady_clock::time_point start;
+    uint64_t bytes = 0, calls = 1;
+};
+
+// Pico de memória residente do processo, em bytes.
+uint64_t peak_rss_bytes();
+
+#endif
@@ -0,0 +1,504 @@
+#include "stream.h"
+#include "aead.h"
+#include "compress.h"
+#include "bounded_queue.h"
+#include "memory_pool.h"
+#include "progress.h"
+#include "stats.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Segmentos por worker em cada lote: o suficiente para amortizar a sincronização.
+static const size_t SEGMENTS_PER_THREAD = 4;
+
+// Lotes em circulação: um sendo lido, um sendo processado, um sendo escrito.
+static const size_t PIPELINE_DEPTH = 3;
+
+// Lote de segmentos contíguos. A entrada de cada slot aponta para o buffer do lote
+// ou diretamente para a memória do backend (mmap), sem cópia. scratch guarda o texto
+// claro empacotado (modo | dados) dos arquivos comprimidos. Os buffers vêm do pool de E/S
+// (memory_pool.h), que os zera na devolução e os reaproveita no próximo arquivo.
+struct SegmentBatch {
+    size_t in_slot, out_slot, scratch_slot;
+    BufferPool::Lease in, out, scratch;
+    std::vector<const unsigned char*> in_data;
+    std::vector<size_t> in_len, out_len;
+    size_t count = 0;
+    uint64_t first = 0;
+    bool last = false;
+
+    SegmentBatch(size_t capacity, size_t in_slot_size, size_t out_slot_size, size_t scratch_slot_size)
+        : in_slot(in_slot_size), out_slot(out_slot_size), scratch_slot(scratch_slot_size),
+          in(io_buffer_pool().acquire(capacity * in_slot_size)),
+          out(io_buffer_pool().acquire(capacity * out_slot_size)),
+          scratch(io_buffer_pool().acquire(capacity * scratch_slot_size)),
+          in_data(capacity), in_len(capacity), out_len(capacity) {}
+
+    size_t capacity() const { return in_len.size(); }
+    const unsigned char* input(size_t i) const { return in_data[i]; }
+    unsigned char* output(size_t i) { return out.data() + i * out_slot; }
+    unsigned char* packed(size_t i) { return scratch.data() + i * scratch_slot; }
+};
+
+static void put_u32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void put_u64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+static uint64_t get_u64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+// Fonte limitada aos primeiros `limit` bytes de outra: nos arquivos com tabela de
+// segmentos, o fluxo termina onde a tabela começa.
+class BoundedInput : public InputSource {
+public:
+    BoundedInput(InputSource& inner, uint64_t limit) : inner(inner), left(limit) {}
+
+    size_t acquire(unsigned char* scratch, size_t len, const unsigned char** data) override {
+        size_t got = inner.acquire(scratch, static_cast<size_t>(std::min<uint64_t>(len, left)), data);
+        left -= got;
+        return got;
+    }
+    bool at_end() override { return left == 0 || inner.at_end(); }
+    bool failed() const override { return inner.failed(); }
+    uint64_t remaining() const { return left; }
+
+private:
+    InputSource& inner;
+    uint64_t left;
+};
+
+// Lê um segmento com prefixo de tamanho (arquivos comprimidos) para o slot i.
+static size_t acquire_framed(InputSource& in, SegmentBatch& batch, size_t i, size_t min_len) {
+    unsigned char prefix[SEGMENT_FRAME_BYTES];
+    if (!read_exact(in, prefix, sizeof(prefix))) return 0;
+    size_t len = get_u32(prefix);
+    unsigned char* slot = batch.in.data() + i * batch.in_slot;
+    if (len < min_len || len > batch.in_slot || !read_exact(in, slot, len)) return 0;
+    batch.in_data[i] = slot;
+    return len;
+}
+
+// Preenche o lote a partir da fonte; min_len é o menor segmento válido. Com framed, cada
+// segmento traz o próprio tamanho e o fim da fonte marca o último.
+static bool fill_batch(InputSource& in, SegmentBatch& batch, size_t min_len, bool framed) {
+    batch.count = 0;
+    batch.last = false;
+    while (batch.count < batch.capacity()) {
+        size_t i = batch.count;
+        size_t len = framed ? acquire_framed(in, batch, i, min_len)
+                            : in.acquire(batch.in.data() + i * batch.in_slot, batch.in_slot, &batch.in_data[i]);
+        if (in.failed() || len < min_len) return false;
+        batch.in_len[i] = len;
+        batch.count++;
+        if ((!framed && len < batch.in_slot) || in.at_end()) {
+            batch.last = true;
+            break;
+        }
+    }
+    return true;
+}
+
+static bool write_batch(OutputSink& out, SegmentBatch& batch) {
+    for (size_t i = 0; i < batch.count; ++i) {
+        if (!out.write(batch.output(i), batch.out_len[i])) return false;
+    }
+    return true;
+}
+
+static uint64_t total_len(const std::vector<size_t>& lens, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += lens[i];
+    return total;
+}
+
+// Layout dos slots de um lote e da leitura: framed lê segmentos com prefixo de tamanho.
+// sealing indica que o texto claro está na entrada (conta os bytes do estágio Crypt).
+struct SlotLayout {
+    size_t in_slot, out_slot, scratch_slot, min_len;
+    bool framed, sealing;
+};
+
+// Processa lotes até o segmento final. crypt(batch, i, index, last) sela ou abre o slot i.
+// written, se dado, recebe o tamanho de cada segmento escrito, na ordem do fluxo.
+template <typename CryptFn>
+static bool run_segments(InputSource& in, OutputSink& out, const CryptoOptions& options,
+                         const SlotLayout& layout, CryptFn crypt, uint64_t* segments = nullptr,
+                         std::vector<uint32_t>* written = nullptr) {
+    unsigned threads = ThreadPool::resolve_threads(options.threads);
+    std::unique_ptr<ThreadPool> pool;
+    uint64_t next_index = 0;
+
+    // Cada estágio mede só o próprio trabalho; as esperas nas filas ficam de fora.
+    // O cancelamento é consultado antes de cada lote: o que já foi lido termina o ciclo.
+    auto read = [&](SegmentBatch& batch) {
+        if (options.progress && options.progress->cancelled()) return false;
+        StageTimer timer(options.stats, Stage::Read);
+        bool ok = fill_batch(in, batch, layout.min_len, layout.framed);
+        uint64_t bytes = total_len(batch.in_len, batch.count);
+        timer.record(bytes);
+        if (ok && options.progress) options.progress->advance(bytes);
+        return ok;
+    };
+    auto write = [&](SegmentBatch& batch) {
+        StageTimer timer(options.stats, Stage::Write);
+        timer.record(total_len(batch.out_len, batch.count));
+        if (written)
+            for (size_t i = 0; i < batch.count; ++i) written->push_back(static_cast<uint32_t>(batch.out_len[i]));
+        return write_batch(out, batch);
+    };
+
+    auto process = [&](SegmentBatch& batch) {
+        StageTimer timer(options.stats, Stage::Crypt);
+        if (next_index + batch.count > MAX_SEGMENTS) return false;
+        batch.first = next_index;
+        next_index += batch.count;
+        if (segments) *segments = next_index;
+
+        // O pool só é criado quando a entrada passa de um segmento.
+        if (!pool && batch.count > 1) pool.reset(new ThreadPool(threads));
+
+        std::atomic<bool> failed(false);
+        auto task = [&](size_t i) {
+            bool last = batch.last && i + 1 == batch.count;
+            if (!crypt(batch, i, static_cast<uint32_t>(batch.first + i), last)) failed = true;
+        };
+        if (pool) pool->parallel_for(batch.count, task);
+        else for (size_t i = 0; i < batch.count; ++i) task(i);
+        if (options.stats)
+            timer.record(total_len(layout.sealing ? batch.in_len : batch.out_len, batch.count), batch.count);
+        return !failed;
+    };
+
+    std::vector<std::unique_ptr<SegmentBatch>> batches;
+    batches.emplace_back(new SegmentBatch(threads * SEGMENTS_PER_THREAD, layout.in_slot, layout.out_slot,
+                                           layout.scratch_slot));
+
+    // Entradas de um único lote (arquivos pequenos) não justificam threads de E/S.
+    SegmentBatch& head = *batches.front();
+    if (!read(head)) return false;
+    if (head.last) return process(head) && write(head);
+
+    BoundedQueue<SegmentBatch*> free_q(PIPELINE_DEPTH), full_q(PIPELINE_DEPTH), done_q(PIPELINE_DEPTH);
+    std::atomic<bool> failed(false);
+
+    for (size_t i = 1; i < PIPELINE_DEPTH; ++i) {
+        batches.emplace_back(new SegmentBatch(threads * SEGMENTS_PER_THREAD, layout.in_slot, layout.out_slot,
+                                           layout.scratch_slot));
+        free_q.push(batches.back().get());
+    }
+    full_q.push(&head);
+
+    std::thread reader([&] {
+        SegmentBatch* batch;
+        while (!failed && free_q.pop(batch)) {
+            if (!read(*batch)) {
+                failed = true;
+                break;
+            }
+            full_q.push(batch);
+            if (batch->last) break;
+        }
+        full_q.close();
+    });
+
+    std::thread writer([&] {
+        SegmentBatch* batch;
+        while (done_q.pop(batch)) {
+            if (!failed && !write(*batch)) failed = true;
+            free_q.push(batch);
+        }
+    });
+
+    SegmentBatch* batch;
+    while (full_q.pop(batch)) {
+        if (failed || !process(*batch)) {
+            failed = true;
+            break;
+        }
+        done_q.push(batch);
+    }
+
+    // Em caso de erro, libera o leitor que pode estar esperando por um lote livre.
+    if (failed) free_q.close();
+    reader.join();
+    done_q.close();
+    writer.join();
+    return !failed;
+}
+
+// Nonce dos blocos da tabela: contador = número do bloco e flag 3 (segmentos usam 0 e 1,
+// o índice 2).
+static void table_nonce(const FileHeader& hdr, uint64_t block, unsigned char nonce[AEAD_MAX_NPUBBYTES]) {
+    std::memset(nonce, 0, AEAD_MAX_NPUBBYTES);
+    segment_nonce(hdr, static_cast<uint32_t>(block), false, nonce);
+    nonce[SEGMENT_NONCE_BYTES - 1] = 3;
+}
+
+static size_t table_block_plain_bytes(size_t entries) {
+    return 8 + 4 * entries;
+}
+
+// Sela a tabela a partir dos tamanhos escritos (com prefixo); stored recebe a soma deles.
+static bool write_segment_table(OutputSink& out, const FileHeader& hdr, const unsigned char key[DEK_BYTES],
+                                const std::vector<uint32_t>& framed, uint64_t& stored) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    std::vector<unsigned char> plain(table_block_plain_bytes(SEGMENT_TABLE_BLOCK));
+    std::vector<unsigned char> sealed(plain.size() + suite->abytes);
+    stored = 0;
+    for (size_t first = 0; first < framed.size(); first += SEGMENT_TABLE_BLOCK) {
+        size_t count = std::min(SEGMENT_TABLE_BLOCK, framed.size() - first);
+        put_u64(plain.data(), stored);
+        for (size_t i = 0; i < count; ++i) {
+            put_u32(plain.data() + 8 + 4 * i, framed[first + i] - static_cast<uint32_t>(SEGMENT_FRAME_BYTES));
+            stored += framed[first + i];
+        }
+        unsigned char nonce[AEAD_MAX_NPUBBYTES];
+        table_nonce(hdr, first / SEGMENT_TABLE_BLOCK, nonce);
+        unsigned long long clen;
+        if (suite->encrypt(sealed.data(), &clen, plain.data(), table_block_plain_bytes(count), hdr.core,
+                           HEADER_CORE_BYTES, NULL, nonce, key) != 0 ||
+            !out.write(sealed.data(), clen))
+            return false;
+    }
+    return true;
+}
+
+// Lê e autentica a tabela inteira que segue os segmentos, até o fim da fonte.
+static bool read_segment_table(InputSource& in, const FileHeader& hdr, const unsigned char key[DEK_BYTES],
+                               const StreamTotals& totals) {
+    std::vector<unsigned char> sealed;
+    SegmentTableBlock block;
+    uint64_t expected = 0;
+    for (uint64_t b = 0; b * SEGMENT_TABLE_BLOCK < totals.segments; ++b) {
+        uint64_t pos;
+        size_t len;
+        if (!segment_table_block_span(hdr, totals.segments, b, pos, len)) return false;
+        sealed.resize(len);
+        if (!read_exact(in, sealed.data(), len) ||
+            !open_segment_table_block(hdr, key, totals.segments, b, sealed.data(), len, block) ||
+            block.first_offset != expected)
+            return false;
+        for (uint32_t l : block.lens) expected += SEGMENT_FRAME_BYTES + l;
+    }
+    return expected == totals.stored_bytes && in.at_end();
+}
+
+bool seal_stream(InputSource& in, OutputSink& out, const FileHeader& hdr,
+                 const unsigned char key[DEK_BYTES],
+                 const CryptoOptions& options, StreamTotals* totals) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return false;
+    std::atomic<uint64_t> plaintext_bytes(0);
+    uint64_t segments = 0;
+    const bool compressed = hdr.flags & FLAG_COMPRESSED;
+    const bool table = hdr.flags & FLAG_SEGMENT_TABLE;
+    if (table && !compressed) return false;
+    std::vector<uint32_t> framed;
+    const Compression compression = compressed ? Compression::Lz4 : Compression::None;
+    const size_t packed = compressed ? packed_segment_bound(hdr.segment_size) : 0;
+    const size_t frame = compressed ? SEGMENT_FRAME_BYTES : 0;
+    SlotLayout layout = {hdr.segment_size, frame + (compressed ? packed : hdr.segment_size) + suite->abytes,
+                         packed, 0, false, true};
+    bool ok = run_segments(in, out, options, layout,
+        [&](SegmentBatch& batch, size_t i, uint32_t index, bool last) {
+            // Suítes de nonce maior recebem o nonce do segmento completado com zeros.
+            unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+            segment_nonce(hdr, index, last, nonce);
+            const unsigned char* plain = batch.input(i);
+            size_t plen = batch.in_len[i];
+            if (compressed) {
+                plen = pack_segment(compression, plain, plen, batch.packed(i));
+                plain = batch.packed(i);
+            }
+            unsigned long long clen;
+            if (suite->encrypt(batch.output(i) + frame, &clen, plain, plen,
+                               hdr.core, HEADER_CORE_BYTES, NULL, nonce, key) != 0)
+                return false;
+            if (compressed) put_u32(batch.output(i), static_cast<uint32_t>(clen));
+            batch.out_len[i] = frame + clen;
+            plaintext_bytes += batch.in_len[i];
+            return true;
+        }, &segments, table ? &framed : nullptr);
+    uint64_t stored = 0;
+    if (ok && table) {
+        StageTimer timer(options.stats, Stage::Write);
+        ok = write_segment_table(out, hdr, key, framed, stored);
+        timer.record(segment_table_bytes(hdr, segments));
+    }
+    if (ok && totals) {
+        totals->segments = segments;
+        totals->plaintext_bytes = plaintext_bytes;
+        totals->stored_bytes = stored;
+    }
+    return ok;
+}
+
+bool open_stream(InputSource& in, OutputSink& out, const FileHeader& hdr,
+                 const unsigned char key[DEK_BYTES],
+                 const CryptoOptions& options) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return false;
+    const bool compressed = hdr.flags & FLAG_COMPRESSED;
+    const size_t packed = compressed ? packed_segment_bound(hdr.segment_size) : 0;
+    SlotLayout layout = {(compressed ? packed : hdr.segment_size) + suite->abytes, hdr.segment_size, packed,
+                         suite->abytes + (compressed ? 1 : 0), compressed, false};
+    auto crypt = [&](SegmentBatch& batch, size_t i, uint32_t index, bool last) {
+            unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+            segment_nonce(hdr, index, last, nonce);
+            unsigned char* plain = compressed ? batch.packed(i) : batch.output(i);
+            unsigned long long plen;
+            if (suite->decrypt(plain, &plen, NULL, batch.input(i), batch.in_len[i],
+                               hdr.core, HEADER_CORE_BYTES, nonce, key) != 0)
+                return false;
+            if (!compressed) {
+                batch.out_len[i] = plen;
+                return true;
+            }
+            return unpack_segment(plain, plen, batch.output(i), hdr.segment_size, &batch.out_len[i]);
+        };
+    if (!(hdr.flags & FLAG_SEGMENT_TABLE)) return run_segments(in, out, options, layout, crypt);
+
+    // Os segmentos terminam onde o índice diz; o último ainda precisa da flag de último.
+    StreamTotals totals;
+    if (!compressed || !open_segment_index(hdr, key, totals)) return false;
+    BoundedInput segments_in(in, totals.stored_bytes);
+    uint64_t segments = 0;
+    return run_segments(segments_in, out, options, layout, crypt, &segments) && segments_in.remaining() == 0 &&
+           segments == totals.segments && read_segment_table(in, hdr, key, totals);
+}
+
+// Nonce do índice: contador fora do intervalo dos segmentos e flag 2 (segmentos usam 0 e 1).
+static void index_nonce(const FileHeader& hdr, unsigned char nonce[AEAD_MAX_NPUBBYTES]) {
+    std::memset(nonce, 0, AEAD_MAX_NPUBBYTES);
+    segment_nonce(hdr, 0xFFFFFFFF, false, nonce);
+    nonce[SEGMENT_NONCE_BYTES - 1] = 2;
+}
+
+// segments (u64 LE) | plaintext_bytes (u64 LE) [| stored_bytes (u64 LE), com FLAG_SEGMENT_TABLE]
+static const size_t INDEX_MAX_PLAIN_BYTES = 24;
+
+static size_t index_plain_bytes(const FileHeader& hdr) {
+    return hdr.flags & FLAG_SEGMENT_TABLE ? 24 : 16;
+}
+
+size_t segment_index_bytes(const FileHeader& hdr) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    return suite ? index_plain_bytes(hdr) + suite->abytes : 0;
+}
+
+bool seal_segment_index(FileHeader& hdr, const unsigned char key[DEK_BYTES], const StreamTotals& totals) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return false;
+
+    unsigned char plain[INDEX_MAX_PLAIN_BYTES], nonce[AEAD_MAX_NPUBBYTES];
+    put_u64(plain, totals.segments);
+    put_u64(plain + 8, totals.plaintext_bytes);
+    put_u64(plain + 16, totals.stored_bytes);
+    index_nonce(hdr, nonce);
+    hdr.index.resize(index_plain_bytes(hdr) + suite->abytes);
+    unsigned long long clen;
+    return suite->encrypt(hdr.index.data(), &clen, plain, index_plain_bytes(hdr), hdr.core, HEADER_CORE_BYTES,
+                          NULL, nonce, key) == 0;
+}
+
+bool open_segment_index(const FileHeader& hdr, const unsigned char key[DEK_BYTES], StreamTotals& totals) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite || hdr.index.size() != index_plain_bytes(hdr) + suite->abytes) return false;
+
+    unsigned char plain[INDEX_MAX_PLAIN_BYTES] = {0}, nonce[AEAD_MAX_NPUBBYTES];
+    index_nonce(hdr, nonce);
+    unsigned long long plen;
+    if (suite->decrypt(plain, &plen, NULL, hdr.index.data(), hdr.index.size(), hdr.core, HEADER_CORE_BYTES,
+                       nonce, key) != 0)
+        return false;
+    totals.segments = get_u64(plain);
+    totals.plaintext_bytes = get_u64(plain + 8);
+    totals.stored_bytes = get_u64(plain + 16);
+    return true;
+}
+
+uint64_t segment_table_bytes(const FileHeader& hdr, uint64_t segments) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite) return 0;
+    uint64_t blocks = (segments + SEGMENT_TABLE_BLOCK - 1) / SEGMENT_TABLE_BLOCK;
+    return 4 * segments + blocks * (8 + suite->abytes);
+}
+
+bool segment_table_block_span(const FileHeader& hdr, uint64_t segments, uint64_t block, uint64_t& pos,
+                              size_t& len) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite || block >= (segments + SEGMENT_TABLE_BLOCK - 1) / SEGMENT_TABLE_BLOCK) return false;
+    pos = block * (table_block_plain_bytes(SEGMENT_TABLE_BLOCK) + suite->abytes);
+    size_t entries = static_cast<size_t>(std::min<uint64_t>(SEGMENT_TABLE_BLOCK, segments - block * SEGMENT_TABLE_BLOCK));
+    len = table_block_plain_bytes(entries) + suite->abytes;
+    return true;
+}
+
+bool open_segment_table_block(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint64_t segments,
+                              uint64_t block, const unsigned char* in, size_t len, SegmentTableBlock& out) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    uint64_t pos;
+    size_t expected;
+    if (!suite || !segment_table_block_span(hdr, segments, block, pos, expected) || len != expected) return false;
+
+    unsigned char plain[8 + 4 * SEGMENT_TABLE_BLOCK], nonce[AEAD_MAX_NPUBBYTES];
+    table_nonce(hdr, block, nonce);
+    unsigned long long plen;
+    if (suite->decrypt(plain, &plen, NULL, in, len, hdr.core, HEADER_CORE_BYTES, nonce, key) != 0) return false;
+    out.first_offset = get_u64(plain);
+    out.lens.resize((plen - 8) / 4);
+    for (size_t i = 0; i < out.lens.size(); ++i) out.lens[i] = get_u32(plain + 8 + 4 * i);
+    return true;
+}
+
+bool seal_segment(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint32_t index, bool last,
+                  const unsigned char* in, size_t len, unsigned char* out, size_t* out_len) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    if (!suite || len > hdr.segment_size || (hdr.flags & FLAG_COMPRESSED)) return false;
+
+    unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+    segment_nonce(hdr, index, last, nonce);
+    unsigned long long clen;
+    if (suite->encrypt(out, &clen, in, len, hdr.core, HEADER_CORE_BYTES, NULL, nonce, key) != 0) return false;
+    *out_len = clen;
+    return true;
+}
+
+bool open_segment(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint32_t index, bool last,
+                  const unsigned char* in, size_t len, unsigned char* out, size_t* out_len) {
+    const AeadSuite* suite = aead_suite(hdr.cipher);
+    const bool compressed = hdr.flags & FLAG_COMPRESSED;
+    const size_t max_plain = compressed ? packed_segment_bound(hdr.segment_size) : hdr.segment_size;
+    if (!suite || len < suite->abytes || len > max_plain + suite->abytes) return false;
+
+    unsigned char nonce[AEAD_MAX_NPUBBYTES] = {0};
+    segment_nonce(hdr, index, last, nonce);
+    unsigned long long plen;
+    if (!compressed) {
+        if (suite->decrypt(out, &plen, NULL, in, len, hdr.core, HEADER_CORE_BYTES, nonce, key) != 0) return false;
+        *out_len = plen;
+        return true;
+    }
+
+    // Do pool de E/S: leituras aleatórias abrem um segmento por vez, sempre do mesmo tamanho.
+    BufferPool::Lease packed = io_buffer_pool().acquire(max_plain);
+    return suite->decrypt(packed.data(), &plen, NULL, in, len, hdr.core, HEADER_CORE_BYTES, nonce, key) == 0 &&
+           unpack_segment(packed.data(), plen, out, hdr.segment_size, out_len);
+}
@@ -0,0 +1,74 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "format.h"
+#include "io_backend.h"
+#include "options.h"
+#include <vector>
+
+// Totais de um fluxo selado: guardados no índice do header para leitura aleatória.
+struct StreamTotals {
+    uint64_t segments = 0;
+    uint64_t plaintext_bytes = 0;
+    uint64_t stored_bytes = 0;   // segmentos com prefixos, sem a tabela (só com FLAG_SEGMENT_TABLE)
+};
+
+// Sela a entrada em segmentos (após o header já escrito em out) com a suíte hdr.cipher;
+// falha se a suíte não roda neste host.
+// Leitura, criptografia e escrita rodam em estágios sobrepostos: enquanto um lote é
+// selado por options.threads workers, o próximo é lido e o anterior é escrito.
+// A memória usada é limitada a alguns lotes, independentemente do tamanho da entrada.
+bool seal_stream(InputSource& in, OutputSink& out, const FileHeader& hdr,
+                 const unsigned char key[DEK_BYTES],
+                 const CryptoOptions& options = CryptoOptions(), StreamTotals* totals = nullptr);
+
+// Abre os segmentos que seguem o header; falha se algum segmento for adulterado,
+// reordenado ou se o fluxo terminar antes do segmento final. Com FLAG_SEGMENT_TABLE, o
+// índice diz onde os segmentos terminam e a tabela que os segue também é autenticada.
+bool open_stream(InputSource& in, OutputSink& out, const FileHeader& hdr,
+                 const unsigned char key[DEK_BYTES],
+                 const CryptoOptions& options = CryptoOptions());
+
+// Índice do fluxo: os segmentos têm tamanho fixo (só o último é menor), então a posição de
+// qualquer segmento sai da aritmética; o índice autentica quantos existem e o tamanho do
+// texto claro. É selado com a DEK e o núcleo como dado associado, num nonce que nenhum
+// segmento usa. Com index_bytes espaços reservados, o header pode ser serializado antes
+// do fluxo e reescrito no lugar depois. Com FLAG_SEGMENT_TABLE, guarda também stored_bytes,
+// o início da tabela de segmentos.
+size_t segment_index_bytes(const FileHeader& hdr);   // 0 se a suíte não roda aqui
+bool seal_segment_index(FileHeader& hdr, const unsigned char key[DEK_BYTES], const StreamTotals& totals);
+bool open_segment_index(const FileHeader& hdr, const unsigned char key[DEK_BYTES], StreamTotals& totals);
+
+// Tabela de segmentos dos arquivos comprimidos (FLAG_SEGMENT_TABLE): os segmentos têm
+// tamanhos variáveis, então a posição de cada um fica numa tabela depois do último. Ela é
+// dividida em blocos de SEGMENT_TABLE_BLOCK entradas, selados um a um com a DEK:
+//   posição do primeiro segmento do bloco, a partir do fim do header (u64 LE)
+//   | tamanho cifrado de cada segmento, sem o prefixo (u32 LE cada)
+// Todos os blocos têm o mesmo tamanho, exceto o último, então a leitura aleatória abre um
+// único bloco e vai direto ao segmento.
+static const size_t SEGMENT_TABLE_BLOCK = 1024;
+
+struct SegmentTableBlock {
+    uint64_t first_offset = 0;
+    std::vector<uint32_t> lens;
+};
+
+uint64_t segment_table_bytes(const FileHeader& hdr, uint64_t segments);   // 0 se a suíte não roda aqui
+
+// Posição (a partir do início da tabela) e tamanho selado do bloco `block`.
+bool segment_table_block_span(const FileHeader& hdr, uint64_t segments, uint64_t block, uint64_t& pos,
+                              size_t& len);
+bool open_segment_table_block(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint64_t segments,
+                              uint64_t block, const unsigned char* in, size_t len, SegmentTableBlock& out);
+
+// Sela um único segmento fora do pipeline (arquivos pequenos de um contêiner). out precisa
+// de len + AEAD_MAX_ABYTES bytes.
+bool seal_segment(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint32_t index, bool last,
+                  const unsigned char* in, size_t len, unsigned char* out, size_t* out_len);
+
+// Abre um único segmento lido fora do pipeline (leitura aleatória). out precisa de
+// segment_size bytes.
+bool open_segment(const FileHeader& hdr, const unsigned char key[DEK_BYTES], uint32_t index, bool last,
+                  const unsigned char* in, size_t len, unsigned char* out, size_t* out_len);
+
+#endif
@@ -0,0 +1,83 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned threads) : thread_count(resolve_threads(threads)) {
+    if (thread_count > 1) {
+        for (unsigned i = 0; i < thread_count; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+unsigned ThreadPool::resolve_threads(unsigned requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+    if (workers.empty() || n <= 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+
+    // Índices distribuídos dinamicamente; a thread chamadora também trabalha.
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    auto run = [&] {
+        for (size_t i = next++; i < n; i = next++) fn(i);
+    };
+
+    size_t helpers = std::min<size_t>(workers.size(), n) - 1;
+    for (size_t h = 0; h < helpers; ++h) {
+        submit([&] {
+            run();
+            std::lock_guard<std::mutex> lock(done_mutex);
+            ++done;
+            done_cv.notify_one();
+        });
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&] { return done == helpers; });
+}
@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fixo de threads. Com 1 thread, parallel_for executa tudo na thread chamadora,
+// sem criar workers, o que dá um modo single-thread reprodutível.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return thread_count; }
+
+    // Enfileira uma tarefa avulsa (executa inline se o pool não tem workers).
+    void submit(std::function<void()> task);
+
+    // Executa fn(i) para i em [0, n) e espera todas terminarem.
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+
+    // 0 = número de núcleos disponíveis.
+    static unsigned resolve_threads(unsigned requested);
+
+private:
+    void worker_loop();
+
+    unsigned thread_count;
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+#endif
@@ -9,51 +9,18 @@
 #include <sstream>
 #include <iomanip>
 #include <gmpxx.h>
+#include "memory_pool.h"
+#include "point_codec.h"
 
-inline bool derive_key_from_password(const std::string& password, unsigned char* key, unsigned char* salt) {
-    return crypto_pwhash(
-        key, 32,
-        password.c_str(), password.length(),
-        salt,
-        crypto_pwhash_OPSLIMIT_MODERATE,
-        crypto_pwhash_MEMLIMIT_MODERATE,
-        crypto_pwhash_ALG_ARGON2ID13
-    ) == 0;
-}
-
-inline bool secure_delete(const std::string& path) {
-    std::error_code ec;
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file) return false;
-
-    std::streamsize size = file.tellg();
-    file.close();
-
-    std::ofstream wipe(path, std::ios::binary);
-    if (!wipe) return false;
-
-    std::vector<unsigned char> zeros(size, 0x00);
-    wipe.write((char*)zeros.data(), size);
-    wipe.close();
-
-    return std::filesystem::remove(path, ec);
-}
+static_assert(SCALAR_BYTES <= SECRET_BLOCK_BYTES, "escalares cabem num bloco de segredo");
 
+// Os bytes aleatórios ficam em memória travada e são zerados ao sair (memory_pool.h).
 inline void generate_random_key(mpz_class& key, const mpz_class& n) {
-    size_t num_bytes = 64;
-    unsigned char* buffer = new unsigned char[num_bytes];
-    randombytes_buf(buffer, num_bytes);
+    SecretBlock buffer;
+    randombytes_buf(buffer.data(), SCALAR_BYTES);
 
-    std::stringstream ss;
-    for (size_t i = 0; i < num_bytes; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(buffer[i]);
-    }
-
-    key.set_str(ss.str(), 16);
+    mpz_from_be_bytes(key, buffer.data(), SCALAR_BYTES);
     key = key % (n - 2) + 1;
-
-    sodium_memzero(buffer, num_bytes);
-    delete[] buffer;
 }
 
 #endif // UTILS_H